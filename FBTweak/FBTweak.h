@@ -19,6 +19,77 @@
  */
 typedef id FBTweakValue;
 
+/**
+  @abstract Where an action runs.
+  @discussion See {@ref FBTweakActionRunner}.
+ */
+typedef NS_ENUM(NSUInteger, FBTweakActionPolicy) {
+  /**
+    @abstract Runs on the main queue.
+   */
+  FBTweakActionPolicyMainThread,
+  /**
+    @abstract Runs on a background queue, after other background actions.
+   */
+  FBTweakActionPolicyBackground,
+  /**
+    @abstract Runs alongside other concurrent actions, up to a limit.
+   */
+  FBTweakActionPolicyConcurrent,
+};
+
+/**
+  @abstract How changes are delivered to an observer.
+ */
+typedef NS_ENUM(NSUInteger, FBTweakObserverDelivery) {
+  /**
+    @abstract Delivered before the change returns, on the observer's queue.
+   */
+  FBTweakObserverDeliverySynchronous,
+  /**
+    @abstract Each change is delivered later, on the observer's queue.
+   */
+  FBTweakObserverDeliveryAsynchronous,
+  /**
+    @abstract Delivered later, once for any changes made before delivery.
+   */
+  FBTweakObserverDeliveryCoalesced,
+};
+
+/**
+  @abstract Provides the possible values of a tweak without listing them all.
+  @discussion Use for large or generated sets of values as the
+    -possibleValues of a tweak. Values are only asked for a page at a
+    time, as they're displayed.
+ */
+@protocol FBTweakPossibleValuesProvider <NSObject>
+
+/**
+  @abstract The number of possible values.
+ */
+- (NSUInteger)numberOfValues;
+
+/**
+  @abstract The possible values in a range, in the order they're displayed.
+  @param range A range within the number of values.
+ */
+- (NSArray *)valuesInRange:(NSRange)range;
+
+/**
+  @abstract If a value is one of the possible values.
+ */
+- (BOOL)containsValue:(FBTweakValue)value;
+
+@optional
+
+/**
+  @abstract The title to display for a value.
+  @discussion If not implemented, the value's description is displayed.
+ */
+- (NSString *)titleForValue:(FBTweakValue)value;
+
+@end
+
 /**
   @abstract Represents a range of values for a numeric tweak.
   @discussion Use this for the -possibleValues on a tweak.
@@ -79,6 +150,12 @@ typedef id FBTweakValue;
  */
 @property (nonatomic, readonly, assign, getter = isAction) BOOL action;
 
+/**
+  @abstract Where the action runs, if this tweak is an action.
+  @discussion Defaults to FBTweakActionPolicyMainThread.
+ */
+@property (nonatomic, assign, readwrite) FBTweakActionPolicy actionPolicy;
+
 /**
   @abstract The default value of the tweak.
   @discussion Use this when the current value is unset.
@@ -98,7 +175,10 @@ typedef id FBTweakValue;
   @discussion Optional. If nil, any value is allowed. If an
     FBTweakNumericRange, represents a range of numeric values.
     If an array or dictionary, contains all of the allowed values.
-    Should not be set on tweaks representing actions.
+    For large or generated sets of values, use an object conforming
+    to FBTweakPossibleValuesProvider. Should not be set on tweaks
+    representing actions. Inline tweaks only create their possible
+    values the first time this is read.
  */
 @property (nonatomic, strong, readwrite) id possibleValues;
 
@@ -137,6 +217,26 @@ typedef id FBTweakValue;
  */
 - (void)addObserver:(id<FBTweakObserver>)observer;
 
+/**
+  @abstract Adds an observer that's notified on a queue.
+  @param observer The observer. Must not be nil.
+  @param queue The queue to notify the observer on. If nil, synchronous
+    observers are notified on the thread making the change, and others on
+    the main queue.
+  @param delivery When the observer is notified.
+  @discussion A weak reference is taken on the observer. Notifications to
+    an observer always arrive in the order the changes were made, even on
+    a concurrent queue. Asynchronous and coalesced observers don't slow
+    down changes, and are only sent -tweakDidChange:, by which time the
+    tweak may have changed again. Adding an observer again replaces how
+    it was added before. Synchronous observers are notified inline when
+    the change is made on their queue or, for the main queue, on the main
+    thread, and otherwise with dispatch_sync. So a synchronous observer's
+    queue must not target a queue that changes might be made on, since
+    that can't be detected and deadlocks.
+ */
+- (void)addObserver:(id<FBTweakObserver>)observer queue:(dispatch_queue_t)queue delivery:(FBTweakObserverDelivery)delivery;
+
 /**
   @abstract Removes an observer from the tweak.
   @param observer The observer to remove. Must not be nil.
@@ -7,7 +7,22 @@
  of patent rights can be found in the PATENTS file in the same directory.
  */
 
+#import <mach/mach_time.h>
+
 #import "FBTweak.h"
+#import "_FBTweakBatch.h"
+#import "_FBTweakSharedSlot.h"
+#import "_FBTweakJournal.h"
+#import "_FBTweakCHandle.h"
+#import "_FBTweakDerived.h"
+#import "_FBTweakVariable.h"
+#import "_FBTweakCollection.h"
+#import "_FBTweakOverrides.h"
+#import "_FBTweakObserverProfiler.h"
+#import "_FBTweakQueuedObserver.h"
+#import "_FBTweakGeneration.h"
+#import "_FBTweakFrozen.h"
+#import "_FBTweakPersistedValue.h"
 
 @implementation FBTweakNumericRange
 
@@ -42,9 +57,27 @@
 @end
 
 @implementation FBTweak {
+  // Run once, on first read of the possible values. Guarded by self.
+  id (^_possibleValuesBlock)(void);
+
   NSHashTable *_observers;
+  NSMapTable *_queuedObservers;
+
+  FBTweakSharedTable *_sharedTable;
+  _FBTweakSharedSlot *_sharedSlot;
+  uint32_t _sharedSequence;
+  uint32_t _sharedSynchronizedSequence;
+
+  uint32_t _journalIdentifierIndex;
+
+  NSPointerArray *_cHandles;
+  NSPointerArray *_variableAddresses;
+  NSPointerArray *_variableEncodings;
 }
 
+@synthesize currentValue = _currentValue;
+@synthesize possibleValues = _possibleValues;
+
 - (instancetype)initWithCoder:(NSCoder *)coder
 {
   NSString *identifier = [coder decodeObjectForKey:@"identifier"];
@@ -76,8 +109,12 @@
 {
   if ((self = [super init])) {
     _identifier = identifier;
-    NSData *archivedValue = [[NSUserDefaults standardUserDefaults] objectForKey:_identifier];
-    _currentValue = (archivedValue != nil && [archivedValue isKindOfClass:[NSData class]] ? [NSKeyedUnarchiver unarchiveObjectWithData:archivedValue] : archivedValue);
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    BOOL migrate = NO;
+    _currentValue = _FBTweakValueForPersistedObject([defaults objectForKey:_identifier], &migrate);
+    if (migrate) {
+      [defaults setObject:_FBTweakPersistedObjectForValue(_currentValue) forKey:_identifier];
+    }
   }
   
   return self;
@@ -90,7 +127,11 @@
   
   if (!self.isAction) {
     [coder encodeObject:_defaultValue forKey:@"defaultValue"];
-    [coder encodeObject:_possibleValues forKey:@"possibleValues"];
+    id possibleValues = self.possibleValues;
+    if (possibleValues == nil || [possibleValues conformsToProtocol:@protocol(NSCoding)]) {
+      // Providers may generate their values, so are only kept if they can be.
+      [coder encodeObject:possibleValues forKey:@"possibleValues"];
+    }
     [coder encodeObject:_currentValue forKey:@"currentValue"];
     [coder encodeObject:_precisionValue forKey:@"precisionValue"];
     [coder encodeObject:_stepValue forKey:@"stepValue"];
@@ -109,10 +150,50 @@
   return [_defaultValue isKindOfClass:blockClass];
 }
 
+- (id)possibleValues
+{
+  id (^block)(void) = nil;
+  @synchronized (self) {
+    if (_possibleValuesBlock == nil) {
+      return _possibleValues;
+    }
+    block = _possibleValuesBlock;
+  }
+
+  // Run without the lock. If another thread ran it first, or the possible
+  // values were set meanwhile, this result is discarded.
+  id possibleValues = block();
+
+  @synchronized (self) {
+    if (_possibleValuesBlock == block) {
+      _possibleValues = possibleValues;
+      _possibleValuesBlock = nil;
+    }
+    return _possibleValues;
+  }
+}
+
+- (void)setPossibleValues:(id)possibleValues
+{
+  @synchronized (self) {
+    _possibleValuesBlock = nil;
+    _possibleValues = possibleValues;
+  }
+}
+
+- (void)_setPossibleValuesBlock:(id (^)(void))block
+{
+  @synchronized (self) {
+    _possibleValues = nil;
+    _possibleValuesBlock = [block copy];
+  }
+}
+
 - (FBTweakValue)minimumValue
 {
-  if ([_possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
-    return [(FBTweakNumericRange *)_possibleValues minimumValue];
+  id possibleValues = self.possibleValues;
+  if ([possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
+    return [(FBTweakNumericRange *)possibleValues minimumValue];
   } else {
     return nil;
   }
@@ -120,10 +201,11 @@
 
 - (void)setMinimumValue:(FBTweakValue)minimumValue
 {
+  id possibleValues = self.possibleValues;
   if (minimumValue == nil) {
     _possibleValues = nil;
-  } else if ([_possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
-    _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:minimumValue maximumValue:[(FBTweakNumericRange *)_possibleValues maximumValue]];
+  } else if ([possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
+    _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:minimumValue maximumValue:[(FBTweakNumericRange *)possibleValues maximumValue]];
   } else {
     _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:minimumValue maximumValue:minimumValue];
   }
@@ -131,8 +213,9 @@
 
 - (FBTweakValue)maximumValue
 {
-  if ([_possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
-    return [(FBTweakNumericRange *)_possibleValues maximumValue];
+  id possibleValues = self.possibleValues;
+  if ([possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
+    return [(FBTweakNumericRange *)possibleValues maximumValue];
   } else {
     return nil;
   }
@@ -140,26 +223,55 @@
 
 - (void)setMaximumValue:(FBTweakValue)maximumValue
 {
+  id possibleValues = self.possibleValues;
   if (maximumValue == nil) {
     _possibleValues = nil;
-  } else if ([_possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
-    _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:[(FBTweakNumericRange *)_possibleValues minimumValue] maximumValue:maximumValue];
+  } else if ([possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
+    _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:[(FBTweakNumericRange *)possibleValues minimumValue] maximumValue:maximumValue];
   } else {
     _possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:maximumValue maximumValue:maximumValue];
   }
 }
 
+- (FBTweakValue)currentValue
+{
+  _FBTweakDerivedRecordDependency(self);
+
+  CFMutableDictionaryRef overrides = _FBTweakOverridesLayer;
+  if (overrides != NULL) {
+    const void *overrideValue = CFDictionaryGetValue(overrides, (__bridge const void *)self);
+    if (overrideValue != NULL) {
+      return (overrideValue != kCFNull ? (__bridge FBTweakValue)overrideValue : nil);
+    }
+  }
+
+  if (_sharedSlot != NULL) {
+    // Another process may have changed the value; one load if it hasn't.
+    FBTweakValue sharedValue = nil;
+    if (_FBTweakSharedSlotRead(_sharedSlot, &_sharedSequence, &sharedValue)) {
+      [self _commitCurrentValue:sharedValue];
+    }
+  }
+
+  return _currentValue;
+}
+
 - (void)setCurrentValue:(FBTweakValue)currentValue
 {
   NSAssert(!self.isAction, @"actions cannot have non-default values");
 
-  if (_possibleValues != nil && currentValue != nil) {
-    if ([_possibleValues isKindOfClass:[NSArray class]]) {
-      if ([_possibleValues indexOfObject:currentValue] == NSNotFound) {
+  id possibleValues = self.possibleValues;
+  if (possibleValues != nil && currentValue != nil) {
+    if ([possibleValues isKindOfClass:[NSArray class]]) {
+      if ([possibleValues indexOfObject:currentValue] == NSNotFound) {
+        currentValue = _defaultValue;
+      }
+    } else if ([possibleValues isKindOfClass:[NSDictionary class]]) {
+      if (possibleValues[currentValue] == nil) {
         currentValue = _defaultValue;
       }
-    } else if ([_possibleValues isKindOfClass:[NSDictionary class]]) {
-      if ([[_possibleValues allKeys] indexOfObject:currentValue] == NSNotFound) {
+    } else if ([possibleValues conformsToProtocol:@protocol(FBTweakPossibleValuesProvider)]) {
+      if (![possibleValues containsValue:currentValue]) {
         currentValue = _defaultValue;
       }
     } else {
@@ -175,24 +287,265 @@
     }
   }
 
-  if (_currentValue != currentValue) {
-      
-    for (id<FBTweakObserver> observer in [_observers setRepresentation]) {
-      if ([observer respondsToSelector:@selector(tweakWillChange:)]) {
-        [observer tweakWillChange:self];
+  if (self.currentValue != currentValue) {
+    CFMutableDictionaryRef overrides = _FBTweakOverridesLayer;
+    if (overrides != NULL) {
+      // Only visible on this thread, so not journaled, persisted, shared
+      // or told to observers, which watch the global value.
+      _FBTweakGenerationLock();
+      CFDictionarySetValue(overrides, (__bridge const void *)self, (currentValue != nil ? (__bridge const void *)currentValue : kCFNull));
+      _FBTweakGenerationAdvance();
+      _FBTweakGenerationUnlock();
+      return;
+    }
+
+    // Inside a batch, observers hear about the first change only and are
+    // told about the final value once the batch ends.
+    BOOL batched = _FBTweakBatchIsActive();
+    BOOL notifyWillChange = (!batched || _FBTweakBatchEnqueueTweak(self));
+
+    if (notifyWillChange) {
+      [self _notifyObserversWillChange];
+    }
+
+    FBTweakJournal *journal = _FBTweakJournalActive;
+    if (journal != nil) {
+      _FBTweakJournalRecord(journal, self, &_journalIdentifierIndex, _currentValue, currentValue);
+    }
+
+    [self _commitCurrentValue:currentValue];
+    [self _storeBindings];
+
+    [[NSUserDefaults standardUserDefaults] setObject:_FBTweakPersistedObjectForValue(_currentValue) forKey:_identifier];
+
+    if (_sharedSlot != NULL) {
+      uint32_t sequence = _FBTweakSharedTableWrite(_sharedTable, _sharedSlot, _currentValue);
+      if (sequence != 0) {
+        _sharedSequence = sequence;
+        _sharedSynchronizedSequence = sequence;
       }
     }
-      
-    _currentValue = currentValue;
-    // we can't store UIColor to the plist file. That is why we archive value to the NSData.
-    [[NSUserDefaults standardUserDefaults] setObject:[NSKeyedArchiver archivedDataWithRootObject:_currentValue] forKey:_identifier];
 
-    for (id<FBTweakObserver> observer in [_observers setRepresentation]) {
+    if (!batched) {
+      [self _notifyObserversDidChange];
+    }
+  }
+}
+
+- (void)_commitCurrentValue:(FBTweakValue)currentValue
+{
+  // Snapshots see the change all at once, and the generation moves on.
+  _FBTweakGenerationLock();
+  _currentValue = currentValue;
+  _FBTweakGenerationAdvance();
+  _FBTweakGenerationUnlock();
+}
+
+- (void)_notifyObserversWillChange
+{
+  if (_FBTweakObserverProfilerIsEnabled()) {
+    [self _notifyObserversProfilingWillChange:YES];
+    return;
+  }
+
+  for (id<FBTweakObserver> observer in [_observers setRepresentation]) {
+    if ([observer respondsToSelector:@selector(tweakWillChange:)]) {
+      [observer tweakWillChange:self];
+    }
+  }
+
+  for (_FBTweakQueuedObserver *queuedObserver in [[_queuedObservers objectEnumerator] allObjects]) {
+    [queuedObserver tweakWillChange:self];
+  }
+}
+
+- (void)_notifyObserversDidChange
+{
+  if (_FBTweakObserverProfilerIsEnabled()) {
+    [self _notifyObserversProfilingWillChange:NO];
+    return;
+  }
+
+  for (id<FBTweakObserver> observer in [_observers setRepresentation]) {
+    [observer tweakDidChange:self];
+  }
+
+  for (_FBTweakQueuedObserver *queuedObserver in [[_queuedObservers objectEnumerator] allObjects]) {
+    [queuedObserver tweakDidChange:self];
+  }
+}
+
+- (void)_notifyObserversProfilingWillChange:(BOOL)willChange
+{
+  // Kept apart so the loops above stay untimed while profiling is off.
+  for (id<FBTweakObserver> observer in [_observers setRepresentation]) {
+    if (willChange && ![observer respondsToSelector:@selector(tweakWillChange:)]) {
+      continue;
+    }
+
+    uint64_t start = mach_absolute_time();
+    if (willChange) {
+      [observer tweakWillChange:self];
+    } else {
       [observer tweakDidChange:self];
     }
+    _FBTweakObserverProfilerRecord(observer, mach_absolute_time() - start);
+  }
+
+  // Queued observers time themselves on the queue they deliver on.
+  for (_FBTweakQueuedObserver *queuedObserver in [[_queuedObservers objectEnumerator] allObjects]) {
+    if (willChange) {
+      [queuedObserver tweakWillChange:self];
+    } else {
+      [queuedObserver tweakDidChange:self];
+    }
+  }
+}
+
+- (void)_attachSharedTable:(FBTweakSharedTable *)table slot:(_FBTweakSharedSlot *)slot
+{
+  _sharedTable = table;
+  _sharedSlot = slot;
+  _sharedSequence = 0;
+
+  FBTweakValue sharedValue = nil;
+  if (_FBTweakSharedSlotRead(slot, &_sharedSequence, &sharedValue)) {
+    // Written by another process already, so that value wins.
+    [self _commitCurrentValue:sharedValue];
+    [self _storeBindings];
+  } else if (_currentValue != nil) {
+    _sharedSequence = _FBTweakSharedTableWrite(table, slot, _currentValue);
+  }
+
+  _sharedSynchronizedSequence = _sharedSequence;
+}
+
+- (void)_synchronizeSharedValue
+{
+  // Reads may already have picked up the new value without notifying.
+  FBTweakValue sharedValue = nil;
+  uint32_t sequence = _sharedSynchronizedSequence;
+  if (_sharedSlot == NULL || !_FBTweakSharedSlotRead(_sharedSlot, &sequence, &sharedValue)) {
+    return;
+  }
+
+  [self _notifyObserversWillChange];
+
+  [self _commitCurrentValue:sharedValue];
+  _sharedSequence = sequence;
+  _sharedSynchronizedSequence = sequence;
+  [self _storeBindings];
+
+  [self _notifyObserversDidChange];
+}
+
+// Tweaks with C handles or bound variables, so freezing can reach them.
+static NSHashTable *_FBTweakBoundTweaks(void)
+{
+  static NSHashTable *boundTweaks = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    boundTweaks = [NSHashTable weakObjectsHashTable];
+  });
+  return boundTweaks;
+}
+
+static void _FBTweakAddBoundTweak(FBTweak *tweak)
+{
+  @synchronized (_FBTweakBoundTweaks()) {
+    [_FBTweakBoundTweaks() addObject:tweak];
+  }
+}
+
++ (void)_storeAllBindings
+{
+  NSArray *tweaks = nil;
+  @synchronized (_FBTweakBoundTweaks()) {
+    tweaks = [_FBTweakBoundTweaks() allObjects];
+  }
+
+  for (FBTweak *tweak in tweaks) {
+    [tweak _storeBindings];
+  }
+}
+
+// The value C handles and bound variables hold: nil, for the default,
+// while tweaks are frozen.
+- (FBTweakValue)_boundValue
+{
+  return (_FBTweakIsFrozen() ? nil : _currentValue);
+}
+
+// Handles are detached on whichever thread unloads their image, so the
+// handles are only used while synchronized on the tweak.
+- (void)_attachCHandle:(fb_tweak_c_handle_header *)handle
+{
+  @synchronized (self) {
+    if (_cHandles == nil) {
+      _cHandles = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsOpaqueMemory];
+      _FBTweakAddBoundTweak(self);
+    }
+
+    [_cHandles addPointer:handle];
+    _FBTweakCHandleStore(handle, [self _boundValue]);
   }
 }
 
+- (void)_detachCHandle:(fb_tweak_c_handle_header *)handle
+{
+  @synchronized (self) {
+    for (NSUInteger i = 0; i < _cHandles.count; i++) {
+      if ([_cHandles pointerAtIndex:i] == handle) {
+        [_cHandles removePointerAtIndex:i];
+        break;
+      }
+    }
+  }
+}
+
+- (void)_bindVariable:(void *)address encoding:(const char *)encoding
+{
+  NSAssert(_FBTweakVariableEncodingIsSupported(encoding), @"tweak %@ can't be bound to a variable of type %s", _identifier, encoding);
+
+  for (NSUInteger i = 0; i < _variableAddresses.count; i++) {
+    if ([_variableAddresses pointerAtIndex:i] == address) {
+      return;
+    }
+  }
+
+  if (_variableAddresses == nil) {
+    _variableAddresses = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsOpaqueMemory];
+    _variableEncodings = [NSPointerArray pointerArrayWithOptions:NSPointerFunctionsOpaqueMemory];
+    _FBTweakAddBoundTweak(self);
+  }
+
+  [_variableAddresses addPointer:address];
+  [_variableEncodings addPointer:(void *)encoding];
+  _FBTweakVariableStore(address, encoding, [self _boundValue], _defaultValue);
+}
+
+- (void)_storeBindings
+{
+  FBTweakValue value = [self _boundValue];
+
+  if (_cHandles != nil) {
+    @synchronized (self) {
+      for (NSUInteger i = 0; i < _cHandles.count; i++) {
+        _FBTweakCHandleStore([_cHandles pointerAtIndex:i], value);
+      }
+    }
+  }
+
+  for (NSUInteger i = 0; i < _variableAddresses.count; i++) {
+    _FBTweakVariableStore([_variableAddresses pointerAtIndex:i], [_variableEncodings pointerAtIndex:i], value, _defaultValue);
+  }
+}
+
+- (BOOL)_isPinned
+{
+  return (_observers.count > 0 || _queuedObservers.count > 0 || _cHandles.count > 0 || _variableAddresses.count > 0 || _sharedSlot != NULL);
+}
+
 - (void)addObserver:(id<FBTweakObserver>)observer
 {
   if (_observers == nil) {
@@ -200,13 +553,32 @@
   }
   
   NSAssert(observer != nil, @"observer is required");
+  [_queuedObservers removeObjectForKey:observer];
   [_observers addObject:observer];
 }
 
+- (void)addObserver:(id<FBTweakObserver>)observer queue:(dispatch_queue_t)queue delivery:(FBTweakObserverDelivery)delivery
+{
+  NSAssert(observer != nil, @"observer is required");
+
+  if (queue == nil && delivery == FBTweakObserverDeliverySynchronous) {
+    [self addObserver:observer];
+    return;
+  }
+
+  if (_queuedObservers == nil) {
+    _queuedObservers = [NSMapTable weakToStrongObjectsMapTable];
+  }
+
+  [_observers removeObject:observer];
+  [_queuedObservers setObject:[[_FBTweakQueuedObserver alloc] initWithObserver:observer queue:queue delivery:delivery] forKey:observer];
+}
+
 - (void)removeObserver:(id<FBTweakObserver>)observer
 {
   NSAssert(observer != nil, @"observer is required");
   [_observers removeObject:observer];
+  [_queuedObservers removeObjectForKey:observer];
 }
 
 @end
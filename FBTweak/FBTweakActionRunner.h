@@ -0,0 +1,73 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+
+/**
+  @abstract Posted on the main queue when an action starts, makes
+    progress, is cancelled or finishes.
+  @discussion The object is the action's tweak.
+ */
+extern NSString *const FBTweakActionRunnerDidChangeNotification;
+
+/**
+  @abstract Runs action tweaks according to their policy.
+  @discussion While an action runs, [NSProgress currentProgress] is the
+    progress returned for it. Actions report progress and check for
+    cancellation through a child progress:
+
+      NSProgress *progress = [NSProgress progressWithTotalUnitCount:count];
+      for (...) {
+        if (progress.cancelled) {
+          return;
+        }
+        ...
+        progress.completedUnitCount++;
+      }
+
+    An action runs at most once at a time.
+ */
+@interface FBTweakActionRunner : NSObject
+
+/**
+  @abstract Creates or returns the shared action runner.
+  @return The shared action runner.
+ */
++ (instancetype)sharedInstance;
+
+/**
+  @abstract How many actions with FBTweakActionPolicyConcurrent run at once.
+  @discussion Defaults to the number of active processors. Others wait
+    until one finishes.
+ */
+@property (nonatomic, assign) NSUInteger concurrentActionLimit;
+
+/**
+  @abstract Runs an action.
+  @param tweak The action to run. Must be an action.
+  @return The action's progress, or nil if it's already running.
+ */
+- (NSProgress *)runAction:(FBTweak *)tweak;
+
+/**
+  @abstract The progress of an action that's waiting or running.
+  @return The action's progress, or nil if it isn't running.
+ */
+- (NSProgress *)progressForAction:(FBTweak *)tweak;
+
+/**
+  @abstract Cancels an action.
+  @discussion An action that hasn't started yet won't run. A running
+    action stops when it next checks for cancellation.
+ */
+- (void)cancelAction:(FBTweak *)tweak;
+
+@end
@@ -0,0 +1,214 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <pthread.h>
+
+#import "FBTweak.h"
+#import "FBTweakActionRunner.h"
+
+NSString *const FBTweakActionRunnerDidChangeNotification = @"FBTweakActionRunnerDidChangeNotification";
+
+static void *_FBTweakActionRunContext = &_FBTweakActionRunContext;
+
+// One run of an action. Turns changes to its progress into coalesced
+// notifications on the main queue.
+@interface _FBTweakActionRun : NSObject
+
+- (instancetype)initWithTweak:(FBTweak *)tweak progress:(NSProgress *)progress;
+
+@property (nonatomic, strong, readonly) FBTweak *tweak;
+@property (nonatomic, strong, readonly) NSProgress *progress;
+
+- (void)start;
+- (void)finish;
+
+@end
+
+@implementation _FBTweakActionRun {
+  BOOL _changeScheduled;
+}
+
+- (instancetype)initWithTweak:(FBTweak *)tweak progress:(NSProgress *)progress
+{
+  if ((self = [super init])) {
+    _tweak = tweak;
+    _progress = progress;
+  }
+
+  return self;
+}
+
+- (void)start
+{
+  [_progress addObserver:self forKeyPath:NSStringFromSelector(@selector(fractionCompleted)) options:0 context:_FBTweakActionRunContext];
+  [_progress addObserver:self forKeyPath:@"cancelled" options:0 context:_FBTweakActionRunContext];
+  [self _scheduleChange];
+}
+
+- (void)finish
+{
+  [_progress removeObserver:self forKeyPath:NSStringFromSelector(@selector(fractionCompleted)) context:_FBTweakActionRunContext];
+  [_progress removeObserver:self forKeyPath:@"cancelled" context:_FBTweakActionRunContext];
+  [self _scheduleChange];
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+  if (context == _FBTweakActionRunContext) {
+    [self _scheduleChange];
+  } else {
+    [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+  }
+}
+
+- (void)_scheduleChange
+{
+  // Actions can report progress far more often than it can be shown.
+  if (__atomic_exchange_n(&_changeScheduled, YES, __ATOMIC_ACQ_REL)) {
+    return;
+  }
+
+  dispatch_async(dispatch_get_main_queue(), ^{
+    __atomic_store_n(&_changeScheduled, NO, __ATOMIC_RELEASE);
+    [[NSNotificationCenter defaultCenter] postNotificationName:FBTweakActionRunnerDidChangeNotification object:_tweak];
+  });
+}
+
+@end
+
+@implementation FBTweakActionRunner {
+  pthread_mutex_t _mutex;
+
+  // Guarded by _mutex.
+  NSMutableDictionary *_runs;
+
+  NSOperationQueue *_backgroundQueue;
+  NSOperationQueue *_concurrentQueue;
+}
+
++ (instancetype)sharedInstance
+{
+  static FBTweakActionRunner *sharedInstance = nil;
+
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    sharedInstance = [[self alloc] init];
+  });
+
+  return sharedInstance;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    pthread_mutex_init(&_mutex, NULL);
+    _runs = [[NSMutableDictionary alloc] init];
+
+    _backgroundQueue = [[NSOperationQueue alloc] init];
+    _backgroundQueue.name = @"com.facebook.tweaks.actions.background";
+    _backgroundQueue.maxConcurrentOperationCount = 1;
+    _backgroundQueue.qualityOfService = NSQualityOfServiceUtility;
+
+    _concurrentQueue = [[NSOperationQueue alloc] init];
+    _concurrentQueue.name = @"com.facebook.tweaks.actions.concurrent";
+    _concurrentQueue.maxConcurrentOperationCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    _concurrentQueue.qualityOfService = NSQualityOfServiceUtility;
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  pthread_mutex_destroy(&_mutex);
+}
+
+- (NSUInteger)concurrentActionLimit
+{
+  return (NSUInteger)_concurrentQueue.maxConcurrentOperationCount;
+}
+
+- (void)setConcurrentActionLimit:(NSUInteger)concurrentActionLimit
+{
+  NSParameterAssert(concurrentActionLimit > 0);
+  _concurrentQueue.maxConcurrentOperationCount = (NSInteger)concurrentActionLimit;
+}
+
+- (NSProgress *)runAction:(FBTweak *)tweak
+{
+  NSParameterAssert(tweak.isAction);
+
+  dispatch_block_t block = tweak.defaultValue;
+  if (block == nil) {
+    return nil;
+  }
+
+  NSProgress *progress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
+  progress.totalUnitCount = 1;
+  progress.cancellable = YES;
+  _FBTweakActionRun *run = [[_FBTweakActionRun alloc] initWithTweak:tweak progress:progress];
+
+  pthread_mutex_lock(&_mutex);
+  BOOL running = (_runs[tweak.identifier] != nil);
+  if (!running) {
+    _runs[tweak.identifier] = run;
+  }
+  pthread_mutex_unlock(&_mutex);
+
+  if (running) {
+    return nil;
+  }
+
+  [run start];
+
+  void (^perform)(void) = ^{
+    if (!progress.cancelled) {
+      // Progress the action creates becomes a child of the run's.
+      [progress becomeCurrentWithPendingUnitCount:1];
+      block();
+      [progress resignCurrent];
+    }
+
+    pthread_mutex_lock(&_mutex);
+    [_runs removeObjectForKey:tweak.identifier];
+    pthread_mutex_unlock(&_mutex);
+
+    [run finish];
+  };
+
+  switch (tweak.actionPolicy) {
+    case FBTweakActionPolicyMainThread:
+      dispatch_async(dispatch_get_main_queue(), perform);
+      break;
+    case FBTweakActionPolicyBackground:
+      [_backgroundQueue addOperationWithBlock:perform];
+      break;
+    case FBTweakActionPolicyConcurrent:
+      [_concurrentQueue addOperationWithBlock:perform];
+      break;
+  }
+
+  return progress;
+}
+
+- (NSProgress *)progressForAction:(FBTweak *)tweak
+{
+  pthread_mutex_lock(&_mutex);
+  _FBTweakActionRun *run = _runs[tweak.identifier];
+  pthread_mutex_unlock(&_mutex);
+
+  return run.progress;
+}
+
+- (void)cancelAction:(FBTweak *)tweak
+{
+  [[self progressForAction:tweak] cancel];
+}
+
+@end
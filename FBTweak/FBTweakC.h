@@ -0,0 +1,196 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FBTweakEnabled.h"
+
+#ifndef FBTweakSegmentName
+#define FBTweakSegmentName "__DATA"
+#define FBTweakSectionName "FBTweak"
+#endif
+
+/* ELF sections have no segment, so only the section name is used there. */
+#if defined(__ELF__)
+#define _FBTweakSection FBTweakSectionName
+#else
+#define _FBTweakSection FBTweakSegmentName "," FBTweakSectionName
+#endif
+
+/* Entries are read back to back, so keep compilers from padding them out. */
+#define _FBTweakEntryAttributes __attribute__((used, section(_FBTweakSection), aligned(sizeof(void *))))
+
+/**
+  @abstract Marks a section entry as declared with the C macros below.
+  @discussion The entry's names are C strings and its value is a handle.
+ */
+#define FBTweakEncodingC "__C__"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @abstract The type of value a C tweak handle holds.
+ */
+typedef enum {
+  fb_tweak_c_type_bool = 1,
+  fb_tweak_c_type_integer = 2,
+  fb_tweak_c_type_double = 3,
+} fb_tweak_c_type;
+
+typedef struct {
+  uint32_t type;
+  uint32_t has_range;
+} fb_tweak_c_handle_header;
+
+/*
+  Handles are opaque: only read them with the functions below. The
+  current value is kept up to date by the FBTweak of the same name, so
+  reading is a single atomic load, with no Objective-C messaging or
+  boxing. 64-bit values are aligned so the load is atomic on 32-bit ARM.
+ */
+
+typedef struct {
+  fb_tweak_c_handle_header header;
+  bool default_value;
+  bool minimum_value;
+  bool maximum_value;
+  bool value;
+} fb_tweak_bool_handle;
+
+typedef struct {
+  fb_tweak_c_handle_header header;
+  int64_t default_value;
+  int64_t minimum_value;
+  int64_t maximum_value;
+  int64_t value __attribute__((aligned(8)));
+} fb_tweak_integer_handle;
+
+typedef struct {
+  fb_tweak_c_handle_header header;
+  double default_value;
+  double minimum_value;
+  double maximum_value;
+  double value __attribute__((aligned(8)));
+} fb_tweak_double_handle;
+
+/**
+  @abstract Layout compatible with fb_tweak_entry, for C declarations.
+  @discussion Names are C strings rather than NSString literals, and value
+    points to the tweak's handle.
+ */
+typedef struct {
+  const char *category;
+  const char *collection;
+  const char *name;
+  const void *value;
+  const void *possible;
+  const char *encoding;
+} fb_tweak_c_entry;
+
+/**
+  @abstract Reads the current value of a bool tweak.
+ */
+static inline bool fb_tweak_get_bool(const fb_tweak_bool_handle *handle)
+{
+  return __atomic_load_n(&handle->value, __ATOMIC_RELAXED);
+}
+
+/**
+  @abstract Reads the current value of an integer tweak.
+ */
+static inline int64_t fb_tweak_get_integer(const fb_tweak_integer_handle *handle)
+{
+  return __atomic_load_n(&handle->value, __ATOMIC_RELAXED);
+}
+
+/**
+  @abstract Reads the current value of a double tweak.
+ */
+static inline double fb_tweak_get_double(const fb_tweak_double_handle *handle)
+{
+  /* Read as bits, so the load is a single integer load. */
+  uint64_t bits = __atomic_load_n((const uint64_t *)&handle->value, __ATOMIC_RELAXED);
+  double value;
+  __builtin_memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#if FB_TWEAK_ENABLED
+#define _FBTweakCEntry(symbol_, category_, collection_, name_) \
+  _FBTweakEntryAttributes static fb_tweak_c_entry __fb_tweak_c_entry_##symbol_ = { \
+    category_, \
+    collection_, \
+    name_, \
+    (const void *)&__fb_tweak_c_storage_##symbol_, \
+    0, \
+    FBTweakEncodingC, \
+  };
+#else
+#define _FBTweakCEntry(symbol_, category_, collection_, name_)
+#endif
+
+/* Declares the handle storage and, if tweaks are enabled, registers it. */
+#define _FBTweakCStorage(handle_type_, type_, symbol_, category_, collection_, name_, default_, has_range_, min_, max_) \
+  static handle_type_ __fb_tweak_c_storage_##symbol_ = { { type_, has_range_ }, default_, min_, max_, default_ }; \
+  _FBTweakCEntry(symbol_, category_, collection_, name_)
+
+#define _FBTweakCHandle(handle_type_, type_, symbol_, category_, collection_, name_, default_, has_range_, min_, max_) \
+  _FBTweakCStorage(handle_type_, type_, symbol_, category_, collection_, name_, default_, has_range_, min_, max_) \
+  __attribute__((unused)) static const handle_type_ *const symbol_ = &__fb_tweak_c_storage_##symbol_
+
+/**
+  @abstract Common parameters in these macros.
+  @discussion Use at file scope. Tweaks declared here appear in the same
+    categories and collections as those from FBTweakInline.h, and share
+    values with Objective-C tweaks of the same name.
+  @param symbol_ The name of the handle to declare.
+  @param category_ The category the tweak's collection is in. Must be a C string literal.
+  @param collection_ The collection the tweak goes in. Must be a C string literal.
+  @param name_ The name of the tweak. Must be a C string literal.
+  @param default_ The default value of the tweak. Used in release builds.
+  @param min_ The minimum value. Must be a constant.
+  @param max_ The maximum value. Must be a constant.
+ */
+
+/**
+  @abstract Declares a bool tweak handle. Read with fb_tweak_get_bool().
+ */
+#define FBTweakCBool(symbol_, category_, collection_, name_, default_) \
+  _FBTweakCHandle(fb_tweak_bool_handle, fb_tweak_c_type_bool, symbol_, category_, collection_, name_, default_, 0, false, false)
+
+/**
+  @abstract Declares an integer tweak handle. Read with fb_tweak_get_integer().
+ */
+#define FBTweakCInteger(symbol_, category_, collection_, name_, default_) \
+  _FBTweakCHandle(fb_tweak_integer_handle, fb_tweak_c_type_integer, symbol_, category_, collection_, name_, default_, 0, 0, 0)
+
+/**
+  @abstract Declares an integer tweak handle with a range.
+ */
+#define FBTweakCIntegerRange(symbol_, category_, collection_, name_, default_, min_, max_) \
+  _FBTweakCHandle(fb_tweak_integer_handle, fb_tweak_c_type_integer, symbol_, category_, collection_, name_, default_, 1, min_, max_)
+
+/**
+  @abstract Declares a double tweak handle. Read with fb_tweak_get_double().
+ */
+#define FBTweakCDouble(symbol_, category_, collection_, name_, default_) \
+  _FBTweakCHandle(fb_tweak_double_handle, fb_tweak_c_type_double, symbol_, category_, collection_, name_, default_, 0, 0.0, 0.0)
+
+/**
+  @abstract Declares a double tweak handle with a range.
+ */
+#define FBTweakCDoubleRange(symbol_, category_, collection_, name_, default_, min_, max_) \
+  _FBTweakCHandle(fb_tweak_double_handle, fb_tweak_c_type_double, symbol_, category_, collection_, name_, default_, 1, min_, max_)
@@ -48,26 +48,35 @@
   [coder encodeObject:_orderedCollections forKey:@"collections"];
 }
 
+// Locked, since images unloaded on other threads remove their tweaks there.
 - (FBTweakCollection *)tweakCollectionWithName:(NSString *)name
 {
-  return _namedCollections[name];
+  @synchronized (self) {
+    return _namedCollections[name];
+  }
 }
 
 - (NSArray *)tweakCollections
 {
-  return [_orderedCollections copy];
+  @synchronized (self) {
+    return [_orderedCollections copy];
+  }
 }
 
 - (void)addTweakCollection:(FBTweakCollection *)tweakCollection
 {
-  [_orderedCollections addObject:tweakCollection];
-  [_namedCollections setObject:tweakCollection forKey:tweakCollection.name];
+  @synchronized (self) {
+    [_orderedCollections addObject:tweakCollection];
+    [_namedCollections setObject:tweakCollection forKey:tweakCollection.name];
+  }
 }
 
 - (void)removeTweakCollection:(FBTweakCollection *)tweakCollection
 {
-  [_orderedCollections removeObject:tweakCollection];
-  [_namedCollections removeObjectForKey:tweakCollection.name];
+  @synchronized (self) {
+    [_orderedCollections removeObject:tweakCollection];
+    [_namedCollections removeObjectForKey:tweakCollection.name];
+  }
 }
 
 @end
@@ -29,6 +29,7 @@
 
 /**
   @abstract The tweaks contained in this collection.
+  @discussion Tweaks declared inline are created when first accessed.
  */
 @property (nonatomic, copy, readonly) NSArray *tweaks;
 
@@ -1,7 +1,7 @@
 /**
  Copyright (c) 2014-present, Facebook, Inc.
  All rights reserved.
- 
+
  This source code is licensed under the BSD-style license found in the
  LICENSE file in the root directory of this source tree. An additional grant
  of patent rights can be found in the PATENTS file in the same directory.
@@ -9,24 +9,63 @@
 
 #import "FBTweakCollection.h"
 #import "FBTweak.h"
+#import "_FBTweakCollection.h"
+
+#import <pthread.h>
+
+// Slots tagged with this bit hold a section entry rather than a tweak.
+static const uintptr_t _FBTweakCollectionEntryTag = 1;
+
+uint64_t _FBTweakIdentifierHashAppend(uint64_t hash, const char *string)
+{
+  // FNV-1a.
+  for (const char *c = string; *c != '\0'; c++) {
+    hash ^= (uint8_t)*c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t _FBTweakIdentifierHash(NSString *identifier)
+{
+  const char *string = CFStringGetCStringPtr((__bridge CFStringRef)identifier, kCFStringEncodingUTF8) ?: [identifier UTF8String];
+  return _FBTweakIdentifierHashAppend(_FBTweakIdentifierHashInitial, string);
+}
 
 @implementation FBTweakCollection {
-  NSMutableArray *_orderedTweaks;
-  NSMutableDictionary *_identifierTweaks;
+  // Tweaks in order, as parallel arrays. Each slot holds either a retained
+  // tweak added with -addTweak:, or a tagged pointer to a section entry
+  // whose tweak is created the first time it's needed.
+  uintptr_t *_slots;
+  uint64_t *_slotHashes;
+  NSUInteger _slotCount;
+  NSUInteger _slotCapacity;
+
+  // Open addressed, from identifier hash to slot plus one.
+  uint32_t *_index;
+  NSUInteger _indexMask;
+
+  // Tweaks created from entries. Held weakly by entry, so an entry has one
+  // tweak while anything uses it, and strongly until memory pressure.
+  NSMapTable *_entryTweaks;
+  NSMutableSet *_cachedEntryTweaks;
+
+  // Held for every use of the above. Tweaks are created on whichever
+  // thread reads them first, and images unloaded on other threads remove
+  // their entries there. Recursive, as lookups create tweaks.
+  pthread_mutex_t _mutex;
 }
 
 - (instancetype)initWithCoder:(NSCoder *)coder
 {
   NSString *name = [coder decodeObjectForKey:@"name"];
-  
+
   if ((self = [self initWithName:name])) {
-    _orderedTweaks = [[coder decodeObjectForKey:@"tweaks"] mutableCopy];
-    
-    for (FBTweak *tweak in _orderedTweaks) {
-      [_identifierTweaks setObject:tweak forKey:tweak.identifier];
+    for (FBTweak *tweak in [coder decodeObjectForKey:@"tweaks"]) {
+      [self addTweak:tweak];
     }
   }
-  
+
   return self;
 }
 
@@ -34,40 +73,292 @@
 {
   if ((self = [super init])) {
     _name = [name copy];
-    
-    _orderedTweaks = [[NSMutableArray alloc] initWithCapacity:4];
-    _identifierTweaks = [[NSMutableDictionary alloc] initWithCapacity:4];
+
+    _entryTweaks = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality) valueOptions:NSPointerFunctionsWeakMemory capacity:0];
+    _cachedEntryTweaks = [[NSMutableSet alloc] init];
+
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
   }
-  
+
   return self;
 }
 
+- (void)dealloc
+{
+  for (NSUInteger i = 0; i < _slotCount; i++) {
+    if ((_slots[i] & _FBTweakCollectionEntryTag) == 0) {
+      CFRelease((CFTypeRef)_slots[i]);
+    }
+  }
+
+  free(_slots);
+  free(_slotHashes);
+  free(_index);
+  pthread_mutex_destroy(&_mutex);
+}
+
 - (void)encodeWithCoder:(NSCoder *)coder
 {
   [coder encodeObject:_name forKey:@"name"];
-  [coder encodeObject:_orderedTweaks forKey:@"tweaks"];
+  [coder encodeObject:self.tweaks forKey:@"tweaks"];
 }
 
+#pragma mark Slots
+
+- (FBTweak *)_tweakAtSlot:(NSUInteger)slot
+{
+  uintptr_t value = _slots[slot];
+  if ((value & _FBTweakCollectionEntryTag) == 0) {
+    return (__bridge FBTweak *)(void *)value;
+  }
+
+  const void *entry = (const void *)(value & ~_FBTweakCollectionEntryTag);
+  pthread_mutex_lock(&_mutex);
+  FBTweak *tweak = [_entryTweaks objectForKey:(__bridge id)entry];
+  if (tweak == nil) {
+    tweak = _FBTweakInlineCreateTweak(entry);
+
+    if (tweak != nil) {
+      [_entryTweaks setObject:tweak forKey:(__bridge id)entry];
+      [_cachedEntryTweaks addObject:tweak];
+    }
+  }
+  pthread_mutex_unlock(&_mutex);
+
+  return tweak;
+}
+
+- (void)_indexSlot:(NSUInteger)slot
+{
+  NSUInteger position = (NSUInteger)_slotHashes[slot] & _indexMask;
+  while (_index[position] != 0) {
+    position = (position + 1) & _indexMask;
+  }
+  _index[position] = (uint32_t)slot + 1;
+}
+
+- (void)_rebuildIndex
+{
+  // Kept at most half full.
+  NSUInteger capacity = 8;
+  while (capacity < _slotCount * 2) {
+    capacity <<= 1;
+  }
+
+  free(_index);
+  _index = calloc(capacity, sizeof(*_index));
+  _indexMask = capacity - 1;
+
+  for (NSUInteger i = 0; i < _slotCount; i++) {
+    [self _indexSlot:i];
+  }
+}
+
+- (void)_appendSlot:(uintptr_t)value hash:(uint64_t)hash
+{
+  pthread_mutex_lock(&_mutex);
+
+  if (_slotCount == _slotCapacity) {
+    _slotCapacity = MAX(_slotCapacity * 2, (NSUInteger)4);
+    _slots = realloc(_slots, _slotCapacity * sizeof(*_slots));
+    _slotHashes = realloc(_slotHashes, _slotCapacity * sizeof(*_slotHashes));
+  }
+
+  _slots[_slotCount] = value;
+  _slotHashes[_slotCount] = hash;
+  _slotCount++;
+
+  if (_index == NULL || _slotCount * 2 > _indexMask + 1) {
+    [self _rebuildIndex];
+  } else {
+    [self _indexSlot:_slotCount - 1];
+  }
+
+  pthread_mutex_unlock(&_mutex);
+}
+
+- (void)_removeSlotsPassingTest:(BOOL (^)(uintptr_t value))test
+{
+  pthread_mutex_lock(&_mutex);
+
+  NSUInteger count = 0;
+  for (NSUInteger i = 0; i < _slotCount; i++) {
+    uintptr_t value = _slots[i];
+
+    if (test(value)) {
+      if ((value & _FBTweakCollectionEntryTag) == 0) {
+        CFRelease((CFTypeRef)value);
+      } else {
+        const void *entry = (const void *)(value & ~_FBTweakCollectionEntryTag);
+        FBTweak *tweak = [_entryTweaks objectForKey:(__bridge id)entry];
+        if (tweak != nil) {
+          [_cachedEntryTweaks removeObject:tweak];
+          [_entryTweaks removeObjectForKey:(__bridge id)entry];
+        }
+      }
+    } else {
+      _slots[count] = value;
+      _slotHashes[count] = _slotHashes[i];
+      count++;
+    }
+  }
+
+  if (count != _slotCount) {
+    _slotCount = count;
+    [self _rebuildIndex];
+  }
+
+  pthread_mutex_unlock(&_mutex);
+}
+
+// With a nil identifier, matches on hash alone without creating tweaks.
+- (NSUInteger)_slotWithHash:(uint64_t)hash identifier:(NSString *)identifier
+{
+  if (_index == NULL) {
+    return NSNotFound;
+  }
+
+  for (NSUInteger position = (NSUInteger)hash & _indexMask; _index[position] != 0; position = (position + 1) & _indexMask) {
+    NSUInteger slot = _index[position] - 1;
+    if (_slotHashes[slot] != hash) {
+      continue;
+    }
+
+    if (identifier == nil || [[self _tweakAtSlot:slot].identifier isEqualToString:identifier]) {
+      return slot;
+    }
+  }
+
+  return NSNotFound;
+}
+
+#pragma mark Tweaks
+
 - (FBTweak *)tweakWithIdentifier:(NSString *)identifier
 {
-  return _identifierTweaks[identifier];
+  uint64_t hash = _FBTweakIdentifierHash(identifier);
+
+  pthread_mutex_lock(&_mutex);
+  NSUInteger slot = [self _slotWithHash:hash identifier:identifier];
+  FBTweak *tweak = (slot != NSNotFound ? [self _tweakAtSlot:slot] : nil);
+  pthread_mutex_unlock(&_mutex);
+
+  return tweak;
 }
 
 - (NSArray *)tweaks
 {
-  return [_orderedTweaks copy];
+  pthread_mutex_lock(&_mutex);
+  NSMutableArray *tweaks = [[NSMutableArray alloc] initWithCapacity:_slotCount];
+  for (NSUInteger i = 0; i < _slotCount; i++) {
+    FBTweak *tweak = [self _tweakAtSlot:i];
+    if (tweak != nil) {
+      [tweaks addObject:tweak];
+    }
+  }
+  pthread_mutex_unlock(&_mutex);
+
+  return tweaks;
 }
 
 - (void)addTweak:(FBTweak *)tweak
 {
-  [_orderedTweaks addObject:tweak];
-  [_identifierTweaks setObject:tweak forKey:tweak.identifier];
+  [self _appendSlot:(uintptr_t)CFBridgingRetain(tweak) hash:_FBTweakIdentifierHash(tweak.identifier)];
 }
 
 - (void)removeTweak:(FBTweak *)tweak
 {
-  [_orderedTweaks removeObject:tweak];
-  [_identifierTweaks removeObjectForKey:tweak.identifier];
+  [self _removeSlotsPassingTest:^BOOL(uintptr_t value) {
+    if ((value & _FBTweakCollectionEntryTag) == 0) {
+      return (value == (uintptr_t)(__bridge void *)tweak);
+    } else {
+      const void *entry = (const void *)(value & ~_FBTweakCollectionEntryTag);
+      return ([_entryTweaks objectForKey:(__bridge id)entry] == tweak);
+    }
+  }];
+}
+
+#pragma mark Entries
+
+- (BOOL)_addTweakEntry:(const void *)entry identifierHash:(uint64_t)identifierHash
+{
+  NSParameterAssert(entry != NULL);
+  NSAssert(((uintptr_t)entry & _FBTweakCollectionEntryTag) == 0, @"entry %p is misaligned", entry);
+
+  pthread_mutex_lock(&_mutex);
+  BOOL added = ([self _slotWithHash:identifierHash identifier:nil] == NSNotFound);
+  if (added) {
+    [self _appendSlot:((uintptr_t)entry | _FBTweakCollectionEntryTag) hash:identifierHash];
+  }
+  pthread_mutex_unlock(&_mutex);
+
+  return added;
+}
+
+- (FBTweak *)_tweakWithIdentifierHash:(uint64_t)identifierHash
+{
+  pthread_mutex_lock(&_mutex);
+  NSUInteger slot = [self _slotWithHash:identifierHash identifier:nil];
+  FBTweak *tweak = (slot != NSNotFound ? [self _tweakAtSlot:slot] : nil);
+  pthread_mutex_unlock(&_mutex);
+
+  return tweak;
+}
+
+- (void)_removeTweakEntries:(const void *)entries size:(size_t)size
+{
+  uintptr_t start = (uintptr_t)entries;
+  uintptr_t end = start + size;
+
+  [self _removeSlotsPassingTest:^BOOL(uintptr_t value) {
+    uintptr_t entry = (value & ~_FBTweakCollectionEntryTag);
+    return ((value & _FBTweakCollectionEntryTag) != 0 && entry >= start && entry < end);
+  }];
+}
+
+- (NSUInteger)_tweakCount
+{
+  pthread_mutex_lock(&_mutex);
+  NSUInteger count = _slotCount;
+  pthread_mutex_unlock(&_mutex);
+
+  return count;
+}
+
+- (void)_enumerateIdentifierHashesUsingBlock:(void (^)(uint64_t identifierHash))block
+{
+  pthread_mutex_lock(&_mutex);
+  for (NSUInteger i = 0; i < _slotCount; i++) {
+    block(_slotHashes[i]);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+- (void)_releaseCachedTweaks
+{
+  pthread_mutex_lock(&_mutex);
+
+  NSMutableSet *pinnedTweaks = [[NSMutableSet alloc] init];
+  for (FBTweak *tweak in _cachedEntryTweaks) {
+    if ([tweak _isPinned]) {
+      [pinnedTweaks addObject:tweak];
+    }
+  }
+
+  // Tweaks still referenced elsewhere stay in the weak table, so they are
+  // found again rather than created twice.
+  NSMutableSet *releasedTweaks = _cachedEntryTweaks;
+  _cachedEntryTweaks = pinnedTweaks;
+
+  pthread_mutex_unlock(&_mutex);
+
+  // Released outside the mutex, in case a tweak's last release reaches
+  // back into the collection.
+  releasedTweaks = nil;
 }
 
 @end
@@ -0,0 +1,49 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract The result of compacting persisted tweak values.
+  @discussion Returned by {@ref -[FBTweakStore compactPersistedValuesWithRetentionInterval:dryRun:]}.
+ */
+@interface FBTweakCompactionReport : NSObject
+
+/**
+  @abstract Creates a report.
+  @discussion This is the designated initializer.
+ */
+- (instancetype)initWithRemovedIdentifiers:(NSArray *)removedIdentifiers
+                       retainedIdentifiers:(NSArray *)retainedIdentifiers
+                              removedBytes:(NSUInteger)removedBytes
+                                    dryRun:(BOOL)dryRun;
+
+/**
+  @abstract Identifiers of orphaned values that were removed.
+  @discussion For a dry run, the values that would have been removed.
+ */
+@property (nonatomic, copy, readonly) NSArray *removedIdentifiers;
+
+/**
+  @abstract Identifiers of orphaned values kept by the retention interval.
+ */
+@property (nonatomic, copy, readonly) NSArray *retainedIdentifiers;
+
+/**
+  @abstract The size of the removed values' data and strings, in bytes.
+  @discussion Numbers aren't counted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger removedBytes;
+
+/**
+  @abstract If nothing was actually removed.
+ */
+@property (nonatomic, assign, readonly, getter = isDryRun) BOOL dryRun;
+
+@end
@@ -0,0 +1,43 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakCompactionReport.h"
+
+@implementation FBTweakCompactionReport
+
+- (instancetype)initWithRemovedIdentifiers:(NSArray *)removedIdentifiers
+                       retainedIdentifiers:(NSArray *)retainedIdentifiers
+                              removedBytes:(NSUInteger)removedBytes
+                                    dryRun:(BOOL)dryRun
+{
+  if ((self = [super init])) {
+    _removedIdentifiers = [removedIdentifiers copy];
+    _retainedIdentifiers = [retainedIdentifiers copy];
+    _removedBytes = removedBytes;
+    _dryRun = dryRun;
+  }
+
+  return self;
+}
+
+- (NSString *)description
+{
+  NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p; %@%lu removed (%lu bytes), %lu retained>", [self class], self, (_dryRun ? @"dry run, " : @""), (unsigned long)_removedIdentifiers.count, (unsigned long)_removedBytes, (unsigned long)_retainedIdentifiers.count];
+
+  for (NSString *identifier in _removedIdentifiers) {
+    [description appendFormat:@"\n  - %@", identifier];
+  }
+  for (NSString *identifier in _retainedIdentifiers) {
+    [description appendFormat:@"\n  = %@", identifier];
+  }
+
+  return description;
+}
+
+@end
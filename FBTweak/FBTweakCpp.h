@@ -0,0 +1,100 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <cstdint>
+#include <type_traits>
+
+#include "FBTweakC.h"
+
+namespace fb {
+
+namespace detail {
+
+template <typename T, typename Enable = void>
+struct TweakTraits;
+
+template <>
+struct TweakTraits<bool> {
+  typedef fb_tweak_bool_handle Handle;
+  typedef bool Storage;
+  enum { type = fb_tweak_c_type_bool };
+  static bool get(const Handle *handle) { return fb_tweak_get_bool(handle); }
+};
+
+template <typename T>
+struct TweakTraits<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  typedef fb_tweak_integer_handle Handle;
+  typedef int64_t Storage;
+  enum { type = fb_tweak_c_type_integer };
+  static T get(const Handle *handle) { return static_cast<T>(fb_tweak_get_integer(handle)); }
+};
+
+template <typename T>
+struct TweakTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  typedef fb_tweak_double_handle Handle;
+  typedef double Storage;
+  enum { type = fb_tweak_c_type_double };
+  static T get(const Handle *handle) { return static_cast<T>(fb_tweak_get_double(handle)); }
+};
+
+} // namespace detail
+
+/**
+  @abstract A typed view of a tweak handle.
+  @discussion Declare with FBTweakCpp() or FBTweakCppRange(). Reading is a
+    single load from the handle, kept up to date by the tweak's FBTweak.
+ */
+template <typename T>
+class Tweak {
+public:
+  typedef typename detail::TweakTraits<T>::Handle Handle;
+
+  constexpr explicit Tweak(const Handle *handle) : _handle(handle) {}
+
+  /**
+    @abstract The current value, or the default if none is set.
+   */
+  T get() const { return detail::TweakTraits<T>::get(_handle); }
+
+  operator T() const { return get(); }
+
+private:
+  const Handle *_handle;
+};
+
+} // namespace fb
+
+#define _FBTweakCppStorage(type_, symbol_, category_, collection_, name_, default_, has_range_, min_, max_) \
+  _FBTweakCStorage(fb::detail::TweakTraits<type_>::Handle, \
+                   static_cast<fb_tweak_c_type>(fb::detail::TweakTraits<type_>::type), \
+                   symbol_, category_, collection_, name_, \
+                   static_cast<fb::detail::TweakTraits<type_>::Storage>(static_cast<type_>(default_)), \
+                   has_range_, \
+                   static_cast<fb::detail::TweakTraits<type_>::Storage>(static_cast<type_>(min_)), \
+                   static_cast<fb::detail::TweakTraits<type_>::Storage>(static_cast<type_>(max_)))
+
+/**
+  @abstract Declares a typed tweak.
+  @discussion Use at file scope. Parameters are as for FBTweakCDouble(),
+    with the value type first; it may be bool, any integer or any floating
+    point type.
+ */
+#define FBTweakCpp(type_, symbol_, category_, collection_, name_, default_) \
+  _FBTweakCppStorage(type_, symbol_, category_, collection_, name_, default_, 0, default_, default_) \
+  static const fb::Tweak<type_> symbol_(&__fb_tweak_c_storage_##symbol_)
+
+/**
+  @abstract Declares a typed tweak with a range.
+  @discussion The default is checked against the range at compile time.
+ */
+#define FBTweakCppRange(type_, symbol_, category_, collection_, name_, default_, min_, max_) \
+  static_assert(static_cast<type_>(min_) <= static_cast<type_>(default_) && static_cast<type_>(default_) <= static_cast<type_>(max_), \
+                "default value of " #symbol_ " must be within its range"); \
+  _FBTweakCppStorage(type_, symbol_, category_, collection_, name_, default_, 1, min_, max_) \
+  static const fb::Tweak<type_> symbol_(&__fb_tweak_c_storage_##symbol_)
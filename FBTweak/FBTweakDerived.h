@@ -0,0 +1,46 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract A value computed from tweaks, cached until one of them changes.
+  @discussion The block is run the first time the value is read. While it
+    runs, every tweak whose current value it reads is recorded, as is every
+    derived value it reads, so derived values can be built from each other.
+    The result is kept until one of those changes, and is only computed
+    again when next read. Inside +[FBTweakStore withOverrides:], the block
+    is run on every read and nothing is cached.
+ */
+@interface FBTweakDerivedValue : NSObject
+
+/**
+  @abstract Creates a derived value.
+  @discussion This is the designated initializer.
+  @param block Computes the value. Must not read this derived value.
+ */
+- (instancetype)initWithBlock:(id (^)(void))block;
+
+/**
+  @abstract The value, computed if it hasn't been since a dependency changed.
+ */
+@property (nonatomic, strong, readonly) id value;
+
+/**
+  @abstract The tweaks and derived values read by the last computation.
+ */
+@property (nonatomic, copy, readonly) NSSet *dependencies;
+
+@end
+
+/**
+  @abstract Creates a {@ref FBTweakDerivedValue} from a block.
+  @param block_ Computes the value from tweaks and other derived values.
+ */
+#define FBTweakDerived(block_) ([[FBTweakDerivedValue alloc] initWithBlock:(block_)])
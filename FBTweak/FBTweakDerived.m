@@ -0,0 +1,190 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakDerived.h"
+#import "FBTweak.h"
+#import "FBTweakSnapshot.h"
+#import "_FBTweakDerived.h"
+#import "_FBTweakFrozen.h"
+#import "_FBTweakOverrides.h"
+
+#import <pthread.h>
+
+__thread CFMutableSetRef _FBTweakDerivedDependencies = NULL;
+
+@interface FBTweakDerivedValue () <FBTweakObserver>
+@end
+
+@implementation FBTweakDerivedValue {
+  id (^_block)(void);
+  pthread_mutex_t _mutex;
+
+  // Guarded by the mutex.
+  BOOL _valid;
+  BOOL _frozen;
+  id _value;
+  NSSet *_dependencies;
+
+  // Derived values that read this one. Guarded by synchronizing on it.
+  NSHashTable *_dependents;
+}
+
+- (instancetype)initWithBlock:(id (^)(void))block
+{
+  NSParameterAssert(block != NULL);
+
+  if ((self = [super init])) {
+    _block = [block copy];
+    _dependents = [NSHashTable weakObjectsHashTable];
+    // Recursive, so a block that changes a tweak it read doesn't deadlock.
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  for (id dependency in _dependencies) {
+    if ([dependency isKindOfClass:[FBTweak class]]) {
+      [(FBTweak *)dependency removeObserver:self];
+    }
+  }
+
+  pthread_mutex_destroy(&_mutex);
+}
+
+- (id)value
+{
+  if (_FBTweakOverridesLayer != NULL) {
+    // Overridden values are only seen by this thread, so aren't cached.
+    // Reads inside are recorded by any derived value computing outside.
+    return _block();
+  }
+
+  // Recorded before locking, so the reader sees this value's changes.
+  _FBTweakDerivedRecordDependency(self);
+
+  pthread_mutex_lock(&_mutex);
+
+  // Frozen call sites skip their tweaks, so freezing changes the value.
+  if (!_valid || _frozen != _FBTweakIsFrozen()) {
+    [self _computeValue];
+  }
+  id value = _value;
+
+  pthread_mutex_unlock(&_mutex);
+
+  return value;
+}
+
+- (NSSet *)dependencies
+{
+  pthread_mutex_lock(&_mutex);
+  NSSet *dependencies = _dependencies;
+  pthread_mutex_unlock(&_mutex);
+
+  return dependencies;
+}
+
+- (void)_computeValue
+{
+  // A change between a read and observing the tweak read would be missed,
+  // so any change during the computation leaves the value invalid.
+  uint64_t generation = FBTweakGeneration();
+  BOOL frozen = _FBTweakIsFrozen();
+
+  CFMutableSetRef enclosingDependencies = _FBTweakDerivedDependencies;
+  CFMutableSetRef recordedDependencies = CFSetCreateMutable(kCFAllocatorDefault, 0, &kCFTypeSetCallBacks);
+
+  _FBTweakDerivedDependencies = recordedDependencies;
+  id value = _block();
+  _FBTweakDerivedDependencies = enclosingDependencies;
+
+  NSSet *dependencies = [(__bridge NSSet *)recordedDependencies copy];
+  CFRelease(recordedDependencies);
+
+  [self _stopObservingDependencies:_dependencies];
+  [self _startObservingDependencies:dependencies];
+
+  _value = value;
+  _dependencies = dependencies;
+  _frozen = frozen;
+  _valid = (FBTweakGeneration() == generation);
+}
+
+- (void)_startObservingDependencies:(NSSet *)dependencies
+{
+  for (id dependency in dependencies) {
+    if ([dependency isKindOfClass:[FBTweak class]]) {
+      [(FBTweak *)dependency addObserver:self];
+    } else if ([dependency isKindOfClass:[FBTweakDerivedValue class]]) {
+      [(FBTweakDerivedValue *)dependency _addDependent:self];
+    }
+  }
+}
+
+- (void)_stopObservingDependencies:(NSSet *)dependencies
+{
+  for (id dependency in dependencies) {
+    if ([dependency isKindOfClass:[FBTweak class]]) {
+      [(FBTweak *)dependency removeObserver:self];
+    } else if ([dependency isKindOfClass:[FBTweakDerivedValue class]]) {
+      [(FBTweakDerivedValue *)dependency _removeDependent:self];
+    }
+  }
+}
+
+- (void)_addDependent:(FBTweakDerivedValue *)dependent
+{
+  @synchronized (_dependents) {
+    [_dependents addObject:dependent];
+  }
+}
+
+- (void)_removeDependent:(FBTweakDerivedValue *)dependent
+{
+  @synchronized (_dependents) {
+    [_dependents removeObject:dependent];
+  }
+}
+
+- (void)_invalidate
+{
+  pthread_mutex_lock(&_mutex);
+  BOOL wasValid = _valid;
+  _valid = NO;
+  pthread_mutex_unlock(&_mutex);
+
+  if (!wasValid) {
+    // Dependents were invalidated along with this value, and haven't read
+    // it since.
+    return;
+  }
+
+  NSArray *dependents = nil;
+  @synchronized (_dependents) {
+    dependents = [_dependents allObjects];
+  }
+
+  for (FBTweakDerivedValue *dependent in dependents) {
+    [dependent _invalidate];
+  }
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  [self _invalidate];
+}
+
+@end
@@ -37,6 +37,19 @@
  */
 #define FBTweakValue(category_, collection_, name_, ...) _FBTweakValue(category_, collection_, name_, __VA_ARGS__)
 
+/**
+  @abstract Loads the value of a tweak inline, even in release builds.
+  @discussion The same as {@ref FBTweakValue} while tweaks are enabled. In
+    release builds, the value comes from an overrides file read once at
+    launch: the bundled file, {@ref FBTweakReleaseBundledOverridesName}, and
+    the downloaded one at {@ref FBTweakReleaseDownloadedOverridesPath}. Each
+    read is then a single load from a read-only table, and the tweak has no
+    UI, observers or persistence. Use sparingly, for values that must be
+    changeable in production.
+  @return The overridden value of the tweak, or the default value if none is set.
+ */
+#define FBTweakReleaseValue(category_, collection_, name_, ...) _FBTweakReleaseValue(category_, collection_, name_, __VA_ARGS__)
+
 /**
   @abstract Binds an object property to a tweak.
   @param object_ The object to bind to.
@@ -45,6 +58,16 @@
  */
 #define FBTweakBind(object_, property_, category_, collection_, name_, ...) _FBTweakBind(object_, property_, category_, collection_, name_, __VA_ARGS__)
 
+/**
+  @abstract Binds a plain C variable to a tweak.
+  @param variable_ A pointer to the variable to bind, such as &g_var. Must be a
+    global or static integer, floating point or BOOL variable.
+  @discussion The variable is set to the tweak's value now and again whenever it
+    changes, with a single atomic store, so reading it costs nothing more than
+    reading any other variable. In release builds, it's set to the default value.
+ */
+#define FBTweakBindVariable(variable_, category_, collection_, name_, ...) _FBTweakBindVariable(variable_, category_, collection_, name_, __VA_ARGS__)
+
 /**
   @abstract Performs an action on tweak selection.
   @param ... The last parameter is a block containing the action to run.
@@ -53,4 +76,14 @@
  */
 #define FBTweakAction(category_, collection_, name_, ...) _FBTweakAction(category_, collection_, name_, __VA_ARGS__)
 
+/**
+  @abstract Performs an action on tweak selection, where its policy says.
+  @param policy_ The FBTweakActionPolicy to run the action with.
+  @param ... The last parameter is a block containing the action to run.
+  @discussion Like {@ref FBTweakAction}, but the action can run off the main
+    thread, and report progress and stop when cancelled through
+    [NSProgress currentProgress]. See {@ref FBTweakActionRunner}.
+ */
+#define FBTweakActionWithPolicy(category_, collection_, name_, policy_, ...) _FBTweakActionWithPolicy(category_, collection_, name_, policy_, __VA_ARGS__)
+
 
@@ -13,132 +13,531 @@
 #import "FBTweakCollection.h"
 #import "FBTweakStore.h"
 #import "FBTweakCategory.h"
+#import "_FBTweakCHandle.h"
+#import "_FBTweakCollection.h"
+#import "_FBTweakRegistryCache.h"
+#import "_FBTweakStore.h"
 
 #import <UIKit/UIKit.h>
 #import <libkern/OSAtomic.h>
 #import <mach-o/getsect.h>
 #import <mach-o/dyld.h>
+#import <mach-o/loader.h>
 #import <dlfcn.h>
+#import <pthread.h>
 
 #if FB_TWEAK_ENABLED
 
+// Values of tweaks gone for this long are removed from the user defaults.
+static const NSTimeInterval _FBTweakInlinePersistedValueRetentionInterval = 7 * 24 * 60 * 60;
+
+static BOOL _FBTweakEntryIsC(fb_tweak_entry *entry)
+{
+  return (strcmp(entry->encoding, FBTweakEncodingC) == 0);
+}
+
+// Entries declared with FBTweakC.h have C strings for names.
+static NSString *_FBTweakEntryString(fb_tweak_entry *entry, FBTweakLiteralString field)
+{
+  if (_FBTweakEntryIsC(entry)) {
+    return [NSString stringWithUTF8String:(const char *)(__bridge const void *)field];
+  } else {
+    return field;
+  }
+}
+
 extern NSString *_FBTweakIdentifier(fb_tweak_entry *entry)
 {
-  return [NSString stringWithFormat:@"FBTweak:%@-%@-%@", *entry->category, *entry->collection, *entry->name];
+  return [NSString stringWithFormat:@"FBTweak:%@-%@-%@", _FBTweakEntryString(entry, entry->category), _FBTweakEntryString(entry, entry->collection), _FBTweakEntryString(entry, entry->name)];
+}
+
+static const char *_FBTweakEntryUTF8String(fb_tweak_entry *entry, FBTweakLiteralString field)
+{
+  if (_FBTweakEntryIsC(entry)) {
+    return (const char *)(__bridge const void *)field;
+  } else {
+    return [field UTF8String];
+  }
+}
+
+// Matches _FBTweakIdentifierHash(_FBTweakIdentifier(entry)), without
+// formatting the identifier.
+static uint64_t _FBTweakEntryIdentifierHash(fb_tweak_entry *entry)
+{
+  uint64_t hash = _FBTweakIdentifierHashAppend(_FBTweakIdentifierHashInitial, "FBTweak:");
+  hash = _FBTweakIdentifierHashAppend(hash, _FBTweakEntryUTF8String(entry, entry->category));
+  hash = _FBTweakIdentifierHashAppend(hash, "-");
+  hash = _FBTweakIdentifierHashAppend(hash, _FBTweakEntryUTF8String(entry, entry->collection));
+  hash = _FBTweakIdentifierHashAppend(hash, "-");
+  hash = _FBTweakIdentifierHashAppend(hash, _FBTweakEntryUTF8String(entry, entry->name));
+  return hash;
+}
+
+static FBTweak *_FBTweakCreateWithCEntry(NSString *identifier, fb_tweak_entry *entry)
+{
+  const fb_tweak_c_handle_header *handle = entry->value;
+
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:identifier];
+  tweak.name = _FBTweakEntryString(entry, entry->name);
+  tweak.possibleValues = _FBTweakCHandlePossibleValues(handle);
+  tweak.defaultValue = _FBTweakCHandleDefaultValue(handle);
+  return tweak;
+}
+
+// Reads one of the constants an entry keeps for its default and range.
+static FBTweakValue _FBTweakEntryValueAtIndex(const char *encoding, const void *values, NSUInteger index)
+{
+  if (strcmp(encoding, @encode(BOOL)) == 0) {
+    return @(((const BOOL *)values)[index]);
+  } else if (strcmp(encoding, @encode(float)) == 0) {
+    return [NSNumber numberWithFloat:((const float *)values)[index]];
+  } else if (strcmp(encoding, @encode(double)) == 0) {
+    return [NSNumber numberWithDouble:((const double *)values)[index]];
+  } else if (strcmp(encoding, @encode(short)) == 0) {
+    return [NSNumber numberWithShort:((const short *)values)[index]];
+  } else if (strcmp(encoding, @encode(unsigned short)) == 0) {
+    return [NSNumber numberWithUnsignedShort:((const unsigned short *)values)[index]];
+  } else if (strcmp(encoding, @encode(int)) == 0) {
+    return [NSNumber numberWithInt:((const int *)values)[index]];
+  } else if (strcmp(encoding, @encode(unsigned int)) == 0) {
+    return [NSNumber numberWithUnsignedInt:((const unsigned int *)values)[index]];
+  } else if (strcmp(encoding, @encode(long)) == 0) {
+    return [NSNumber numberWithLong:((const long *)values)[index]];
+  } else if (strcmp(encoding, @encode(unsigned long)) == 0) {
+    return [NSNumber numberWithUnsignedLong:((const unsigned long *)values)[index]];
+  } else if (strcmp(encoding, @encode(long long)) == 0) {
+    return [NSNumber numberWithLongLong:((const long long *)values)[index]];
+  } else if (strcmp(encoding, @encode(unsigned long long)) == 0) {
+    return [NSNumber numberWithUnsignedLongLong:((const unsigned long long *)values)[index]];
+  } else if (strcmp(encoding, @encode(const char *)) == 0) {
+    return [NSString stringWithUTF8String:((const char *const *)values)[index]];
+  } else if (strcmp(encoding, @encode(id)) == 0) {
+    return ((__unsafe_unretained const id *)values)[index];
+  } else {
+    return nil;
+  }
+}
+
+FBTweakValue _FBTweakInlineBoxValue(const char *encoding, const void *value)
+{
+  return _FBTweakEntryValueAtIndex(encoding, value, 0);
 }
 
 static FBTweak *_FBTweakCreateWithEntry(NSString *identifier, fb_tweak_entry *entry)
 {
   FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:identifier];
-  tweak.name = *entry->name;
-
-  if (entry->possible != NULL) {
-    tweak.possibleValues = fb_tweak_entry_block_field(id, entry, possible);
-  }
-
-  if (strcmp(*entry->encoding, FBTweakEncodingAction) == 0) {
-    tweak.defaultValue = *(__strong dispatch_block_t *)entry->value;
-  } else if (strcmp(*entry->encoding, @encode(BOOL)) == 0) {
-    tweak.defaultValue = @(fb_tweak_entry_block_field(BOOL, entry, value));
-  } else if (strcmp(*entry->encoding, @encode(float)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithFloat:fb_tweak_entry_block_field(float, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(double)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithDouble:fb_tweak_entry_block_field(double, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(short)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithShort:fb_tweak_entry_block_field(short, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(unsigned short)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithUnsignedShort:fb_tweak_entry_block_field(unsigned short, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(int)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithInt:fb_tweak_entry_block_field(int, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(unsigned int)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithUnsignedInt:fb_tweak_entry_block_field(unsigned int, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(long)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithLong:fb_tweak_entry_block_field(long, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(unsigned long)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithUnsignedLong:fb_tweak_entry_block_field(unsigned long, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(long long)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithLongLong:fb_tweak_entry_block_field(long long, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(unsigned long long)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithUnsignedLongLong:fb_tweak_entry_block_field(unsigned long long, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(NSInteger)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithInteger:fb_tweak_entry_block_field(NSInteger, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(NSUInteger)) == 0) {
-    tweak.defaultValue = [NSNumber numberWithUnsignedInteger:fb_tweak_entry_block_field(NSUInteger, entry, value)];
-  } else if (*entry->encoding[0] == '[') {
-    // Assume it's a C string.
-    tweak.defaultValue = [NSString stringWithUTF8String:fb_tweak_entry_block_field(char *, entry, value)];
-  } else if (strcmp(*entry->encoding, @encode(id)) == 0) {
-    tweak.defaultValue = fb_tweak_entry_block_field(id, entry, value);
+  tweak.name = entry->name;
+
+  if (strcmp(entry->encoding, FBTweakEncodingAction) == 0) {
+    tweak.defaultValue = (__bridge dispatch_block_t)entry->value;
+    tweak.actionPolicy = (entry->possible != NULL ? *(const FBTweakActionPolicy *)entry->possible : FBTweakActionPolicyMainThread);
+    return tweak;
+  }
+
+  if (entry->possible == entry->value) {
+    // Ranges keep their minimum and maximum after the default.
+    tweak.possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:_FBTweakEntryValueAtIndex(entry->encoding, entry->value, 1)
+                                                                    maximumValue:_FBTweakEntryValueAtIndex(entry->encoding, entry->value, 2)];
+  } else if (entry->possible != NULL) {
+    [tweak _setPossibleValuesBlock:(__bridge id (^)(void))entry->possible];
+  }
+
+  if (strcmp(entry->encoding, @encode(id)) == 0) {
+    id (^defaultValueBlock)(void) = (__bridge id (^)(void))entry->value;
+    tweak.defaultValue = defaultValueBlock();
   } else {
-    NSCAssert(NO, @"Unknown encoding %s for tweak %@. Value was %p.", *entry->encoding, _FBTweakIdentifier(entry), entry->value);
+    tweak.defaultValue = _FBTweakEntryValueAtIndex(entry->encoding, entry->value, 0);
+  }
+
+  if (tweak.defaultValue == nil) {
+    NSCAssert(NO, @"Unknown encoding %s for tweak %@. Value was %p.", entry->encoding, _FBTweakIdentifier(entry), entry->value);
     tweak = nil;
   }
   
   return tweak;
 }
 
-@interface _FBTweakInlineLoader : NSObject
-@end
+#ifdef __LP64__
+typedef struct mach_header_64 fb_tweak_header;
+#else
+typedef struct mach_header fb_tweak_header;
+#endif
 
-@implementation _FBTweakInlineLoader
+static fb_tweak_entry *_FBTweakImageEntries(const struct mach_header *mach_header, size_t *count)
+{
+  unsigned long size = 0;
+  fb_tweak_entry *data = (fb_tweak_entry *)getsectiondata((const fb_tweak_header *)mach_header, FBTweakSegmentName, FBTweakSectionName, &size);
+  *count = (data != NULL ? size / sizeof(fb_tweak_entry) : 0);
+  return data;
+}
 
-+ (void)load
+// Tweaks registered by each loaded image, keyed by the image's header.
+// Only used with the registry lock held.
+static NSMapTable *_FBTweakImageTweaks(void)
 {
-  static uint32_t _tweaksLoaded = 0;
-  if (OSAtomicTestAndSetBarrier(1, &_tweaksLoaded)) {
+  static NSMapTable *imageTweaks = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    imageTweaks = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality) valueOptions:NSPointerFunctionsStrongMemory capacity:16];
+  });
+  return imageTweaks;
+}
+
+static BOOL _FBTweakImageUUID(const struct mach_header *mach_header, uint8_t *uuid)
+{
+  const uint8_t *command = (const uint8_t *)mach_header + (mach_header->magic == MH_MAGIC_64 ? sizeof(struct mach_header_64) : sizeof(struct mach_header));
+  for (uint32_t i = 0; i < mach_header->ncmds; i++) {
+    const struct load_command *loadCommand = (const struct load_command *)command;
+    if (loadCommand->cmd == LC_UUID) {
+      memcpy(uuid, ((const struct uuid_command *)loadCommand)->uuid, 16);
+      return YES;
+    }
+    command += loadCommand->cmdsize;
+  }
+  return NO;
+}
+
+// Where the image's registry is cached, or nil if it can't be.
+static NSString *_FBTweakImageRegistryCachePath(const struct mach_header *mach_header, uint8_t *uuid)
+{
+  Dl_info info;
+  if (!_FBTweakImageUUID(mach_header, uuid) || dladdr(mach_header, &info) == 0 || info.dli_fname == NULL) {
+    return nil;
+  }
+
+  NSString *imageName = [[NSString stringWithUTF8String:info.dli_fname] lastPathComponent];
+  return [_FBTweakRegistryCache pathForImageName:imageName];
+}
+
+static FBTweakCollection *_FBTweakInlineCollection(FBTweakStore *store, NSString *categoryName, NSString *collectionName)
+{
+  FBTweakCategory *category = [store tweakCategoryWithName:categoryName];
+  if (category == nil) {
+    category = [[FBTweakCategory alloc] initWithName:categoryName];
+    [store addTweakCategory:category];
+  }
+
+  FBTweakCollection *collection = [category tweakCollectionWithName:collectionName];
+  if (collection == nil) {
+    collection = [[FBTweakCollection alloc] initWithName:collectionName];
+    [category addTweakCollection:collection];
+  }
+
+  return collection;
+}
+
+static void _FBTweakInlineAddEntry(FBTweakCollection *collection, fb_tweak_entry *entry, BOOL isC, uint64_t identifierHash, NSMutableArray *tweaks)
+{
+  if (!isC) {
+    // Created on first use, straight from the entry.
+    [collection _addTweakEntry:entry identifierHash:identifierHash];
     return;
   }
-  
-#ifdef __LP64__
-  typedef uint64_t fb_tweak_value;
-  typedef struct section_64 fb_tweak_section;
-  typedef struct mach_header_64 fb_tweak_header;
-#define fb_tweak_getsectbynamefromheader getsectbynamefromheader_64
-#else
-  typedef uint32_t fb_tweak_value;
-  typedef struct section fb_tweak_section;
-  typedef struct mach_header fb_tweak_header;
-#define fb_tweak_getsectbynamefromheader getsectbynamefromheader
-#endif
-  
-  FBTweakStore *store = [FBTweakStore sharedInstance];
-  
-  uint32_t image_count = _dyld_image_count();
-  for (uint32_t image_index = 0; image_index < image_count; image_index++) {
-    const fb_tweak_header *mach_header = (const fb_tweak_header *)_dyld_get_image_header(image_index);
-
-    unsigned long size;
-    fb_tweak_entry *data = (fb_tweak_entry *)getsectiondata(mach_header, FBTweakSegmentName, FBTweakSectionName, &size);
-    if (data == NULL) {
-      continue;
+
+  // C handles are kept up to date by their tweak, so it's created now,
+  // sharing the tweak if it was declared elsewhere.
+  NSString *identifier = _FBTweakIdentifier(entry);
+  FBTweak *tweak = [collection tweakWithIdentifier:identifier];
+  if (tweak == nil) {
+    tweak = _FBTweakCreateWithCEntry(identifier, entry);
+    [collection addTweak:tweak];
+    [tweaks addObject:tweak];
+  }
+
+  [tweak _attachCHandle:(fb_tweak_c_handle_header *)entry->value];
+}
+
+// Adds every entry, reading names and hashing identifiers, and returns
+// what was worked out for the registry cache.
+static NSData *_FBTweakInlineAddEntries(FBTweakStore *store, fb_tweak_entry *data, size_t count, const uint8_t *uuid, NSMutableArray *tweaks)
+{
+  _FBTweakRegistryCacheEntry *cacheEntries = calloc(count, sizeof(*cacheEntries));
+  NSMapTable *collectionIndexes = [NSMapTable strongToStrongObjectsMapTable];
+  NSMutableArray *categoryNames = [[NSMutableArray alloc] init];
+  NSMutableArray *collectionNames = [[NSMutableArray alloc] init];
+
+  for (size_t i = 0; i < count; i++) {
+    fb_tweak_entry *entry = &data[i];
+    BOOL isC = _FBTweakEntryIsC(entry);
+
+    NSString *categoryName = _FBTweakEntryString(entry, entry->category);
+    NSString *collectionName = _FBTweakEntryString(entry, entry->collection);
+    FBTweakCollection *collection = _FBTweakInlineCollection(store, categoryName, collectionName);
+
+    NSNumber *collectionIndex = [collectionIndexes objectForKey:collection];
+    if (collectionIndex == nil) {
+      collectionIndex = @(collectionNames.count);
+      [collectionIndexes setObject:collectionIndex forKey:collection];
+      [categoryNames addObject:categoryName];
+      [collectionNames addObject:collectionName];
     }
-    size_t count = size / sizeof(fb_tweak_entry);
+
+    uint64_t identifierHash = _FBTweakEntryIdentifierHash(entry);
+    cacheEntries[i].identifierHash = identifierHash;
+    cacheEntries[i].collection = (uint32_t)[collectionIndex unsignedIntegerValue];
+    cacheEntries[i].flags = (isC ? _FBTweakRegistryCacheEntryC : 0);
+
+    _FBTweakInlineAddEntry(collection, entry, isC, identifierHash, tweaks);
+  }
+
+  NSData *cacheData = [_FBTweakRegistryCache dataWithUUID:uuid categoryNames:categoryNames collectionNames:collectionNames entries:cacheEntries count:count];
+  free(cacheEntries);
+  return cacheData;
+}
+
+// Adds every entry from a cache built by an earlier launch of the same
+// binary, so only each collection's names are read.
+static void _FBTweakInlineAddCachedEntries(FBTweakStore *store, fb_tweak_entry *data, size_t count, _FBTweakRegistryCache *cache, NSMutableArray *tweaks)
+{
+  NSUInteger collectionCount = cache.collectionCount;
+  NSMutableArray *collections = [[NSMutableArray alloc] initWithCapacity:collectionCount];
+  for (NSUInteger i = 0; i < collectionCount; i++) {
+    [collections addObject:_FBTweakInlineCollection(store, [cache categoryNameAtIndex:i], [cache collectionNameAtIndex:i])];
+  }
+
+  const _FBTweakRegistryCacheEntry *cacheEntries = cache.entries;
+  for (size_t i = 0; i < count; i++) {
+    BOOL isC = ((cacheEntries[i].flags & _FBTweakRegistryCacheEntryC) != 0);
+    _FBTweakInlineAddEntry(collections[cacheEntries[i].collection], &data[i], isC, cacheEntries[i].identifierHash, tweaks);
+  }
+}
+
+static void _FBTweakInlineWriteRegistryCache(NSData *cacheData, NSString *path)
+{
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+    [[NSFileManager defaultManager] createDirectoryAtPath:[path stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:NULL];
+    [cacheData writeToFile:path atomically:YES];
+  });
+}
+
+// Held while an image's tweaks are registered or removed, so an image
+// can't be unloaded halfway through registering. Never held while calling
+// into dyld, which may be waiting for it to remove an image.
+static pthread_mutex_t _FBTweakInlineRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Images loaded off the main thread whose tweaks aren't registered yet.
+static NSHashTable *_FBTweakImagesPending(void)
+{
+  static NSHashTable *imagesPending = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    imagesPending = [[NSHashTable alloc] initWithOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality) capacity:4];
+  });
+  return imagesPending;
+}
+
+static void _FBTweakInlineRegisterImage(const struct mach_header *mach_header, NSString *cachePath, const uint8_t *uuid)
+{
+  size_t count;
+  fb_tweak_entry *data = _FBTweakImageEntries(mach_header, &count);
+
+  @autoreleasepool {
+    FBTweakStore *store = [FBTweakStore sharedInstance];
+    NSMutableArray *tweaks = [[NSMutableArray alloc] initWithCapacity:count];
+
+    // Rebuilt from the section only when the binary changed since the
+    // registry was cached.
+    _FBTweakRegistryCache *cache = nil;
+    if (cachePath != nil) {
+      NSData *cacheData = [NSData dataWithContentsOfFile:cachePath options:NSDataReadingMappedAlways error:NULL];
+      cache = [[_FBTweakRegistryCache alloc] initWithData:cacheData UUID:uuid entryCount:count];
+    }
+
+    if (cache != nil) {
+      _FBTweakInlineAddCachedEntries(store, data, count, cache, tweaks);
+    } else if (cachePath != nil) {
+      _FBTweakInlineWriteRegistryCache(_FBTweakInlineAddEntries(store, data, count, uuid, tweaks), cachePath);
+    } else {
+      static const uint8_t noUUID[16] = { 0 };
+      _FBTweakInlineAddEntries(store, data, count, noUUID, tweaks);
+    }
+
+    if (tweaks.count > 0) {
+      [_FBTweakImageTweaks() setObject:tweaks forKey:(__bridge id)(void *)mach_header];
+    }
+  }
+}
+
+// The section is still mapped while dyld calls out, so stop tweaks
+// declared elsewhere from writing into this image's C handles.
+static void _FBTweakInlineDetachCHandles(const struct mach_header *mach_header)
+{
+  size_t count;
+  fb_tweak_entry *data = _FBTweakImageEntries(mach_header, &count);
+
+  @autoreleasepool {
+    FBTweakStore *store = [FBTweakStore sharedInstance];
+
     for (size_t i = 0; i < count; i++) {
       fb_tweak_entry *entry = &data[i];
-      FBTweakCategory *category = [store tweakCategoryWithName:*entry->category];
-      if (category == nil) {
-        category = [[FBTweakCategory alloc] initWithName:*entry->category];
-        [store addTweakCategory:category];
+      if (!_FBTweakEntryIsC(entry)) {
+        continue;
       }
-    
-      FBTweakCollection *collection = [category tweakCollectionWithName:*entry->collection];
-      if (collection == nil) {
-        collection = [[FBTweakCollection alloc] initWithName:*entry->collection];
-        [category addTweakCollection:collection];
-      }
-    
-      NSString *identifier = _FBTweakIdentifier(entry);
-      if ([collection tweakWithIdentifier:identifier] == nil) {
-        FBTweak *tweak = _FBTweakCreateWithEntry(identifier, entry);
 
-        if (tweak != nil) {
-          [collection addTweak:tweak];
+      FBTweakCategory *category = [store tweakCategoryWithName:_FBTweakEntryString(entry, entry->category)];
+      FBTweakCollection *collection = [category tweakCollectionWithName:_FBTweakEntryString(entry, entry->collection)];
+      [[collection tweakWithIdentifier:_FBTweakIdentifier(entry)] _detachCHandle:(fb_tweak_c_handle_header *)entry->value];
+    }
+  }
+}
+
+static void _FBTweakInlineUnregisterImage(const struct mach_header *mach_header)
+{
+  size_t count;
+  fb_tweak_entry *data = _FBTweakImageEntries(mach_header, &count);
+
+  _FBTweakInlineDetachCHandles(mach_header);
+
+  NSArray *tweaks = [_FBTweakImageTweaks() objectForKey:(__bridge id)(void *)mach_header];
+  [_FBTweakImageTweaks() removeObjectForKey:(__bridge id)(void *)mach_header];
+
+  // Only the tweaks this image registered are removed: those created from
+  // its entries, and those created for its C handles.
+  @autoreleasepool {
+    FBTweakStore *store = [FBTweakStore sharedInstance];
+
+    for (FBTweakCategory *category in store.tweakCategories) {
+      for (FBTweakCollection *collection in category.tweakCollections) {
+        [collection _removeTweakEntries:data size:count * sizeof(fb_tweak_entry)];
+
+        for (FBTweak *tweak in tweaks) {
+          if ([collection tweakWithIdentifier:tweak.identifier] == tweak) {
+            [collection removeTweak:tweak];
+          }
         }
+
+        if ([collection _tweakCount] == 0) {
+          [category removeTweakCollection:collection];
+        }
+      }
+
+      if (category.tweakCollections.count == 0) {
+        [store removeTweakCategory:category];
       }
     }
   }
 }
 
+static void _FBTweakInlinePostDidRegister(void)
+{
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+  [store _forgetRegisteredOrphanedValues];
+  [[NSNotificationCenter defaultCenter] postNotificationName:_FBTweakStoreDidRegisterTweaksNotification object:store];
+}
+
+// dyld holds its loader lock while calling out, so these never wait for
+// another thread. Images loaded on the main thread, including those at
+// launch, are registered before dlopen returns; others are registered
+// asynchronously on the main queue.
+static void _FBTweakInlineAddImage(const struct mach_header *mach_header, intptr_t vmaddr_slide)
+{
+  size_t count;
+  _FBTweakImageEntries(mach_header, &count);
+  if (count == 0) {
+    return;
+  }
+
+  // Found now, since it asks dyld for the image's path.
+  uint8_t uuid[16];
+  NSString *cachePath = _FBTweakImageRegistryCachePath(mach_header, uuid);
+
+  if ([NSThread isMainThread]) {
+    pthread_mutex_lock(&_FBTweakInlineRegistryLock);
+    _FBTweakInlineRegisterImage(mach_header, cachePath, uuid);
+    pthread_mutex_unlock(&_FBTweakInlineRegistryLock);
+
+    // Observers run later, outside dyld.
+    dispatch_async(dispatch_get_main_queue(), ^{
+      _FBTweakInlinePostDidRegister();
+    });
+    return;
+  }
+
+  pthread_mutex_lock(&_FBTweakInlineRegistryLock);
+  [_FBTweakImagesPending() addObject:(__bridge id)(void *)mach_header];
+  pthread_mutex_unlock(&_FBTweakInlineRegistryLock);
+
+  NSData *uuidData = [NSData dataWithBytes:uuid length:sizeof(uuid)];
+  dispatch_async(dispatch_get_main_queue(), ^{
+    pthread_mutex_lock(&_FBTweakInlineRegistryLock);
+    // Skipped if the image was unloaded before the main queue got to it.
+    BOOL pending = [_FBTweakImagesPending() containsObject:(__bridge id)(void *)mach_header];
+    if (pending) {
+      [_FBTweakImagesPending() removeObject:(__bridge id)(void *)mach_header];
+      _FBTweakInlineRegisterImage(mach_header, cachePath, uuidData.bytes);
+    }
+    pthread_mutex_unlock(&_FBTweakInlineRegistryLock);
+
+    if (pending) {
+      _FBTweakInlinePostDidRegister();
+    }
+  });
+}
+
+// Removed on the unloading thread, before dyld unmaps the image. The
+// store, its categories and collections are locked for this.
+static void _FBTweakInlineRemoveImage(const struct mach_header *mach_header, intptr_t vmaddr_slide)
+{
+  size_t count;
+  _FBTweakImageEntries(mach_header, &count);
+  if (count == 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&_FBTweakInlineRegistryLock);
+  if ([_FBTweakImagesPending() containsObject:(__bridge id)(void *)mach_header]) {
+    [_FBTweakImagesPending() removeObject:(__bridge id)(void *)mach_header];
+  } else {
+    _FBTweakInlineUnregisterImage(mach_header);
+  }
+  pthread_mutex_unlock(&_FBTweakInlineRegistryLock);
+}
+
+FBTweak *_FBTweakInlineCreateTweak(const void *entry)
+{
+  fb_tweak_entry *typedEntry = (fb_tweak_entry *)entry;
+  return _FBTweakCreateWithEntry(_FBTweakIdentifier(typedEntry), typedEntry);
+}
+
+FBTweak *_FBTweakInlineTweak(fb_tweak_entry *entry)
+{
+  // Looked up by hash, so the call site doesn't format an identifier.
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+  FBTweakCategory *category = [store tweakCategoryWithName:entry->category];
+  FBTweakCollection *collection = [category tweakCollectionWithName:entry->collection];
+  return [collection _tweakWithIdentifierHash:_FBTweakEntryIdentifierHash(entry)];
+}
+
+@interface _FBTweakInlineLoader : NSObject
 @end
 
+@implementation _FBTweakInlineLoader
+
++ (void)load
+{
+  static uint32_t _tweaksLoaded = 0;
+  if (OSAtomicTestAndSetBarrier(1, &_tweaksLoaded)) {
+    return;
+  }
+
+  // Called once for every image already loaded, then again for each image
+  // loaded later (e.g. with dlopen), so each section is only scanned once.
+  _dyld_register_func_for_add_image(_FBTweakInlineAddImage);
+  _dyld_register_func_for_remove_image(_FBTweakInlineRemoveImage);
+
+  // By the time the main queue runs, images loaded at launch are registered.
+  dispatch_async(dispatch_get_main_queue(), ^{
+    [[FBTweakStore sharedInstance] compactPersistedValuesWithRetentionInterval:_FBTweakInlinePersistedValueRetentionInterval dryRun:NO];
+  });
+}
+
+@end
+
+#else
+
+FBTweak *_FBTweakInlineCreateTweak(const void *entry)
+{
+  return nil;
+}
+
 #endif
@@ -13,6 +13,40 @@
 #import "FBTweakCategory.h"
 #import "FBTweakCollection.h"
 #import "_FBTweakBindObserver.h"
+#import "_FBTweakFrozen.h"
+#import "_FBTweakVariable.h"
+#import "_FBTweakRelease.h"
+#import "FBTweakC.h"
+
+/* the type _FBTweakValueInternal returns for a default. */
+#define _FBTweakValueType(default_) \
+__typeof__(_Generic(default_, \
+  float: (float)0, \
+  const float: (float)0, \
+  double: (double)0, \
+  const double: (double)0, \
+  short: (short)0, \
+  const short: (short)0, \
+  unsigned short: (unsigned short)0, \
+  const unsigned short: (unsigned short)0, \
+  int: (int)0, \
+  const int: (int)0, \
+  unsigned int: (unsigned int)0, \
+  const unsigned int: (unsigned int)0, \
+  long: (long)0, \
+  const long: (long)0, \
+  unsigned long: (unsigned long)0, \
+  const unsigned long: (unsigned long)0, \
+  long long: (long long)0, \
+  const long long: (long long)0, \
+  unsigned long long: (unsigned long long)0, \
+  const unsigned long long: (unsigned long long)0, \
+  BOOL: (BOOL)0, \
+  const BOOL: (BOOL)0, \
+  id: (id)nil, \
+  const id: (id)nil, \
+  default: (const char *)NULL \
+))
 
 #if !FB_TWEAK_ENABLED
 
@@ -20,7 +54,19 @@
 #define _FBTweakInline(category_, collection_, name_, ...) nil
 #define _FBTweakValue(category_, collection_, name_, ...) (__FBTweakDefault(__VA_ARGS__, _))
 #define _FBTweakBind(object_, property_, category_, collection_, name_, ...) (object_.property_ = __FBTweakDefault(__VA_ARGS__, _))
+#define _FBTweakBindVariable(variable_, category_, collection_, name_, ...) (*(variable_) = __FBTweakDefault(__VA_ARGS__, _))
 #define _FBTweakAction(category_, collection_, name_, ...)
+#define _FBTweakActionWithPolicy(category_, collection_, name_, policy_, ...)
+#define _FBTweakReleaseValue(category_, collection_, name_, ...) _FBTweakReleaseValueInternal(category_, collection_, name_, __FBTweakDefault(__VA_ARGS__, _))
+
+/* the site's entry starts out pointing at its default, and is resolved at launch. */
+#define _FBTweakReleaseValueInternal(category_, collection_, name_, default_) \
+((^{ \
+  static const _FBTweakValueType(default_) default__ = default_; \
+  _FBTweakReleaseEntryAttributes static fb_tweak_release_entry entry__ = \
+    { category_, collection_, name_, @encode(_FBTweakValueType(default_)), (const void *)&default__, (const void *)&default__ }; \
+  return *(const _FBTweakValueType(default_) *)entry__.value; \
+})())
 
 #else
 
@@ -28,27 +74,35 @@
 extern "C" {
 #endif
 
-#define FBTweakSegmentName "__DATA"
-#define FBTweakSectionName "FBTweak"
-
 #define FBTweakEncodingAction "__ACTION__"
 
 typedef __unsafe_unretained NSString *FBTweakLiteralString;
   
+/*
+  entries hold their data directly, so a call site adds only its entry
+  and its default to the binary. value is the default as a constant of
+  the encoded type or, with encoding "@", a block that returns it.
+  possible is NULL, a block that returns the possible values or, for
+  ranges, the same as value, which then also holds the minimum and maximum.
+  actions keep their block in value and their policy in possible.
+ */
 typedef struct {
-  FBTweakLiteralString *category;
-  FBTweakLiteralString *collection;
-  FBTweakLiteralString *name;
-  void *value;
-  void *possible;
-  char **encoding;
+  FBTweakLiteralString category;
+  FBTweakLiteralString collection;
+  FBTweakLiteralString name;
+  const void *value;
+  const void *possible;
+  const char *encoding;
 } fb_tweak_entry;
 
-// cast to a pointer to a block, dereferenece said pointer, call said block
-#define fb_tweak_entry_block_field(type, entry, field) (*(type (^__unsafe_unretained (*))(void))(entry->field))()
-
 extern NSString *_FBTweakIdentifier(fb_tweak_entry *entry);
 
+/* finds the tweak registered for an entry, without allocating. */
+extern FBTweak *_FBTweakInlineTweak(fb_tweak_entry *entry);
+
+/* boxes a value of an @encode type, for defaults that aren't constants. */
+extern FBTweakValue _FBTweakInlineBoxValue(const char *encoding, const void *value);
+
 #if __has_feature(objc_arc)
 #define _FBTweakRelease(x)
 #else
@@ -66,41 +120,56 @@ extern NSString *_FBTweakIdentifier(fb_tweak_entry *entry);
 #define __FBTweakDispatch3(__withoutRange, __withRange, __withPossible, ...) __withRange
 #define _FBTweakDispatch(__withoutRange, __withRange, __withPossible, ...) __FBTweakConcat(__FBTweakDispatch, __FBTweakIndexCount(__VA_ARGS__))(__withoutRange, __withRange, __withPossible)
   
+/* defaults that aren't compile-time constants, like objects, are made by a block instead.
+   ranges are stored as constants only when the default and both bounds are constants. */
+#define _FBTweakEntryIsConstant(default_) _Generic(default_, id: 0, const id: 0, default: __builtin_constant_p(default_))
+#define _FBTweakEntryRangeIsConstant(default_, min_, max_) (_FBTweakEntryIsConstant(default_) && __builtin_constant_p(min_) && __builtin_constant_p(max_))
+#define _FBTweakEntryConstant(default_) __builtin_choose_expr(_FBTweakEntryIsConstant(default_), (default_), 0)
+#define _FBTweakEntryRangeConstant(constant_, default_, value_) \
+  __builtin_choose_expr(constant_, (_FBTweakValueType(default_))(value_), (_FBTweakValueType(default_))0)
+#define _FBTweakEntryDefault(constant_, default_, values_) __builtin_choose_expr(constant_, \
+  (const void *)(values_), \
+  (__bridge const void *)^id{ \
+    const _FBTweakValueType(default_) value__ = default_; \
+    return _FBTweakInlineBoxValue(@encode(_FBTweakValueType(default_)), (const void *)&value__); \
+  })
+#define _FBTweakEntryEncoding(constant_, default_) __builtin_choose_expr(constant_, \
+  @encode(_FBTweakValueType(default_)), \
+  @encode(id))
+
 #define _FBTweakInlineWithoutRange(category_, collection_, name_, default_) \
 ((^{ \
-  return _FBTweakInlineWithPossibleInternal(category_, collection_, name_, default_, NULL); \
+  /* store the tweak data in the binary at compile time. */ \
+  static const _FBTweakValueType(default_) values__[] = { _FBTweakEntryConstant(default_) }; \
+  _FBTweakEntryAttributes static fb_tweak_entry entry__ = \
+    { category_, collection_, name_, _FBTweakEntryDefault(_FBTweakEntryIsConstant(default_), default_, values__), NULL, _FBTweakEntryEncoding(_FBTweakEntryIsConstant(default_), default_) }; \
+  return _FBTweakInlineTweak(&entry__); \
 })())
 #define _FBTweakInlineWithRange(category_, collection_, name_, default_, min_, max_) \
 ((^{ \
-  __attribute__((used)) static __typeof__(default_) min__ = (__typeof__(default_))min_; \
-  __attribute__((used)) static __typeof__(default_) max__ = (__typeof__(default_))max_; \
-  return _FBTweakInlineWithPossibleInternal(category_, collection_, name_, default_, [[FBTweakNumericRange alloc] initWithMinimumValue:@(min__) maximumValue:@(max__)]); \
+  /* the range follows the default, or is made by a block if any value isn't a constant. */ \
+  static const _FBTweakValueType(default_) values__[] = { \
+    _FBTweakEntryRangeConstant(_FBTweakEntryRangeIsConstant(default_, min_, max_), default_, default_), \
+    _FBTweakEntryRangeConstant(_FBTweakEntryRangeIsConstant(default_, min_, max_), default_, min_), \
+    _FBTweakEntryRangeConstant(_FBTweakEntryRangeIsConstant(default_, min_, max_), default_, max_), \
+  }; \
+  _FBTweakEntryAttributes static fb_tweak_entry entry__ = { \
+    category_, collection_, name_, \
+    _FBTweakEntryDefault(_FBTweakEntryRangeIsConstant(default_, min_, max_), default_, values__), \
+    __builtin_choose_expr(_FBTweakEntryRangeIsConstant(default_, min_, max_), (const void *)values__, \
+      (__bridge const void *)^{ \
+        return [[FBTweakNumericRange alloc] initWithMinimumValue:@((_FBTweakValueType(default_))(min_)) maximumValue:@((_FBTweakValueType(default_))(max_))]; \
+      }), \
+    _FBTweakEntryEncoding(_FBTweakEntryRangeIsConstant(default_, min_, max_), default_), \
+  }; \
+  return _FBTweakInlineTweak(&entry__); \
 })())
 #define _FBTweakInlineWithPossible(category_, collection_, name_, default_, possible_) \
 ((^{ \
-  return _FBTweakInlineWithPossibleInternal(category_, collection_, name_, default_, possible_); \
-})())
-#define _FBTweakInlineWithPossibleInternal(category_, collection_, name_, default_, possible_) \
-((^{ \
-  /* store the tweak data in the binary at compile time. */ \
-  __attribute__((used)) static FBTweakLiteralString category__ = category_; \
-  __attribute__((used)) static FBTweakLiteralString collection__ = collection_; \
-  __attribute__((used)) static FBTweakLiteralString name__ = name_; \
-  __attribute__((used)) static void *default__ = (__bridge void *) ^{ return default_; }; \
-  __attribute__((used)) static void *possible__ = (__bridge void *)  ^{ return possible_; }; \
-  __attribute__((used)) static char *encoding__ = (char *)@encode(__typeof__(default_)); \
-  __attribute__((used)) __attribute__((section (FBTweakSegmentName "," FBTweakSectionName))) static fb_tweak_entry entry = \
-    { &category__, &collection__, &name__, (void *)&default__, (void *)&possible__, &encoding__ }; \
-\
-  /* find the registered tweak with the given identifier. */ \
-  FBTweakStore *store = [FBTweakStore sharedInstance]; \
-  FBTweakCategory *category = [store tweakCategoryWithName:category__]; \
-  FBTweakCollection *collection = [category tweakCollectionWithName:collection__]; \
-\
-  NSString *identifier = _FBTweakIdentifier(&entry); \
-  FBTweak *__inline_tweak = [collection tweakWithIdentifier:identifier]; \
-\
-  return __inline_tweak; \
+  static const _FBTweakValueType(default_) values__[] = { _FBTweakEntryConstant(default_) }; \
+  _FBTweakEntryAttributes static fb_tweak_entry entry__ = \
+    { category_, collection_, name_, _FBTweakEntryDefault(_FBTweakEntryIsConstant(default_), default_, values__), (__bridge const void *)^{ return possible_; }, _FBTweakEntryEncoding(_FBTweakEntryIsConstant(default_), default_) }; \
+  return _FBTweakInlineTweak(&entry__); \
 })())
 #define _FBTweakInline(category_, collection_, name_, ...) _FBTweakDispatch(_FBTweakInlineWithoutRange, _FBTweakInlineWithRange, _FBTweakInlineWithPossible, __VA_ARGS__)(category_, collection_, name_, __VA_ARGS__)
   
@@ -141,22 +210,33 @@ extern NSString *_FBTweakIdentifier(fb_tweak_entry *entry);
   ); \
 })())
 
+/* returns the default from the enclosing block when tweaks are frozen. */
+#define _FBTweakValueReturnIfFrozen(default_) \
+  if (_FBTweakIsFrozen()) { \
+    _FBTweakValueType(default_) __frozen_value = default_; \
+    return __frozen_value; \
+  }
+
 #define _FBTweakValueWithoutRange(category_, collection_, name_, default_) \
 ((^{ \
+    _FBTweakValueReturnIfFrozen(default_) \
     FBTweak *__value_tweak = _FBTweakInlineWithoutRange(category_, collection_, name_, default_); \
     return _FBTweakValueInternal(__value_tweak, category_, collection_, name_, default_); \
 })())
 #define _FBTweakValueWithRange(category_, collection_, name_, default_, min_, max_) \
 ((^{ \
+  _FBTweakValueReturnIfFrozen(default_) \
   FBTweak *__value_tweak = _FBTweakInlineWithRange(category_, collection_, name_, default_, min_, max_); \
   return _FBTweakValueInternal(__value_tweak, category_, collection_, name_, default_); \
 })())
 #define _FBTweakValueWithPossible(category_, collection_, name_, default_, possible_) \
 ((^{ \
+  _FBTweakValueReturnIfFrozen(default_) \
   FBTweak *__value_tweak = _FBTweakInlineWithPossible(category_, collection_, name_, default_, possible_); \
   return _FBTweakValueInternal(__value_tweak, category_, collection_, name_, default_); \
 })())
 #define _FBTweakValue(category_, collection_, name_, ...) _FBTweakDispatch(_FBTweakValueWithoutRange, _FBTweakValueWithRange, _FBTweakValueWithPossible, __VA_ARGS__)(category_, collection_, name_, __VA_ARGS__)
+#define _FBTweakReleaseValue(category_, collection_, name_, ...) _FBTweakValue(category_, collection_, name_, __VA_ARGS__)
 
 #define _FBTweakBindWithoutRange(object_, property_, category_, collection_, name_, default_) \
 ((^{ \
@@ -173,33 +253,54 @@ extern NSString *_FBTweakIdentifier(fb_tweak_entry *entry);
   FBTweak *__bind_tweak = _FBTweakInlineWithPossible(category_, collection_, name_, default_, possible_); \
   _FBTweakBindInternal(object_, property_, category_, collection_, name_, default_, __bind_tweak); \
 })())
+#define _FBTweakBindValue(tweak_, category_, collection_, name_, default_) \
+((^{ \
+  _FBTweakValueReturnIfFrozen(default_) \
+  return _FBTweakValueInternal(tweak_, category_, collection_, name_, default_); \
+})())
 #define _FBTweakBindInternal(object_, property_, category_, collection_, name_, default_, tweak_) \
 ((^{ \
-  object_.property_ = _FBTweakValueInternal(tweak_, category_, collection_, name_, default_); \
-  _FBTweakBindObserver *observer__ = [[_FBTweakBindObserver alloc] initWithTweak:tweak_ block:^(id object__) { \
+  object_.property_ = _FBTweakBindValue(tweak_, category_, collection_, name_, default_); \
+  _FBTweakBindObserver *observer__ = [[_FBTweakBindObserver alloc] initWithTweak:tweak_ file:__FILE__ line:__LINE__ block:^(id object__) { \
     __typeof__(object_) object___ = object__; \
-    object___.property_ = _FBTweakValueInternal(tweak_, category_, collection_, name_, default_); \
+    object___.property_ = _FBTweakBindValue(tweak_, category_, collection_, name_, default_); \
   }]; \
   [observer__ attachToObject:object_]; \
 })())
 #define _FBTweakBind(object_, property_, category_, collection_, name_, ...) _FBTweakDispatch(_FBTweakBindWithoutRange, _FBTweakBindWithRange, _FBTweakBindWithPossible, __VA_ARGS__)(object_, property_, category_, collection_, name_, __VA_ARGS__)
 
+/* the default is cast to the variable's type, so the tweak is registered with its encoding. */
+#define _FBTweakBindVariableWithoutRange(variable_, category_, collection_, name_, default_) \
+((^{ \
+  FBTweak *__bind_tweak = _FBTweakInlineWithoutRange(category_, collection_, name_, (__typeof__(*(variable_)))(default_)); \
+  [__bind_tweak _bindVariable:(void *)(variable_) encoding:@encode(__typeof__(*(variable_)))]; \
+})())
+#define _FBTweakBindVariableWithRange(variable_, category_, collection_, name_, default_, min_, max_) \
+((^{ \
+  FBTweak *__bind_tweak = _FBTweakInlineWithRange(category_, collection_, name_, (__typeof__(*(variable_)))(default_), min_, max_); \
+  [__bind_tweak _bindVariable:(void *)(variable_) encoding:@encode(__typeof__(*(variable_)))]; \
+})())
+#define _FBTweakBindVariableWithPossible(variable_, category_, collection_, name_, default_, possible_) \
+((^{ \
+  FBTweak *__bind_tweak = _FBTweakInlineWithPossible(category_, collection_, name_, (__typeof__(*(variable_)))(default_), possible_); \
+  [__bind_tweak _bindVariable:(void *)(variable_) encoding:@encode(__typeof__(*(variable_)))]; \
+})())
+#define _FBTweakBindVariable(variable_, category_, collection_, name_, ...) _FBTweakDispatch(_FBTweakBindVariableWithoutRange, _FBTweakBindVariableWithRange, _FBTweakBindVariableWithPossible, __VA_ARGS__)(variable_, category_, collection_, name_, __VA_ARGS__)
+
 #define _FBTweakAction(category_, collection_, name_, ...) \
-  _FBTweakActionInternal(category_, collection_, name_, __COUNTER__, __VA_ARGS__)
-#define _FBTweakActionInternal(category_, collection_, name_, suffix_, ...) \
-  /* store the tweak data in the binary at compile time. */ \
-  __attribute__((used)) static FBTweakLiteralString __FBTweakConcat(__fb_tweak_action_category_, suffix_) = category_; \
-  __attribute__((used)) static FBTweakLiteralString __FBTweakConcat(__fb_tweak_action_collection_, suffix_) = collection_; \
-  __attribute__((used)) static FBTweakLiteralString __FBTweakConcat(__fb_tweak_action_name_, suffix_) = name_; \
-  __attribute__((used)) static dispatch_block_t __FBTweakConcat(__fb_tweak_action_block_, suffix_) = __VA_ARGS__; \
-  __attribute__((used)) static char *__FBTweakConcat(__fb_tweak_action_encoding_, suffix_) = (char *)FBTweakEncodingAction; \
-  __attribute__((used)) __attribute__((section (FBTweakSegmentName "," FBTweakSectionName))) static fb_tweak_entry __FBTweakConcat(__fb_tweak_action_entry_, suffix_) = { \
-    &__FBTweakConcat(__fb_tweak_action_category_, suffix_), \
-    &__FBTweakConcat(__fb_tweak_action_collection_, suffix_), \
-    &__FBTweakConcat(__fb_tweak_action_name_, suffix_), \
-    &__FBTweakConcat(__fb_tweak_action_block_, suffix_), \
-    NULL, \
-    &__FBTweakConcat(__fb_tweak_action_encoding_, suffix_), \
+  _FBTweakActionInternal(category_, collection_, name_, FBTweakActionPolicyMainThread, __COUNTER__, __VA_ARGS__)
+#define _FBTweakActionWithPolicy(category_, collection_, name_, policy_, ...) \
+  _FBTweakActionInternal(category_, collection_, name_, policy_, __COUNTER__, __VA_ARGS__)
+#define _FBTweakActionInternal(category_, collection_, name_, policy_, suffix_, ...) \
+  /* store the tweak data in the binary at compile time; possible points to the policy. */ \
+  static const FBTweakActionPolicy __FBTweakConcat(__fb_tweak_action_policy_, suffix_) = policy_; \
+  _FBTweakEntryAttributes static fb_tweak_entry __FBTweakConcat(__fb_tweak_action_entry_, suffix_) = { \
+    category_, \
+    collection_, \
+    name_, \
+    (__bridge const void *)(dispatch_block_t)(__VA_ARGS__), \
+    &__FBTweakConcat(__fb_tweak_action_policy_, suffix_), \
+    FBTweakEncodingAction, \
   }; \
 
 #ifdef __cplusplus
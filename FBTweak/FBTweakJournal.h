@@ -0,0 +1,130 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+@class FBTweakStore;
+
+/**
+  @abstract One recorded change to a tweak's value.
+ */
+@interface FBTweakJournalEntry : NSObject
+
+/**
+  @abstract The position of the change in the journal, starting at zero.
+ */
+@property (nonatomic, assign, readonly) uint64_t sequence;
+
+/**
+  @abstract When the change happened, in seconds since the device booted.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval timestamp;
+
+/**
+  @abstract The identifier of the tweak that changed.
+ */
+@property (nonatomic, copy, readonly) NSString *identifier;
+
+/**
+  @abstract The value before the change. Nil if the tweak was unset.
+ */
+@property (nonatomic, strong, readonly) FBTweakValue oldValue;
+
+/**
+  @abstract The value after the change. Nil if the tweak was reset.
+ */
+@property (nonatomic, strong, readonly) FBTweakValue newValue;
+
+/**
+  @abstract If a value couldn't be recorded in full.
+  @discussion Set for strings too long to record, and for values of
+    other types than numbers, strings and colors, which are recorded as
+    nil. Truncated entries are skipped when replaying.
+ */
+@property (nonatomic, assign, readonly, getter = isTruncated) BOOL truncated;
+
+/**
+  @abstract The system identifier of the thread that made the change.
+ */
+@property (nonatomic, assign, readonly) uint64_t threadIdentifier;
+
+@end
+
+/**
+  @abstract Records every tweak value change in a fixed-size ring.
+  @discussion Recording doesn't lock or allocate: each change claims a
+    slot with an atomic increment and is encoded in place, overwriting
+    the oldest entry once the ring is full. Numbers, colors and strings
+    up to 22 UTF-8 bytes are recorded exactly.
+ */
+@interface FBTweakJournal : NSObject
+
+/**
+  @abstract Creates a journal.
+  @discussion This is the designated initializer.
+  @param capacity The number of entries to keep. Rounded up to a power of two.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/**
+  @abstract The number of entries the journal keeps.
+ */
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+  @abstract The journal recording changes, if any.
+  @discussion Only one journal records at a time. When nil, recording
+    costs a single load and branch per change.
+ */
++ (FBTweakJournal *)activeJournal;
+
+/**
+  @abstract Starts recording changes to this journal.
+  @discussion A journal that has been active is never deallocated, since
+    changes on other threads may still be recording to it.
+  @param activeJournal The journal to record to, or nil to stop recording.
+ */
++ (void)setActiveJournal:(FBTweakJournal *)activeJournal;
+
+/**
+  @abstract The recorded entries, oldest first.
+  @discussion Safe to call while changes are being recorded on other
+    threads; entries being written at that moment are left out.
+ */
+- (NSArray *)snapshot;
+
+/**
+  @abstract Removes all entries.
+ */
+- (void)clear;
+
+/**
+  @abstract Serializes entries to a compact binary form.
+  @param entries The entries to export, usually from {@ref snapshot}.
+ */
++ (NSData *)dataWithEntries:(NSArray *)entries;
+
+/**
+  @abstract Reads entries serialized with {@ref dataWithEntries:}.
+  @return The entries, or nil if the data is malformed.
+ */
++ (NSArray *)entriesWithData:(NSData *)data;
+
+/**
+  @abstract Reapplies recorded changes to a store, in order.
+  @param entries The entries to replay.
+  @param store The store containing the tweaks to change.
+  @return The number of entries applied. Entries for unknown tweaks
+    and truncated entries are skipped.
+ */
++ (NSUInteger)replayEntries:(NSArray *)entries inStore:(FBTweakStore *)store;
+
+@end
@@ -0,0 +1,318 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakJournal.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "_FBTweakJournal.h"
+#import "_FBTweakBinaryCoding.h"
+
+#import <libkern/OSAtomic.h>
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+#define _FBTweakJournalPayloadSize 22
+
+static const uint32_t _FBTweakJournalDataMagic = 'FBTJ';
+
+typedef struct {
+  uint8_t type;
+  uint8_t length;
+  uint8_t payload[_FBTweakJournalPayloadSize];
+} _FBTweakJournalValue;
+
+// Zero while unused or being written, otherwise one more than the
+// journal position the slot holds.
+typedef struct {
+  volatile int64_t sequence;
+  uint64_t timestamp;
+  uint64_t thread;
+  uint32_t identifierIndex;
+  uint32_t truncated;
+  _FBTweakJournalValue oldValue;
+  _FBTweakJournalValue newValue;
+} _FBTweakJournalSlot;
+
+FBTweakJournal *__unsafe_unretained volatile _FBTweakJournalActive = nil;
+
+#pragma mark Identifiers
+
+// Interned identifiers, shared by all journals. Index zero is unused.
+// Tweaks recreated for the same identifier get the same index.
+static pthread_mutex_t _FBTweakJournalIdentifiersLock = PTHREAD_MUTEX_INITIALIZER;
+static NSMutableArray *_FBTweakJournalIdentifiers = nil;
+static NSMutableDictionary *_FBTweakJournalIdentifierIndexes = nil;
+
+static uint32_t _FBTweakJournalInternIdentifier(NSString *identifier)
+{
+  pthread_mutex_lock(&_FBTweakJournalIdentifiersLock);
+  if (_FBTweakJournalIdentifiers == nil) {
+    _FBTweakJournalIdentifiers = [[NSMutableArray alloc] initWithObjects:[NSNull null], nil];
+    _FBTweakJournalIdentifierIndexes = [[NSMutableDictionary alloc] init];
+  }
+  NSNumber *index = _FBTweakJournalIdentifierIndexes[identifier];
+  if (index == nil) {
+    index = @(_FBTweakJournalIdentifiers.count);
+    identifier = [identifier copy];
+    [_FBTweakJournalIdentifiers addObject:identifier];
+    _FBTweakJournalIdentifierIndexes[identifier] = index;
+  }
+  pthread_mutex_unlock(&_FBTweakJournalIdentifiersLock);
+  return (uint32_t)[index unsignedIntValue];
+}
+
+static NSString *_FBTweakJournalIdentifierAtIndex(uint32_t index)
+{
+  pthread_mutex_lock(&_FBTweakJournalIdentifiersLock);
+  NSString *identifier = (index > 0 && index < _FBTweakJournalIdentifiers.count ? _FBTweakJournalIdentifiers[index] : nil);
+  pthread_mutex_unlock(&_FBTweakJournalIdentifiersLock);
+  return identifier;
+}
+
+#pragma mark Entries
+
+@implementation FBTweakJournalEntry
+
+- (instancetype)initWithSequence:(uint64_t)sequence timestamp:(NSTimeInterval)timestamp identifier:(NSString *)identifier oldValue:(FBTweakValue)oldValue newValue:(FBTweakValue)newValue truncated:(BOOL)truncated threadIdentifier:(uint64_t)threadIdentifier
+{
+  if ((self = [super init])) {
+    _sequence = sequence;
+    _timestamp = timestamp;
+    _identifier = [identifier copy];
+    _oldValue = oldValue;
+    _newValue = newValue;
+    _truncated = truncated;
+    _threadIdentifier = threadIdentifier;
+  }
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %p; sequence = %llu; timestamp = %f; identifier = %@; oldValue = %@; newValue = %@; thread = %llu>", [self class], self, _sequence, _timestamp, _identifier, _oldValue, _newValue, _threadIdentifier];
+}
+
+@end
+
+#pragma mark Journal
+
+@implementation FBTweakJournal {
+  _FBTweakJournalSlot *_slots;
+  uint64_t _mask;
+  volatile int64_t _nextSequence;
+}
+
+// Every journal that has been active. Recording loads the active journal
+// without retaining it, so one replaced mid-change must stay valid.
+static NSMutableSet *_FBTweakJournalActivated = nil;
+
++ (FBTweakJournal *)activeJournal
+{
+  return _FBTweakJournalActive;
+}
+
++ (void)setActiveJournal:(FBTweakJournal *)activeJournal
+{
+  @synchronized (self) {
+    if (activeJournal != nil) {
+      if (_FBTweakJournalActivated == nil) {
+        _FBTweakJournalActivated = [[NSMutableSet alloc] init];
+      }
+      [_FBTweakJournalActivated addObject:activeJournal];
+    }
+    _FBTweakJournalActive = activeJournal;
+    OSMemoryBarrier();
+  }
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+  NSParameterAssert(capacity > 0);
+
+  if ((self = [super init])) {
+    _capacity = 1;
+    while (_capacity < capacity) {
+      _capacity <<= 1;
+    }
+    _mask = _capacity - 1;
+    _slots = calloc(_capacity, sizeof(_FBTweakJournalSlot));
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_slots);
+}
+
+static void _FBTweakJournalEncodeValue(FBTweakValue value, _FBTweakJournalValue *encoded, uint32_t *truncated)
+{
+  _FBTweakBinaryValueType type;
+  size_t length;
+  // Unsupported values are encoded as nil, so they're flagged too, or
+  // replaying would reset the tweak.
+  if (!_FBTweakBinaryEncodeFixedValue(value, &type, encoded->payload, sizeof(encoded->payload), &length)) {
+    *truncated = 1;
+  }
+  encoded->type = type;
+  encoded->length = (uint8_t)length;
+}
+
+void _FBTweakJournalRecord(FBTweakJournal *journal, FBTweak *tweak, uint32_t *identifierIndex, FBTweakValue oldValue, FBTweakValue newValue)
+{
+  if (*identifierIndex == 0) {
+    *identifierIndex = _FBTweakJournalInternIdentifier(tweak.identifier);
+  }
+
+  int64_t sequence = OSAtomicIncrement64Barrier(&journal->_nextSequence) - 1;
+  _FBTweakJournalSlot *slot = &journal->_slots[(uint64_t)sequence & journal->_mask];
+
+  // Mark the slot as being written so snapshots skip it.
+  slot->sequence = 0;
+  OSMemoryBarrier();
+
+  uint64_t thread = 0;
+  pthread_threadid_np(NULL, &thread);
+
+  slot->timestamp = mach_absolute_time();
+  slot->thread = thread;
+  slot->identifierIndex = *identifierIndex;
+  slot->truncated = 0;
+  _FBTweakJournalEncodeValue(oldValue, &slot->oldValue, &slot->truncated);
+  _FBTweakJournalEncodeValue(newValue, &slot->newValue, &slot->truncated);
+
+  OSMemoryBarrier();
+  slot->sequence = sequence + 1;
+}
+
+- (NSArray *)snapshot
+{
+  mach_timebase_info_data_t timebase;
+  mach_timebase_info(&timebase);
+
+  OSMemoryBarrier();
+  int64_t end = _nextSequence;
+  int64_t start = MAX(0, end - (int64_t)_capacity);
+
+  NSMutableArray *entries = [[NSMutableArray alloc] initWithCapacity:(NSUInteger)(end - start)];
+  for (int64_t sequence = start; sequence < end; sequence++) {
+    _FBTweakJournalSlot *slot = &_slots[(uint64_t)sequence & _mask];
+
+    int64_t before = slot->sequence;
+    OSMemoryBarrier();
+    _FBTweakJournalSlot copy = *slot;
+    OSMemoryBarrier();
+    if (before != sequence + 1 || slot->sequence != before) {
+      // Still being written, or already overwritten.
+      continue;
+    }
+
+    NSTimeInterval timestamp = (double)copy.timestamp * timebase.numer / timebase.denom / NSEC_PER_SEC;
+    FBTweakValue oldValue = _FBTweakBinaryDecodeFixedValue(copy.oldValue.type, copy.oldValue.payload, copy.oldValue.length);
+    FBTweakValue newValue = _FBTweakBinaryDecodeFixedValue(copy.newValue.type, copy.newValue.payload, copy.newValue.length);
+
+    FBTweakJournalEntry *entry = [[FBTweakJournalEntry alloc] initWithSequence:(uint64_t)sequence timestamp:timestamp identifier:_FBTweakJournalIdentifierAtIndex(copy.identifierIndex) oldValue:oldValue newValue:newValue truncated:(copy.truncated != 0) threadIdentifier:copy.thread];
+    [entries addObject:entry];
+  }
+
+  return entries;
+}
+
+- (void)clear
+{
+  // Slots are recognized by sequence, so skipping ahead a full ring
+  // leaves every existing slot stale.
+  OSAtomicAdd64Barrier((int64_t)_capacity, &_nextSequence);
+}
+
+#pragma mark Export
+
++ (NSData *)dataWithEntries:(NSArray *)entries
+{
+  NSMutableData *data = [[NSMutableData alloc] init];
+  _FBTweakBinaryAppendUInt32(data, _FBTweakJournalDataMagic);
+  _FBTweakBinaryAppendUInt32(data, (uint32_t)entries.count);
+
+  for (FBTweakJournalEntry *entry in entries) {
+    double timestamp = entry.timestamp;
+    uint64_t timestampBits;
+    memcpy(&timestampBits, &timestamp, sizeof(timestampBits));
+
+    _FBTweakBinaryAppendUInt64(data, entry.sequence);
+    _FBTweakBinaryAppendUInt64(data, timestampBits);
+    _FBTweakBinaryAppendUInt64(data, entry.threadIdentifier);
+    _FBTweakBinaryAppendUInt8(data, entry.isTruncated ? 1 : 0);
+    _FBTweakBinaryAppendString(data, entry.identifier);
+    _FBTweakBinaryAppendValue(data, entry.oldValue);
+    _FBTweakBinaryAppendValue(data, entry.newValue);
+  }
+
+  return data;
+}
+
++ (NSArray *)entriesWithData:(NSData *)data
+{
+  _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(data.bytes, data.length);
+  if (_FBTweakBinaryReadUInt32(&reader) != _FBTweakJournalDataMagic) {
+    return nil;
+  }
+
+  uint32_t count = _FBTweakBinaryReadUInt32(&reader);
+  NSMutableArray *entries = [[NSMutableArray alloc] init];
+  for (uint32_t i = 0; i < count && !reader.failed; i++) {
+    uint64_t sequence = _FBTweakBinaryReadUInt64(&reader);
+    uint64_t timestampBits = _FBTweakBinaryReadUInt64(&reader);
+    uint64_t thread = _FBTweakBinaryReadUInt64(&reader);
+    BOOL truncated = (_FBTweakBinaryReadUInt8(&reader) != 0);
+    NSString *identifier = _FBTweakBinaryReadString(&reader);
+    FBTweakValue oldValue = _FBTweakBinaryReadValue(&reader);
+    FBTweakValue newValue = _FBTweakBinaryReadValue(&reader);
+
+    double timestamp;
+    memcpy(&timestamp, &timestampBits, sizeof(timestamp));
+
+    if (!reader.failed) {
+      [entries addObject:[[FBTweakJournalEntry alloc] initWithSequence:sequence timestamp:timestamp identifier:identifier oldValue:oldValue newValue:newValue truncated:truncated threadIdentifier:thread]];
+    }
+  }
+
+  return (reader.failed ? nil : entries);
+}
+
+#pragma mark Replay
+
++ (NSUInteger)replayEntries:(NSArray *)entries inStore:(FBTweakStore *)store
+{
+  NSMutableDictionary *identifierTweaks = [[NSMutableDictionary alloc] init];
+  for (FBTweakCategory *category in store.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      for (FBTweak *tweak in collection.tweaks) {
+        identifierTweaks[tweak.identifier] = tweak;
+      }
+    }
+  }
+
+  NSUInteger applied = 0;
+  for (FBTweakJournalEntry *entry in entries) {
+    FBTweak *tweak = identifierTweaks[entry.identifier];
+    if (tweak == nil || tweak.isAction || entry.isTruncated) {
+      continue;
+    }
+
+    tweak.currentValue = entry.newValue;
+    applied++;
+  }
+
+  return applied;
+}
+
+@end
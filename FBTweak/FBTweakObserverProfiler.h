@@ -0,0 +1,86 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract What observers of one kind cost when tweaks change.
+  @discussion Returned by {@ref -[FBTweakObserverProfiler profiles]}.
+ */
+@interface FBTweakObserverProfile : NSObject
+
+/**
+  @abstract What the observers are.
+  @discussion The observer's class, or for {@ref FBTweakBind} the file
+    and line it was called from.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+  @abstract How many change notifications were delivered.
+  @discussion Counts both will and did change notifications.
+ */
+@property (nonatomic, assign, readonly) NSUInteger deliveries;
+
+/**
+  @abstract The time spent in all deliveries.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval totalDuration;
+
+/**
+  @abstract The time spent in the slowest delivery.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval maximumDuration;
+
+/**
+  @abstract How many deliveries took longer than the profiler's budget.
+ */
+@property (nonatomic, assign, readonly) NSUInteger slowDeliveries;
+
+@end
+
+/**
+  @abstract Times how long tweak observers take to handle changes.
+  @discussion Off by default. While off, changing a tweak costs one
+    extra branch; while on, each observer's delivery is timed and added
+    to the profile for its kind of observer.
+ */
+@interface FBTweakObserverProfiler : NSObject
+
+/**
+  @abstract Creates or returns the shared observer profiler.
+  @return The shared observer profiler.
+ */
++ (instancetype)sharedInstance;
+
+/**
+  @abstract If deliveries are timed.
+  @discussion Turning profiling off keeps the profiles recorded so far.
+ */
+@property (nonatomic, assign, getter = isEnabled) BOOL enabled;
+
+/**
+  @abstract How long one delivery may take before it's counted as slow.
+  @discussion Defaults to one millisecond. The first slow delivery for
+    each profile is logged.
+ */
+@property (nonatomic, assign) NSTimeInterval budget;
+
+/**
+  @abstract The profiles recorded, most expensive first.
+  @return An array of {@ref FBTweakObserverProfile}.
+ */
+- (NSArray *)profiles;
+
+/**
+  @abstract Discards the profiles recorded.
+ */
+- (void)reset;
+
+@end
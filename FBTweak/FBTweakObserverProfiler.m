@@ -0,0 +1,182 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+#import "FBTweakObserverProfiler.h"
+#import "_FBTweakObserverProfiler.h"
+
+BOOL _FBTweakObserverProfilerEnabled = NO;
+
+static pthread_mutex_t _FBTweakObserverProfilerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static NSTimeInterval _FBTweakObserverProfilerSeconds(uint64_t duration)
+{
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+
+  return (double)duration * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface FBTweakObserverProfile ()
+@property (nonatomic, copy, readwrite) NSString *name;
+@property (nonatomic, assign, readwrite) NSUInteger deliveries;
+@property (nonatomic, assign, readwrite) NSTimeInterval totalDuration;
+@property (nonatomic, assign, readwrite) NSTimeInterval maximumDuration;
+@property (nonatomic, assign, readwrite) NSUInteger slowDeliveries;
+@end
+
+@implementation FBTweakObserverProfile
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %p; name = %@; deliveries = %lu; total = %.3f ms; maximum = %.3f ms; slow = %lu>", [self class], self, _name, (unsigned long)_deliveries, _totalDuration * 1000.0, _maximumDuration * 1000.0, (unsigned long)_slowDeliveries];
+}
+
+@end
+
+@implementation FBTweakObserverProfiler {
+  // Guarded by _FBTweakObserverProfilerMutex.
+  NSMutableDictionary *_profiles;
+}
+
++ (instancetype)sharedInstance
+{
+  static FBTweakObserverProfiler *sharedInstance = nil;
+
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    sharedInstance = [[self alloc] init];
+  });
+
+  return sharedInstance;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _profiles = [[NSMutableDictionary alloc] init];
+    _budget = 0.001;
+  }
+
+  return self;
+}
+
+- (BOOL)isEnabled
+{
+  return _FBTweakObserverProfilerIsEnabled();
+}
+
+- (void)setEnabled:(BOOL)enabled
+{
+  __atomic_store_n(&_FBTweakObserverProfilerEnabled, enabled, __ATOMIC_RELAXED);
+}
+
+- (NSTimeInterval)budget
+{
+  pthread_mutex_lock(&_FBTweakObserverProfilerMutex);
+  NSTimeInterval budget = _budget;
+  pthread_mutex_unlock(&_FBTweakObserverProfilerMutex);
+  return budget;
+}
+
+- (void)setBudget:(NSTimeInterval)budget
+{
+  NSParameterAssert(budget >= 0);
+
+  pthread_mutex_lock(&_FBTweakObserverProfilerMutex);
+  _budget = budget;
+  pthread_mutex_unlock(&_FBTweakObserverProfilerMutex);
+}
+
+- (NSArray *)profiles
+{
+  NSMutableArray *profiles = [[NSMutableArray alloc] init];
+
+  // Copied, so callers see a consistent view as deliveries continue.
+  pthread_mutex_lock(&_FBTweakObserverProfilerMutex);
+  for (FBTweakObserverProfile *profile in [_profiles objectEnumerator]) {
+    FBTweakObserverProfile *copy = [[FBTweakObserverProfile alloc] init];
+    copy.name = profile.name;
+    copy.deliveries = profile.deliveries;
+    copy.totalDuration = profile.totalDuration;
+    copy.maximumDuration = profile.maximumDuration;
+    copy.slowDeliveries = profile.slowDeliveries;
+    [profiles addObject:copy];
+  }
+  pthread_mutex_unlock(&_FBTweakObserverProfilerMutex);
+
+  [profiles sortUsingComparator:^NSComparisonResult(FBTweakObserverProfile *profile1, FBTweakObserverProfile *profile2) {
+    if (profile1.totalDuration != profile2.totalDuration) {
+      return (profile1.totalDuration > profile2.totalDuration ? NSOrderedAscending : NSOrderedDescending);
+    }
+    return [profile1.name compare:profile2.name];
+  }];
+
+  return profiles;
+}
+
+- (void)reset
+{
+  pthread_mutex_lock(&_FBTweakObserverProfilerMutex);
+  [_profiles removeAllObjects];
+  pthread_mutex_unlock(&_FBTweakObserverProfilerMutex);
+}
+
+- (void)_recordDuration:(NSTimeInterval)duration forName:(NSString *)name
+{
+  BOOL firstSlowDelivery = NO;
+  NSTimeInterval budget = 0;
+
+  pthread_mutex_lock(&_FBTweakObserverProfilerMutex);
+  FBTweakObserverProfile *profile = _profiles[name];
+  if (profile == nil) {
+    profile = [[FBTweakObserverProfile alloc] init];
+    profile.name = name;
+    _profiles[name] = profile;
+  }
+
+  profile.deliveries += 1;
+  profile.totalDuration += duration;
+  profile.maximumDuration = MAX(profile.maximumDuration, duration);
+
+  budget = _budget;
+  if (duration > budget) {
+    firstSlowDelivery = (profile.slowDeliveries == 0);
+    profile.slowDeliveries += 1;
+  }
+  pthread_mutex_unlock(&_FBTweakObserverProfilerMutex);
+
+  if (firstSlowDelivery) {
+    NSLog(@"FBTweak: %@ took %.3f ms to handle a tweak change, over the %.3f ms budget.", name, duration * 1000.0, budget * 1000.0);
+  }
+}
+
+@end
+
+void _FBTweakObserverProfilerRecord(id observer, uint64_t duration)
+{
+  NSString *name = nil;
+  if ([observer respondsToSelector:@selector(_profileName)]) {
+    name = [(id<_FBTweakObserverProfiling>)observer _profileName];
+  } else {
+    name = NSStringFromClass([observer class]);
+  }
+
+  // Queued observers outlive the observers they deliver to.
+  if (name == nil) {
+    return;
+  }
+
+  [[FBTweakObserverProfiler sharedInstance] _recordDuration:_FBTweakObserverProfilerSeconds(duration) forName:name];
+}
@@ -0,0 +1,34 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @abstract The name of the overrides file bundled with an app.
+  @discussion Looked for in the main bundle, with an extension of tweaks.
+    Values of tweaks read with {@ref FBTweakReleaseValue} come from here in
+    release builds, unless the downloaded file overrides them.
+ */
+extern NSString *const FBTweakReleaseBundledOverridesName;
+
+/**
+  @abstract Where to save a downloaded overrides file.
+  @discussion Read once, at launch, so a file saved here takes effect the
+    next time the app starts. Its records win over the bundled file's.
+  @return The path of the downloaded overrides file. It need not exist.
+ */
+extern NSString *FBTweakReleaseDownloadedOverridesPath(void);
+
+#ifdef __cplusplus
+}
+#endif
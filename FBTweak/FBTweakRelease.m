@@ -0,0 +1,186 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakRelease.h"
+#import "_FBTweakRelease.h"
+#import "_FBTweakOverridesFile.h"
+#import "_FBTweakVariable.h"
+
+#import <libkern/OSAtomic.h>
+#import <mach-o/dyld.h>
+#import <mach-o/getsect.h>
+#import <string.h>
+#import <sys/mman.h>
+
+NSString *const FBTweakReleaseBundledOverridesName = @"FBTweakRelease";
+
+NSString *FBTweakReleaseDownloadedOverridesPath(void)
+{
+  NSString *directory = [NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES) firstObject];
+  return [[directory stringByAppendingPathComponent:@"FBTweak"] stringByAppendingPathComponent:@"Release.tweaks"];
+}
+
+// Parses every record of a file, which is complete, so the last line
+// needn't end with a newline.
+static void _FBTweakReleaseAddOverrides(NSMutableDictionary *overrides, NSString *path)
+{
+  NSData *data = (path != nil ? [NSData dataWithContentsOfFile:path] : nil);
+  if (data == nil) {
+    return;
+  }
+
+  NSMutableData *completeData = [data mutableCopy];
+  [completeData appendBytes:"\n" length:1];
+
+  NSDictionary *records = _FBTweakOverridesFileRecords(completeData);
+  [records enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSString *text, BOOL *stop) {
+    FBTweakValue value = nil;
+    if (_FBTweakOverridesFileParseValue(text, &value)) {
+      overrides[identifier] = value ?: [NSNull null];
+    }
+  }];
+}
+
+static NSDictionary *_FBTweakReleaseOverrides(void)
+{
+  static NSDictionary *overrides = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableDictionary *mutableOverrides = [[NSMutableDictionary alloc] init];
+    _FBTweakReleaseAddOverrides(mutableOverrides, [[NSBundle mainBundle] pathForResource:FBTweakReleaseBundledOverridesName ofType:@"tweaks"]);
+    _FBTweakReleaseAddOverrides(mutableOverrides, FBTweakReleaseDownloadedOverridesPath());
+    overrides = [mutableOverrides copy];
+  });
+  return overrides;
+}
+
+// If a site of a type can read an overridden value.
+static BOOL _FBTweakReleaseValueIsUsable(const char *encoding, FBTweakValue value)
+{
+  if (_FBTweakVariableEncodingIsSupported(encoding)) {
+    return [value isKindOfClass:[NSNumber class]];
+  } else if (strcmp(encoding, @encode(id)) == 0) {
+    return ([value isKindOfClass:[NSNumber class]] || [value isKindOfClass:[NSString class]]);
+  } else {
+    return [value isKindOfClass:[NSString class]];
+  }
+}
+
+// Values are kept for the life of the process, as sites never stop reading them.
+static void _FBTweakReleaseStore(fb_tweak_release_value *slot, const char *encoding, FBTweakValue value)
+{
+  if (_FBTweakVariableEncodingIsSupported(encoding)) {
+    _FBTweakVariableStore(slot, encoding, value, value);
+  } else if (strcmp(encoding, @encode(id)) == 0) {
+    slot->pointer = CFBridgingRetain([value copy]);
+  } else {
+    slot->pointer = strdup([value UTF8String]);
+  }
+}
+
+void _FBTweakReleaseResolveEntries(fb_tweak_release_entry *entries, size_t count, NSDictionary *overrides)
+{
+  // Sites of the same tweak and type share a slot.
+  NSMutableDictionary *slotIndexes = [[NSMutableDictionary alloc] init];
+  NSMutableArray *slotValues = [[NSMutableArray alloc] init];
+  NSMutableArray *slotEncodings = [[NSMutableArray alloc] init];
+  size_t *entrySlots = malloc(count * sizeof(size_t));
+
+  for (size_t i = 0; i < count; i++) {
+    fb_tweak_release_entry *entry = &entries[i];
+    NSString *identifier = [NSString stringWithFormat:@"FBTweak:%@-%@-%@", entry->category, entry->collection, entry->name];
+    FBTweakValue value = overrides[identifier];
+
+    entrySlots[i] = SIZE_MAX;
+    if (value == nil || !_FBTweakReleaseValueIsUsable(entry->encoding, value)) {
+      continue;
+    }
+
+    NSString *key = [NSString stringWithFormat:@"%s %@", entry->encoding, identifier];
+    NSNumber *slotIndex = slotIndexes[key];
+    if (slotIndex == nil) {
+      slotIndex = @(slotValues.count);
+      slotIndexes[key] = slotIndex;
+      [slotValues addObject:value];
+      [slotEncodings addObject:@(entry->encoding)];
+    }
+    entrySlots[i] = [slotIndex unsignedLongValue];
+  }
+
+  fb_tweak_release_value *table = NULL;
+  size_t tableSize = 0;
+  if (slotValues.count > 0) {
+    tableSize = slotValues.count * sizeof(fb_tweak_release_value);
+    table = mmap(NULL, tableSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (table == MAP_FAILED) {
+      table = NULL;
+    }
+  }
+
+  if (table != NULL) {
+    for (NSUInteger i = 0; i < slotValues.count; i++) {
+      _FBTweakReleaseStore(&table[i], [slotEncodings[i] UTF8String], slotValues[i]);
+    }
+
+    // Filled once, so nothing can write to it again.
+    mprotect(table, tableSize, PROT_READ);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    fb_tweak_release_entry *entry = &entries[i];
+    const void *value = (table != NULL && entrySlots[i] != SIZE_MAX ? &table[entrySlots[i]] : entry->defaultValue);
+    __atomic_store_n(&entry->value, value, __ATOMIC_RELEASE);
+  }
+
+  free(entrySlots);
+}
+
+#ifdef __LP64__
+typedef struct mach_header_64 fb_tweak_release_header;
+#else
+typedef struct mach_header fb_tweak_release_header;
+#endif
+
+static void _FBTweakReleaseAddImage(const struct mach_header *mach_header, intptr_t vmaddr_slide)
+{
+  unsigned long size = 0;
+  fb_tweak_release_entry *entries = (fb_tweak_release_entry *)getsectiondata((const fb_tweak_release_header *)mach_header, FBTweakSegmentName, FBTweakReleaseSectionName, &size);
+  size_t count = (entries != NULL ? size / sizeof(fb_tweak_release_entry) : 0);
+  if (count == 0) {
+    return;
+  }
+
+  // Sites already read their defaults, so there's nothing to do without overrides.
+  NSDictionary *overrides = _FBTweakReleaseOverrides();
+  if (overrides.count == 0) {
+    return;
+  }
+
+  @autoreleasepool {
+    _FBTweakReleaseResolveEntries(entries, count, overrides);
+  }
+}
+
+@interface _FBTweakReleaseLoader : NSObject
+@end
+
+@implementation _FBTweakReleaseLoader
+
++ (void)load
+{
+  static uint32_t _releaseTweaksLoaded = 0;
+  if (OSAtomicTestAndSetBarrier(1, &_releaseTweaksLoaded)) {
+    return;
+  }
+
+  // Images without release tweaks cost a section lookup.
+  _dyld_register_func_for_add_image(_FBTweakReleaseAddImage);
+}
+
+@end
@@ -0,0 +1,137 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweakStore;
+
+/**
+  @abstract The error domain for tweak server errors.
+  @discussion Error codes are errno values from the failing socket call.
+ */
+extern NSString *const FBTweakServerErrorDomain;
+
+/**
+  @abstract The kinds of message in the tweak server protocol.
+  @discussion Every message is a frame: a little-endian uint32 length of
+    the rest of the frame, a uint8 opcode and a uint32 tag chosen by the
+    client, then the payload. Clients may send any number of requests
+    without waiting; each request gets one response, in request order,
+    with the same opcode and tag. Values are encoded as described in
+    _FBTweakBinaryCoding.h.
+ */
+typedef NS_ENUM(uint8_t, FBTweakServerOpcode) {
+  /**
+    Lists every tweak. No request payload. The response is a uint32 count,
+    then for each tweak its identifier, category, collection and name
+    strings, a uint8 flags field (bit 0 set for actions), the default and
+    current values, the step and precision values, and a uint8 possible
+    values kind: 0 for none, 1 for a range followed by the minimum and
+    maximum values, 2 for an array followed by a uint32 count and the
+    values, 3 for a dictionary followed by a uint32 count and pairs of
+    value and title string.
+   */
+  FBTweakServerOpcodeList = 0x01,
+
+  /**
+    Reads current values. The request is a uint32 count and that many
+    identifier strings. The response is a uint32 count and the effective
+    value of each, nil for unknown identifiers.
+   */
+  FBTweakServerOpcodeRead = 0x02,
+
+  /**
+    Writes current values as one store batch. The request is a uint32
+    count and that many pairs of identifier string and value; a nil value
+    resets the tweak. The response is a uint32 count of tweaks written.
+   */
+  FBTweakServerOpcodeWrite = 0x03,
+
+  /**
+    Starts streaming change events to this connection, including for
+    tweaks registered later. No payload in either direction.
+   */
+  FBTweakServerOpcodeSubscribe = 0x04,
+
+  /**
+    Stops streaming change events to this connection. No payload in
+    either direction.
+   */
+  FBTweakServerOpcodeUnsubscribe = 0x05,
+
+  /**
+    Sent by the server, with a zero tag, when a tweak changes on a
+    subscribed connection. The payload is the identifier and the new
+    effective value.
+   */
+  FBTweakServerOpcodeEvent = 0x80,
+
+  /**
+    Sent by the server in response to a malformed or unknown request.
+    The payload is a message string.
+   */
+  FBTweakServerOpcodeError = 0xFF,
+};
+
+/**
+  @abstract Serves a tweak store to local tools over a socket.
+  @discussion Listens only on loopback or a Unix domain socket, and
+    is never started automatically. Requests are applied to the store on
+    the main queue. Restrict this to debug builds.
+ */
+@interface FBTweakServer : NSObject
+
+/**
+  @abstract Creates a server listening on a loopback TCP port.
+  @param store The store to serve.
+  @param port The port to listen on, or zero to pick a free port.
+ */
+- (instancetype)initWithStore:(FBTweakStore *)store port:(uint16_t)port;
+
+/**
+  @abstract Creates a server listening on a Unix domain socket.
+  @param store The store to serve.
+  @param socketPath The path of the socket. Replaced if it exists.
+ */
+- (instancetype)initWithStore:(FBTweakStore *)store socketPath:(NSString *)socketPath;
+
+/**
+  @abstract The store being served.
+ */
+@property (nonatomic, strong, readonly) FBTweakStore *store;
+
+/**
+  @abstract The loopback port the server is listening on.
+  @discussion Zero for Unix domain socket servers, or before starting.
+ */
+@property (nonatomic, assign, readonly) uint16_t port;
+
+/**
+  @abstract The Unix domain socket path, if any.
+ */
+@property (nonatomic, copy, readonly) NSString *socketPath;
+
+/**
+  @abstract If the server is accepting connections.
+ */
+@property (nonatomic, assign, readonly, getter = isRunning) BOOL running;
+
+/**
+  @abstract Starts accepting connections.
+  @param error On failure, the reason the socket couldn't be opened.
+  @return YES if the server started.
+ */
+- (BOOL)startWithError:(NSError **)error;
+
+/**
+  @abstract Stops accepting connections and closes open ones.
+ */
+- (void)stop;
+
+@end
@@ -0,0 +1,551 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakServer.h"
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "_FBTweakBinaryCoding.h"
+#import "_FBTweakStore.h"
+
+#import <sys/socket.h>
+#import <sys/un.h>
+#import <netinet/in.h>
+#import <arpa/inet.h>
+#import <unistd.h>
+#import <fcntl.h>
+
+NSString *const FBTweakServerErrorDomain = @"FBTweakServerErrorDomain";
+
+// Frames larger than this are treated as a protocol error.
+static const uint32_t _FBTweakServerMaximumFrameLength = 16 * 1024 * 1024;
+
+// Opcode and tag.
+static const NSUInteger _FBTweakServerFrameHeaderLength = sizeof(uint8_t) + sizeof(uint32_t);
+
+@class _FBTweakServerConnection;
+
+@interface FBTweakServer () <FBTweakObserver>
+- (void)_connection:(_FBTweakServerConnection *)connection receivedOpcode:(FBTweakServerOpcode)opcode tag:(uint32_t)tag payload:(NSData *)payload;
+- (void)_connectionDidClose:(_FBTweakServerConnection *)connection;
+@end
+
+@interface _FBTweakServerConnection : NSObject
+
+- (instancetype)initWithServer:(FBTweakServer *)server fileDescriptor:(int)fileDescriptor;
+
+@property (atomic, assign, readwrite, getter = isSubscribed) BOOL subscribed;
+
+- (void)sendOpcode:(FBTweakServerOpcode)opcode tag:(uint32_t)tag payload:(NSData *)payload;
+- (void)close;
+
+@end
+
+@implementation _FBTweakServerConnection {
+  __weak FBTweakServer *_server;
+  int _fileDescriptor;
+  dispatch_queue_t _queue;
+  dispatch_source_t _readSource;
+  NSMutableData *_buffer;
+}
+
+- (instancetype)initWithServer:(FBTweakServer *)server fileDescriptor:(int)fileDescriptor
+{
+  if ((self = [super init])) {
+    _server = server;
+    _fileDescriptor = fileDescriptor;
+    _queue = dispatch_queue_create("com.facebook.tweaks.server.connection", DISPATCH_QUEUE_SERIAL);
+    _buffer = [[NSMutableData alloc] init];
+
+    int noSigPipe = 1;
+    setsockopt(_fileDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+
+    // Accepted sockets inherit non-blocking from the listening socket, but
+    // each connection writes whole frames on its own queue.
+    fcntl(_fileDescriptor, F_SETFL, fcntl(_fileDescriptor, F_GETFL) & ~O_NONBLOCK);
+
+    __weak _FBTweakServerConnection *weakSelf = self;
+    _readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, _fileDescriptor, 0, _queue);
+    dispatch_source_set_event_handler(_readSource, ^{
+      [weakSelf _readAvailableData];
+    });
+    dispatch_source_set_cancel_handler(_readSource, ^{
+      close(fileDescriptor);
+    });
+    dispatch_resume(_readSource);
+  }
+
+  return self;
+}
+
+- (void)_readAvailableData
+{
+  uint8_t bytes[16 * 1024];
+  ssize_t length = read(_fileDescriptor, bytes, sizeof(bytes));
+  if (length <= 0) {
+    [self close];
+    return;
+  }
+
+  [_buffer appendBytes:bytes length:length];
+
+  // Handle every complete frame; pipelined requests arrive together.
+  NSUInteger offset = 0;
+  while (_buffer.length - offset >= sizeof(uint32_t)) {
+    _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake((const uint8_t *)_buffer.bytes + offset, _buffer.length - offset);
+    uint32_t frameLength = _FBTweakBinaryReadUInt32(&reader);
+    if (frameLength < _FBTweakServerFrameHeaderLength || frameLength > _FBTweakServerMaximumFrameLength) {
+      [self close];
+      return;
+    }
+
+    if (reader.length - reader.offset < frameLength) {
+      break;
+    }
+
+    FBTweakServerOpcode opcode = _FBTweakBinaryReadUInt8(&reader);
+    uint32_t tag = _FBTweakBinaryReadUInt32(&reader);
+    NSData *payload = [NSData dataWithBytes:reader.bytes + reader.offset length:frameLength - _FBTweakServerFrameHeaderLength];
+    offset += sizeof(uint32_t) + frameLength;
+
+    [_server _connection:self receivedOpcode:opcode tag:tag payload:payload];
+  }
+
+  [_buffer replaceBytesInRange:NSMakeRange(0, offset) withBytes:NULL length:0];
+}
+
+- (void)sendOpcode:(FBTweakServerOpcode)opcode tag:(uint32_t)tag payload:(NSData *)payload
+{
+  NSMutableData *frame = [[NSMutableData alloc] initWithCapacity:sizeof(uint32_t) + _FBTweakServerFrameHeaderLength + payload.length];
+  _FBTweakBinaryAppendUInt32(frame, (uint32_t)(_FBTweakServerFrameHeaderLength + payload.length));
+  _FBTweakBinaryAppendUInt8(frame, opcode);
+  _FBTweakBinaryAppendUInt32(frame, tag);
+  [frame appendData:payload];
+
+  dispatch_async(_queue, ^{
+    if (dispatch_source_testcancel(_readSource)) {
+      return;
+    }
+
+    const uint8_t *bytes = frame.bytes;
+    NSUInteger remaining = frame.length;
+    while (remaining > 0) {
+      ssize_t written = write(_fileDescriptor, bytes, remaining);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        [self close];
+        return;
+      }
+
+      bytes += written;
+      remaining -= written;
+    }
+  });
+}
+
+- (void)close
+{
+  dispatch_async(_queue, ^{
+    if (!dispatch_source_testcancel(_readSource)) {
+      dispatch_source_cancel(_readSource);
+      [_server _connectionDidClose:self];
+    }
+  });
+}
+
+@end
+
+@implementation FBTweakServer {
+  dispatch_queue_t _queue;
+  dispatch_source_t _listenSource;
+  NSMutableSet *_connections;
+
+  // Only accessed on the main queue.
+  NSDictionary *_identifierTweaks;
+  id _registrationObserver;
+}
+
+- (instancetype)initWithStore:(FBTweakStore *)store port:(uint16_t)port
+{
+  if ((self = [self _initWithStore:store])) {
+    _port = port;
+  }
+
+  return self;
+}
+
+- (instancetype)initWithStore:(FBTweakStore *)store socketPath:(NSString *)socketPath
+{
+  NSParameterAssert(socketPath != nil);
+
+  if ((self = [self _initWithStore:store])) {
+    _socketPath = [socketPath copy];
+  }
+
+  return self;
+}
+
+- (instancetype)_initWithStore:(FBTweakStore *)store
+{
+  NSParameterAssert(store != nil);
+
+  if ((self = [super init])) {
+    _store = store;
+    _queue = dispatch_queue_create("com.facebook.tweaks.server", DISPATCH_QUEUE_SERIAL);
+    _connections = [[NSMutableSet alloc] init];
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  [self stop];
+
+  if (_registrationObserver != nil) {
+    [[NSNotificationCenter defaultCenter] removeObserver:_registrationObserver];
+  }
+}
+
+- (BOOL)isRunning
+{
+  return (_listenSource != nil);
+}
+
+#pragma mark Listening
+
+static BOOL _FBTweakServerFail(NSError **error, int fileDescriptor)
+{
+  int code = errno;
+  if (fileDescriptor >= 0) {
+    close(fileDescriptor);
+  }
+
+  if (error != NULL) {
+    *error = [NSError errorWithDomain:FBTweakServerErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey : @(strerror(code))}];
+  }
+
+  return NO;
+}
+
+- (BOOL)startWithError:(NSError **)error
+{
+  if (_listenSource != nil) {
+    return YES;
+  }
+
+  int fileDescriptor = -1;
+
+  if (_socketPath != nil) {
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    if (strlcpy(address.sun_path, _socketPath.fileSystemRepresentation, sizeof(address.sun_path)) >= sizeof(address.sun_path)) {
+      errno = ENAMETOOLONG;
+      return _FBTweakServerFail(error, fileDescriptor);
+    }
+
+    unlink(address.sun_path);
+
+    fileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fileDescriptor < 0 || bind(fileDescriptor, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      return _FBTweakServerFail(error, fileDescriptor);
+    }
+  } else {
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    fileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    if (fileDescriptor < 0) {
+      return _FBTweakServerFail(error, fileDescriptor);
+    }
+
+    int reuseAddress = 1;
+    setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    if (bind(fileDescriptor, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      return _FBTweakServerFail(error, fileDescriptor);
+    }
+
+    socklen_t addressLength = sizeof(address);
+    getsockname(fileDescriptor, (struct sockaddr *)&address, &addressLength);
+    _port = ntohs(address.sin_port);
+  }
+
+  if (listen(fileDescriptor, 4) != 0) {
+    return _FBTweakServerFail(error, fileDescriptor);
+  }
+
+  fcntl(fileDescriptor, F_SETFL, O_NONBLOCK);
+
+  __weak FBTweakServer *weakSelf = self;
+  _listenSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, fileDescriptor, 0, _queue);
+  dispatch_source_set_event_handler(_listenSource, ^{
+    [weakSelf _acceptConnectionOnFileDescriptor:fileDescriptor];
+  });
+  dispatch_source_set_cancel_handler(_listenSource, ^{
+    close(fileDescriptor);
+  });
+  dispatch_resume(_listenSource);
+
+  return YES;
+}
+
+- (void)_acceptConnectionOnFileDescriptor:(int)listenFileDescriptor
+{
+  int fileDescriptor = accept(listenFileDescriptor, NULL, NULL);
+  if (fileDescriptor < 0) {
+    return;
+  }
+
+  _FBTweakServerConnection *connection = [[_FBTweakServerConnection alloc] initWithServer:self fileDescriptor:fileDescriptor];
+  @synchronized (_connections) {
+    [_connections addObject:connection];
+  }
+}
+
+- (void)stop
+{
+  if (_listenSource == nil) {
+    return;
+  }
+
+  dispatch_source_cancel(_listenSource);
+  _listenSource = nil;
+
+  if (_socketPath != nil) {
+    unlink(_socketPath.fileSystemRepresentation);
+  }
+
+  NSSet *connections = nil;
+  @synchronized (_connections) {
+    connections = [_connections copy];
+  }
+
+  for (_FBTweakServerConnection *connection in connections) {
+    [connection close];
+  }
+}
+
+- (void)_connectionDidClose:(_FBTweakServerConnection *)connection
+{
+  @synchronized (_connections) {
+    [_connections removeObject:connection];
+  }
+}
+
+#pragma mark Requests
+
+- (void)_connection:(_FBTweakServerConnection *)connection receivedOpcode:(FBTweakServerOpcode)opcode tag:(uint32_t)tag payload:(NSData *)payload
+{
+  // The store isn't thread safe. Requests are handled in the order they
+  // arrive, so responses are sent back in the same order.
+  dispatch_async(dispatch_get_main_queue(), ^{
+    _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(payload.bytes, payload.length);
+    NSMutableData *response = [[NSMutableData alloc] init];
+
+    switch (opcode) {
+      case FBTweakServerOpcodeList:
+        [self _appendListToResponse:response];
+        break;
+      case FBTweakServerOpcodeRead:
+        [self _readValuesWithReader:&reader response:response];
+        break;
+      case FBTweakServerOpcodeWrite:
+        [self _writeValuesWithReader:&reader response:response];
+        break;
+      case FBTweakServerOpcodeSubscribe:
+        [self _observeAllTweaks];
+        connection.subscribed = YES;
+        break;
+      case FBTweakServerOpcodeUnsubscribe:
+        connection.subscribed = NO;
+        break;
+      default:
+        reader.failed = YES;
+        break;
+    }
+
+    if (reader.failed) {
+      NSMutableData *message = [[NSMutableData alloc] init];
+      _FBTweakBinaryAppendString(message, [NSString stringWithFormat:@"Malformed request with opcode %d.", opcode]);
+      [connection sendOpcode:FBTweakServerOpcodeError tag:tag payload:message];
+    } else {
+      [connection sendOpcode:opcode tag:tag payload:response];
+    }
+  });
+}
+
+- (NSArray *)_allTweaks
+{
+  NSMutableArray *tweaks = [[NSMutableArray alloc] init];
+  for (FBTweakCategory *category in _store.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      [tweaks addObjectsFromArray:collection.tweaks];
+    }
+  }
+  return tweaks;
+}
+
+- (FBTweak *)_tweakWithIdentifier:(NSString *)identifier
+{
+  FBTweak *tweak = _identifierTweaks[identifier];
+  if (tweak == nil && identifier != nil) {
+    // Tweaks may have been registered since the index was built.
+    NSMutableDictionary *identifierTweaks = [[NSMutableDictionary alloc] init];
+    for (FBTweak *indexedTweak in [self _allTweaks]) {
+      identifierTweaks[indexedTweak.identifier] = indexedTweak;
+    }
+    _identifierTweaks = identifierTweaks;
+    tweak = _identifierTweaks[identifier];
+  }
+  return tweak;
+}
+
+- (void)_appendListToResponse:(NSMutableData *)response
+{
+  NSMutableData *entries = [[NSMutableData alloc] init];
+  uint32_t count = 0;
+
+  for (FBTweakCategory *category in _store.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      for (FBTweak *tweak in collection.tweaks) {
+        _FBTweakBinaryAppendString(entries, tweak.identifier);
+        _FBTweakBinaryAppendString(entries, category.name);
+        _FBTweakBinaryAppendString(entries, collection.name);
+        _FBTweakBinaryAppendString(entries, tweak.name);
+        _FBTweakBinaryAppendUInt8(entries, tweak.isAction ? 1 : 0);
+
+        if (tweak.isAction) {
+          _FBTweakBinaryAppendValue(entries, nil);
+          _FBTweakBinaryAppendValue(entries, nil);
+        } else {
+          _FBTweakBinaryAppendValue(entries, tweak.defaultValue);
+          _FBTweakBinaryAppendValue(entries, tweak.currentValue);
+        }
+
+        _FBTweakBinaryAppendValue(entries, tweak.stepValue);
+        _FBTweakBinaryAppendValue(entries, tweak.precisionValue);
+
+        id possibleValues = tweak.possibleValues;
+        if ([possibleValues isKindOfClass:[FBTweakNumericRange class]]) {
+          _FBTweakBinaryAppendUInt8(entries, 1);
+          _FBTweakBinaryAppendValue(entries, [possibleValues minimumValue]);
+          _FBTweakBinaryAppendValue(entries, [possibleValues maximumValue]);
+        } else if ([possibleValues isKindOfClass:[NSArray class]]) {
+          _FBTweakBinaryAppendUInt8(entries, 2);
+          _FBTweakBinaryAppendUInt32(entries, (uint32_t)[possibleValues count]);
+          for (FBTweakValue value in possibleValues) {
+            _FBTweakBinaryAppendValue(entries, value);
+          }
+        } else if ([possibleValues isKindOfClass:[NSDictionary class]]) {
+          _FBTweakBinaryAppendUInt8(entries, 3);
+          _FBTweakBinaryAppendUInt32(entries, (uint32_t)[possibleValues count]);
+          [possibleValues enumerateKeysAndObjectsUsingBlock:^(id key, id title, BOOL *stop) {
+            _FBTweakBinaryAppendValue(entries, key);
+            _FBTweakBinaryAppendString(entries, [title description]);
+          }];
+        } else {
+          _FBTweakBinaryAppendUInt8(entries, 0);
+        }
+
+        count++;
+      }
+    }
+  }
+
+  _FBTweakBinaryAppendUInt32(response, count);
+  [response appendData:entries];
+}
+
+- (void)_readValuesWithReader:(_FBTweakBinaryReader *)reader response:(NSMutableData *)response
+{
+  uint32_t count = _FBTweakBinaryReadUInt32(reader);
+  _FBTweakBinaryAppendUInt32(response, count);
+
+  for (uint32_t i = 0; i < count && !reader->failed; i++) {
+    FBTweak *tweak = [self _tweakWithIdentifier:_FBTweakBinaryReadString(reader)];
+    _FBTweakBinaryAppendValue(response, (tweak.isAction ? nil : (tweak.currentValue ?: tweak.defaultValue)));
+  }
+}
+
+- (void)_writeValuesWithReader:(_FBTweakBinaryReader *)reader response:(NSMutableData *)response
+{
+  // Decode the whole request before applying any of it.
+  NSMutableArray *tweaks = [[NSMutableArray alloc] init];
+  NSMutableArray *values = [[NSMutableArray alloc] init];
+
+  uint32_t count = _FBTweakBinaryReadUInt32(reader);
+  for (uint32_t i = 0; i < count && !reader->failed; i++) {
+    FBTweak *tweak = [self _tweakWithIdentifier:_FBTweakBinaryReadString(reader)];
+    FBTweakValue value = _FBTweakBinaryReadValue(reader);
+
+    if (tweak != nil && !tweak.isAction) {
+      [tweaks addObject:tweak];
+      [values addObject:(value ?: [NSNull null])];
+    }
+  }
+
+  if (reader->failed) {
+    return;
+  }
+
+  [_store performBatchUpdates:^{
+    [tweaks enumerateObjectsUsingBlock:^(FBTweak *tweak, NSUInteger idx, BOOL *stop) {
+      FBTweakValue value = values[idx];
+      tweak.currentValue = (value != [NSNull null] ? value : nil);
+    }];
+  }];
+
+  _FBTweakBinaryAppendUInt32(response, (uint32_t)tweaks.count);
+}
+
+#pragma mark Events
+
+- (void)_observeAllTweaks
+{
+  for (FBTweak *tweak in [self _allTweaks]) {
+    [tweak addObserver:self];
+  }
+
+  // Tweaks in images loaded later are observed once they're registered.
+  if (_registrationObserver == nil) {
+    __weak FBTweakServer *weakSelf = self;
+    _registrationObserver = [[NSNotificationCenter defaultCenter] addObserverForName:_FBTweakStoreDidRegisterTweaksNotification object:_store queue:nil usingBlock:^(NSNotification *notification) {
+      [weakSelf _observeAllTweaks];
+    }];
+  }
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  NSArray *subscribers = nil;
+  @synchronized (_connections) {
+    subscribers = [[_connections allObjects] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"subscribed == YES"]];
+  }
+
+  if (subscribers.count == 0) {
+    return;
+  }
+
+  NSMutableData *payload = [[NSMutableData alloc] init];
+  _FBTweakBinaryAppendString(payload, tweak.identifier);
+  _FBTweakBinaryAppendValue(payload, tweak.currentValue ?: tweak.defaultValue);
+
+  for (_FBTweakServerConnection *connection in subscribers) {
+    [connection sendOpcode:FBTweakServerOpcodeEvent tag:0 payload:payload];
+  }
+}
+
+@end
@@ -0,0 +1,78 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+@class FBTweakStore;
+
+/**
+  @abstract Shares tweak values between processes through a mapped file.
+  @discussion Use a path every process can reach, such as an app group
+    container, to share values between an app and its extensions. Each
+    attached tweak owns one fixed-size slot in the file. Writes update the
+    slot atomically; reads of {@ref -[FBTweak currentValue]} compare one
+    slot counter with memory and make no system calls. Numbers, strings
+    of up to 44 UTF-8 bytes and colors can be shared; other values stay
+    local to the process that set them.
+ */
+@interface FBTweakSharedTable : NSObject
+
+/**
+  @abstract Opens or creates a shared table.
+  @discussion This is the designated initializer.
+  @param path The file backing the table.
+  @param capacity The number of tweaks the table can hold. Ignored if the
+    file already exists, in which case its capacity is used.
+  @param error On failure, the POSIX error opening or mapping the file.
+  @return The table, or nil if the file couldn't be mapped.
+ */
+- (instancetype)initWithPath:(NSString *)path capacity:(NSUInteger)capacity error:(NSError **)error;
+
+/**
+  @abstract The file backing the table.
+ */
+@property (nonatomic, copy, readonly) NSString *path;
+
+/**
+  @abstract The number of tweaks the table can hold.
+ */
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+  @abstract Incremented whenever any process changes a value in the table.
+  @discussion A single atomic load; compare with an earlier value to
+    check if anything changed.
+ */
+@property (nonatomic, assign, readonly) uint64_t changeSequence;
+
+/**
+  @abstract Backs all tweaks in a store with the table.
+  @param store The store whose tweaks to attach.
+ */
+- (void)attachStore:(FBTweakStore *)store;
+
+/**
+  @abstract Backs a tweak with the table.
+  @param tweak The tweak to attach. Actions are ignored.
+  @return NO if the table is full.
+  @discussion If another process has already set a value for the tweak's
+    identifier, the tweak takes that value. Otherwise, the tweak's
+    current value is shared.
+ */
+- (BOOL)attachTweak:(FBTweak *)tweak;
+
+/**
+  @abstract Notifies observers of tweaks changed by other processes.
+  @discussion Called automatically on the main queue when another process
+    writes to the table. Reading a tweak's value doesn't need this.
+ */
+- (void)synchronize;
+
+@end
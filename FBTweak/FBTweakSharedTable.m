@@ -0,0 +1,308 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakSharedTable.h"
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "_FBTweakSharedSlot.h"
+#import "_FBTweakBinaryCoding.h"
+#import "_FBTweakCollection.h"
+
+#import <libkern/OSAtomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <notify.h>
+#import <sched.h>
+#import <signal.h>
+#import <errno.h>
+
+static const uint32_t _FBTweakSharedTableMagic = 'FBTS';
+static const uint32_t _FBTweakSharedTableVersion = 2;
+
+#define _FBTweakSharedSlotPayloadSize 44
+
+// How many times a writer waits for a slot before checking if the process
+// holding it is still running.
+static const NSUInteger _FBTweakSharedSlotRetryLimit = 1024;
+
+// How many times a reader retries when a write starts while it reads.
+static const NSUInteger _FBTweakSharedSlotReadRetryLimit = 16;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t reserved;
+  volatile int64_t changeSequence;
+  uint8_t padding[40];
+} _FBTweakSharedHeader;
+
+// One cache line. The owner is the pid of the process writing the slot,
+// or zero; the sequence is odd while a write is in progress.
+struct _FBTweakSharedSlot {
+  volatile int32_t sequence;
+  volatile int32_t owner;
+  volatile int64_t identifierHash;
+  uint8_t type;
+  uint8_t length;
+  uint16_t reserved;
+  uint8_t payload[_FBTweakSharedSlotPayloadSize];
+};
+
+static int64_t _FBTweakSharedIdentifierHash(NSString *identifier)
+{
+  // Zero marks an unused slot.
+  uint64_t hash = _FBTweakIdentifierHash(identifier);
+  return (int64_t)(hash != 0 ? hash : 1);
+}
+
+BOOL _FBTweakSharedSlotRead(_FBTweakSharedSlot *slot, uint32_t *sequence, FBTweakValue *value)
+{
+  if ((uint32_t)slot->sequence == *sequence) {
+    return NO;
+  }
+
+  uint8_t type;
+  uint8_t length;
+  uint8_t payload[_FBTweakSharedSlotPayloadSize];
+  int32_t before;
+  NSUInteger attempts = 0;
+  do {
+    // Keeps the value last read rather than waiting for a writer; it
+    // notifies readers when it's done.
+    if (attempts++ == _FBTweakSharedSlotReadRetryLimit) {
+      return NO;
+    }
+
+    before = slot->sequence;
+    if ((before & 1) != 0) {
+      return NO;
+    }
+    OSMemoryBarrier();
+    type = slot->type;
+    length = slot->length;
+    memcpy(payload, slot->payload, sizeof(payload));
+    OSMemoryBarrier();
+  } while (slot->sequence != before);
+
+  *sequence = (uint32_t)before;
+  *value = _FBTweakBinaryDecodeFixedValue(type, payload, length);
+  return YES;
+}
+
+@implementation FBTweakSharedTable {
+  int _fileDescriptor;
+  _FBTweakSharedHeader *_header;
+  _FBTweakSharedSlot *_slots;
+  size_t _mappedLength;
+
+  NSString *_notificationName;
+  int _notificationToken;
+  uint64_t _synchronizedSequence;
+  NSHashTable *_tweaks;
+}
+
+- (instancetype)initWithPath:(NSString *)path capacity:(NSUInteger)capacity error:(NSError **)error
+{
+  NSParameterAssert(path != nil);
+  NSParameterAssert(capacity > 0);
+
+  if ((self = [super init])) {
+    _path = [path copy];
+    _fileDescriptor = open(_path.fileSystemRepresentation, O_RDWR | O_CREAT, 0644);
+    if (_fileDescriptor < 0 || ![self _mapWithCapacity:capacity]) {
+      if (error != NULL) {
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+      }
+      return nil;
+    }
+
+    _capacity = _header->capacity;
+    _tweaks = [NSHashTable weakObjectsHashTable];
+    _synchronizedSequence = _header->changeSequence;
+
+    // Tell other processes about writes without polling.
+    _notificationName = [NSString stringWithFormat:@"com.facebook.tweaks.shared.%llx", (unsigned long long)_FBTweakSharedIdentifierHash(_path)];
+    __weak FBTweakSharedTable *weakSelf = self;
+    notify_register_dispatch(_notificationName.UTF8String, &_notificationToken, dispatch_get_main_queue(), ^(int token) {
+      [weakSelf synchronize];
+    });
+  }
+
+  return self;
+}
+
+- (BOOL)_mapWithCapacity:(NSUInteger)capacity
+{
+  // Serialize creating the header between processes.
+  if (flock(_fileDescriptor, LOCK_EX) != 0) {
+    return NO;
+  }
+
+  struct stat status;
+  BOOL mapped = NO;
+  if (fstat(_fileDescriptor, &status) == 0) {
+    if (status.st_size >= (off_t)sizeof(_FBTweakSharedHeader)) {
+      _FBTweakSharedHeader existing;
+      if (pread(_fileDescriptor, &existing, sizeof(existing), 0) == sizeof(existing) && existing.magic == _FBTweakSharedTableMagic && existing.version == _FBTweakSharedTableVersion) {
+        capacity = existing.capacity;
+      } else {
+        ftruncate(_fileDescriptor, 0);
+      }
+    }
+
+    _mappedLength = sizeof(_FBTweakSharedHeader) + capacity * sizeof(_FBTweakSharedSlot);
+    if (ftruncate(_fileDescriptor, _mappedLength) == 0) {
+      void *memory = mmap(NULL, _mappedLength, PROT_READ | PROT_WRITE, MAP_SHARED, _fileDescriptor, 0);
+      if (memory != MAP_FAILED) {
+        _header = memory;
+        _slots = (_FBTweakSharedSlot *)(_header + 1);
+
+        if (_header->magic != _FBTweakSharedTableMagic) {
+          _header->version = _FBTweakSharedTableVersion;
+          _header->capacity = (uint32_t)capacity;
+          OSMemoryBarrier();
+          _header->magic = _FBTweakSharedTableMagic;
+        }
+        mapped = YES;
+      }
+    }
+  }
+
+  flock(_fileDescriptor, LOCK_UN);
+  return mapped;
+}
+
+- (void)dealloc
+{
+  notify_cancel(_notificationToken);
+
+  if (_header != NULL) {
+    munmap(_header, _mappedLength);
+  }
+
+  if (_fileDescriptor >= 0) {
+    close(_fileDescriptor);
+  }
+}
+
+- (uint64_t)changeSequence
+{
+  OSMemoryBarrier();
+  return (uint64_t)_header->changeSequence;
+}
+
+- (_FBTweakSharedSlot *)_slotForIdentifier:(NSString *)identifier
+{
+  int64_t hash = _FBTweakSharedIdentifierHash(identifier);
+
+  // Open addressing; slots are claimed atomically and never released.
+  for (NSUInteger i = 0; i < _capacity; i++) {
+    _FBTweakSharedSlot *slot = &_slots[((uint64_t)hash + i) % _capacity];
+    if (slot->identifierHash == hash) {
+      return slot;
+    }
+
+    if (slot->identifierHash == 0 && OSAtomicCompareAndSwap64Barrier(0, hash, &slot->identifierHash)) {
+      return slot;
+    }
+
+    if (slot->identifierHash == hash) {
+      return slot;
+    }
+  }
+
+  return NULL;
+}
+
+- (void)attachStore:(FBTweakStore *)store
+{
+  for (FBTweakCategory *category in store.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      for (FBTweak *tweak in collection.tweaks) {
+        [self attachTweak:tweak];
+      }
+    }
+  }
+}
+
+- (BOOL)attachTweak:(FBTweak *)tweak
+{
+  if (tweak.isAction) {
+    return YES;
+  }
+
+  _FBTweakSharedSlot *slot = [self _slotForIdentifier:tweak.identifier];
+  if (slot == NULL) {
+    return NO;
+  }
+
+  [_tweaks addObject:tweak];
+  [tweak _attachSharedTable:self slot:slot];
+  return YES;
+}
+
+- (void)synchronize
+{
+  uint64_t sequence = self.changeSequence;
+  if (sequence == _synchronizedSequence) {
+    return;
+  }
+
+  _synchronizedSequence = sequence;
+  for (FBTweak *tweak in [_tweaks allObjects]) {
+    [tweak _synchronizeSharedValue];
+  }
+}
+
+uint32_t _FBTweakSharedTableWrite(FBTweakSharedTable *table, _FBTweakSharedSlot *slot, FBTweakValue value)
+{
+  _FBTweakBinaryValueType type;
+  uint8_t payload[_FBTweakSharedSlotPayloadSize];
+  size_t length;
+  if (!_FBTweakBinaryEncodeFixedValue(value, &type, payload, sizeof(payload), &length)) {
+    return 0;
+  }
+
+  // Take the slot by storing this process as its owner; excludes other
+  // writers. A slot is only taken from another process once that process
+  // is gone, so a writer that's merely slow always finishes first.
+  pid_t pid = getpid();
+  for (NSUInteger attempts = 0; ; attempts++) {
+    int32_t owner = slot->owner;
+    if (owner == 0 || (attempts >= _FBTweakSharedSlotRetryLimit && kill(owner, 0) != 0 && errno == ESRCH)) {
+      if (OSAtomicCompareAndSwap32Barrier(owner, pid, &slot->owner)) {
+        break;
+      }
+    }
+    sched_yield();
+  }
+
+  // A writer that died mid-write left the sequence odd.
+  if ((slot->sequence & 1) == 0) {
+    OSAtomicIncrement32Barrier(&slot->sequence);
+  }
+
+  slot->type = type;
+  slot->length = (uint8_t)length;
+  memcpy(slot->payload, payload, sizeof(payload));
+
+  int32_t written = OSAtomicIncrement32Barrier(&slot->sequence);
+  OSAtomicCompareAndSwap32Barrier(pid, 0, &slot->owner);
+  OSAtomicIncrement64Barrier(&table->_header->changeSequence);
+  notify_post(table->_notificationName.UTF8String);
+
+  return (uint32_t)written;
+}
+
+@end
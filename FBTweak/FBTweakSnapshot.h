@@ -0,0 +1,111 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+
+extern volatile int64_t _FBTweakGenerationValue;
+
+/**
+  @abstract Counts changes to tweak values.
+  @discussion Changes whenever any tweak's current value changes, so
+    comparing it with an earlier generation is a cheap way to tell if
+    anything changed. A single atomic load.
+ */
+static inline uint64_t FBTweakGeneration(void)
+{
+  return (uint64_t)__atomic_load_n(&_FBTweakGenerationValue, __ATOMIC_ACQUIRE);
+}
+
+/**
+  @abstract Describes where a tweak's value goes in a snapshot struct.
+  @discussion Create with {@ref FBTweakSnapshotField}.
+ */
+@interface FBTweakSnapshotField : NSObject
+
+/**
+  @abstract Creates a field.
+  @param tweak The tweak to read.
+  @param offset The offset of the field in the struct.
+  @param encoding The @encode of the field's type. Must be a number type.
+ */
+- (instancetype)initWithTweak:(FBTweak *)tweak offset:(size_t)offset encoding:(const char *)encoding;
+
+/**
+  @abstract The tweak to read.
+ */
+@property (nonatomic, strong, readonly) FBTweak *tweak;
+
+/**
+  @abstract The offset of the field in the struct.
+ */
+@property (nonatomic, assign, readonly) size_t offset;
+
+/**
+  @abstract The size of the field.
+ */
+@property (nonatomic, assign, readonly) size_t size;
+
+@end
+
+/**
+  @abstract Describes a field of a snapshot struct.
+  @param type_ The struct type.
+  @param field_ The name of the field, which must have a number type.
+  @param tweak_ The tweak to read into the field.
+ */
+#define FBTweakSnapshotField(type_, field_, tweak_) \
+  ([[FBTweakSnapshotField alloc] initWithTweak:(tweak_) offset:offsetof(type_, field_) encoding:@encode(__typeof__(((type_ *)0)->field_))])
+
+/**
+  @abstract Reads a group of related tweaks into a struct, all at once.
+  @discussion Reading tweaks one by one can see some before a change and
+    some after it. A snapshot sees them all before or all after, so
+    values that go together, like a spring's constants, are consistent.
+    For example:
+
+      typedef struct { double tension; double friction; } Spring;
+
+      FBTweakSnapshot *snapshot = [[FBTweakSnapshot alloc] initWithFields:@[
+        FBTweakSnapshotField(Spring, tension, tensionTweak),
+        FBTweakSnapshotField(Spring, friction, frictionTweak),
+      ]];
+
+      // Per frame:
+      if ([snapshot captureValues:&_spring size:sizeof(_spring) generation:&_generation]) {
+        [self rebuildSpring];
+      }
+ */
+@interface FBTweakSnapshot : NSObject
+
+/**
+  @abstract Creates a snapshot of some tweaks.
+  @param fields The fields to fill in, from {@ref FBTweakSnapshotField}.
+ */
+- (instancetype)initWithFields:(NSArray *)fields;
+
+/**
+  @abstract The fields filled in by the snapshot.
+ */
+@property (nonatomic, copy, readonly) NSArray *fields;
+
+/**
+  @abstract Reads the tweaks into a struct, if any have changed.
+  @param values The struct to fill in. Only the fields are written.
+  @param size The size of the struct.
+  @param generation On input, the generation the struct was last filled
+    in at, or 0. On output, the generation of the values read. May be NULL
+    to always read.
+  @return YES if the struct was filled in, NO if no tweak had changed
+    since the generation passed in. Returning NO takes one atomic load.
+ */
+- (BOOL)captureValues:(void *)values size:(size_t)size generation:(uint64_t *)generation;
+
+@end
@@ -0,0 +1,141 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
+
+#import "FBTweakSnapshot.h"
+#import "FBTweak.h"
+#import "_FBTweakGeneration.h"
+
+// Starts above zero, so zero can mean "never read".
+volatile int64_t _FBTweakGenerationValue = 1;
+
+// Recursive, as reading a shared tweak in a snapshot can adopt its value.
+static pthread_mutex_t _FBTweakGenerationMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
+
+void _FBTweakGenerationLock(void)
+{
+  pthread_mutex_lock(&_FBTweakGenerationMutex);
+}
+
+void _FBTweakGenerationUnlock(void)
+{
+  pthread_mutex_unlock(&_FBTweakGenerationMutex);
+}
+
+void _FBTweakGenerationAdvance(void)
+{
+  OSAtomicIncrement64Barrier(&_FBTweakGenerationValue);
+}
+
+// Skips type qualifiers, like const.
+static char _FBTweakSnapshotEncodingType(const char *encoding)
+{
+  while (*encoding != '\0' && strchr("rnNoORV", *encoding) != NULL) {
+    encoding++;
+  }
+  return *encoding;
+}
+
+@interface FBTweakSnapshotField ()
+
+- (void)_storeValue:(FBTweakValue)value inValues:(uint8_t *)values;
+
+@end
+
+@implementation FBTweakSnapshotField {
+  char _type;
+}
+
+- (instancetype)initWithTweak:(FBTweak *)tweak offset:(size_t)offset encoding:(const char *)encoding
+{
+  NSParameterAssert(tweak != nil);
+  NSParameterAssert(encoding != NULL);
+
+  if ((self = [super init])) {
+    _tweak = tweak;
+    _offset = offset;
+    _type = _FBTweakSnapshotEncodingType(encoding);
+    NSAssert(_type != '\0' && strchr("cBCsSiIlLqQfd", _type) != NULL, @"snapshot fields must be numbers, not %s", encoding);
+
+    NSUInteger size = 0;
+    NSGetSizeAndAlignment(encoding, &size, NULL);
+    _size = size;
+  }
+
+  return self;
+}
+
+- (void)_storeValue:(FBTweakValue)value inValues:(uint8_t *)values
+{
+  void *field = values + _offset;
+
+  switch (_type) {
+    case 'c': { char v = [value charValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'B': { bool v = [value boolValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'C': { unsigned char v = [value unsignedCharValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 's': { short v = [value shortValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'S': { unsigned short v = [value unsignedShortValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'i': { int v = [value intValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'I': { unsigned int v = [value unsignedIntValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'l': { long v = [value longValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'L': { unsigned long v = [value unsignedLongValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'q': { long long v = [value longLongValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'Q': { unsigned long long v = [value unsignedLongLongValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'f': { float v = [value floatValue]; memcpy(field, &v, sizeof(v)); break; }
+    case 'd': { double v = [value doubleValue]; memcpy(field, &v, sizeof(v)); break; }
+  }
+}
+
+@end
+
+@implementation FBTweakSnapshot {
+  size_t _minimumSize;
+}
+
+- (instancetype)initWithFields:(NSArray *)fields
+{
+  NSParameterAssert(fields != nil);
+
+  if ((self = [super init])) {
+    _fields = [fields copy];
+
+    for (FBTweakSnapshotField *field in _fields) {
+      _minimumSize = MAX(_minimumSize, field.offset + field.size);
+    }
+  }
+
+  return self;
+}
+
+- (BOOL)captureValues:(void *)values size:(size_t)size generation:(uint64_t *)generation
+{
+  NSParameterAssert(values != NULL);
+  NSAssert(size >= _minimumSize, @"fields extend past the end of the struct");
+
+  if (generation != NULL && *generation == FBTweakGeneration()) {
+    return NO;
+  }
+
+  _FBTweakGenerationLock();
+  for (FBTweakSnapshotField *field in _fields) {
+    FBTweak *tweak = field.tweak;
+    [field _storeValue:(tweak.currentValue ?: tweak.defaultValue) inValues:values];
+  }
+  uint64_t capturedGeneration = FBTweakGeneration();
+  _FBTweakGenerationUnlock();
+
+  if (generation != NULL) {
+    *generation = capturedGeneration;
+  }
+  return YES;
+}
+
+@end
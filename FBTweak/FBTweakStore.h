@@ -10,6 +10,7 @@
 #import <Foundation/Foundation.h>
 
 @class FBTweakCategory;
+@class FBTweakCompactionReport;
 
 /**
   @abstract The global store for tweaks.
@@ -50,4 +51,80 @@
  */
 - (void)reset;
 
+/**
+  @abstract If inline tweaks are frozen to their default values.
+  @discussion While frozen, FBTweakValue returns its default through a single
+    branch, without looking up its tweak, and properties bound with
+    FBTweakBind, variables bound with FBTweakBindVariable and C handles hold
+    their defaults and ignore changes. Tweaks themselves, as returned by
+    FBTweakInline, keep their values, and changes to them take effect when
+    tweaks are thawed. Useful to measure tweak overhead without rebuilding.
+    Changing this updates every binding in one pass, and should be done on
+    the main thread.
+ */
+@property (nonatomic, assign, readwrite, getter = isFrozen) BOOL frozen;
+
+/**
+  @abstract Applies several tweak changes as one update.
+  @param updates A block that changes the current values of tweaks.
+  @discussion Observers of each changed tweak are sent -tweakDidChange:
+    once, after the block returns, rather than once per change. Batches
+    are per-thread and can be nested; only the outermost batch notifies.
+ */
+- (void)performBatchUpdates:(dispatch_block_t)updates;
+
+/**
+  @abstract Runs a block with tweak changes kept to the current thread.
+  @discussion Inside the block, setting a tweak's current value only
+    changes it for this thread, in memory: nothing is persisted, journaled
+    or shared, and C handles keep the global value. Other threads see the
+    global values throughout. Observers aren't told about overrides, since
+    they watch the global value. When the block returns the overrides are
+    discarded. Calls nest, with inner blocks starting from the outer
+    overrides.
+    Useful for tests that run in parallel.
+  @param block The block to run.
+ */
++ (void)withOverrides:(dispatch_block_t)block;
+
+/**
+  @abstract Applies tweak values from a file, and again whenever it changes.
+  @discussion Each line is `identifier = value`, where the value is a JSON
+    number, boolean or string, or null to reset the tweak. Only changed
+    lines are applied, as one batch on the main queue. Removing a line
+    resets its tweak. Replacing the file with an atomic rename is the
+    safest way to update it; lines without a trailing newline are ignored
+    until they are complete. Replaces any file already being watched.
+  @param path The path of the file. It need not exist yet, but its
+    directory must.
+  @param error On failure, the error.
+  @return If the file could be watched.
+ */
+- (BOOL)watchOverridesFileAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+  @abstract Stops watching the overrides file. Applied values are kept.
+ */
+- (void)stopWatchingOverridesFile;
+
+/**
+  @abstract Removes persisted values of tweaks that are no longer registered.
+  @discussion Values are persisted under their tweak's identifier, and stay
+    after the tweak is removed from the source. This finds persisted values
+    with inline tweak identifiers that no registered tweak has, and removes
+    them from the user defaults in one write. Tweaks can be registered
+    later, by images that aren't loaded yet, so values are only removed
+    once they have been orphaned on every pass for the retention interval.
+    A value stops counting as orphaned when its tweak comes back, on a
+    later pass or when an image loaded after the pass registers it, so
+    tweaks in images loaded on demand keep theirs. Runs automatically, with a
+    retention interval of a week, once images loaded at launch have
+    registered their tweaks.
+  @param retentionInterval How long a value must be orphaned before it is
+    removed. Zero removes orphaned values right away.
+  @param dryRun If YES, reports what would be removed without removing it.
+  @return A report of the orphaned values.
+ */
+- (FBTweakCompactionReport *)compactPersistedValuesWithRetentionInterval:(NSTimeInterval)retentionInterval dryRun:(BOOL)dryRun;
+
 @end
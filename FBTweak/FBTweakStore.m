@@ -11,10 +11,32 @@
 #import "FBTweak.h"
 #import "FBTweakCategory.h"
 #import "FBTweakCollection.h"
+#import "FBTweakCompactionReport.h"
+#import "_FBTweakBatch.h"
+#import "_FBTweakBindObserver.h"
+#import "_FBTweakCollection.h"
+#import "_FBTweakFrozen.h"
+#import "_FBTweakOverridesFile.h"
+#import "_FBTweakOverrides.h"
+#import "_FBTweakVariable.h"
+#import "_FBTweakStore.h"
+
+BOOL _FBTweakFrozen = NO;
+
+NSString *const _FBTweakStoreDidRegisterTweaksNotification = @"_FBTweakStoreDidRegisterTweaksNotification";
+
+// Inline tweaks are persisted under identifiers with this prefix.
+static NSString *const _FBTweakStorePersistedIdentifierPrefix = @"FBTweak:";
+
+// When each orphaned value was first found, by identifier.
+static NSString *const _FBTweakStoreOrphanedSinceKey = @"FBTweakStoreOrphanedSince";
 
 @implementation FBTweakStore {
   NSMutableArray *_orderedCategories;
   NSMutableDictionary *_namedCategories;
+  dispatch_source_t _memoryPressureSource;
+  _FBTweakOverridesFile *_overridesFile;
+  BOOL _hasOrphanedValues;
 }
 
 + (instancetype)sharedInstance
@@ -47,49 +69,258 @@
   if ((self = [super init])) {
     _orderedCategories = [[NSMutableArray alloc] initWithCapacity:16];
     _namedCategories = [[NSMutableDictionary alloc] initWithCapacity:16];
+
+    __weak FBTweakStore *weakSelf = self;
+    _memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_main_queue());
+    dispatch_source_set_event_handler(_memoryPressureSource, ^{
+      [weakSelf _releaseCachedTweaks];
+    });
+    dispatch_resume(_memoryPressureSource);
   }
   
   return self;
 }
 
+- (void)dealloc
+{
+  dispatch_source_cancel(_memoryPressureSource);
+  [_overridesFile stop];
+}
+
 - (void)encodeWithCoder:(NSCoder *)coder
 {
   [coder encodeObject:_orderedCategories forKey:@"categories"];
 }
 
+// Locked, since images unloaded on other threads remove their tweaks there.
 - (NSArray *)tweakCategories
 {
-  return [_orderedCategories copy];
+  @synchronized (self) {
+    return [_orderedCategories copy];
+  }
 }
 
 - (FBTweakCategory *)tweakCategoryWithName:(NSString *)name
 {
-  return _namedCategories[name];
+  @synchronized (self) {
+    return _namedCategories[name];
+  }
 }
 
 - (void)addTweakCategory:(FBTweakCategory *)category
 {
-  [_namedCategories setObject:category forKey:category.name];
-  [_orderedCategories addObject:category];
+  @synchronized (self) {
+    [_namedCategories setObject:category forKey:category.name];
+    [_orderedCategories addObject:category];
+  }
 }
 
 - (void)removeTweakCategory:(FBTweakCategory *)category
 {
-  [_namedCategories removeObjectForKey:category.name];
-  [_orderedCategories removeObject:category];
+  @synchronized (self) {
+    [_namedCategories removeObjectForKey:category.name];
+    [_orderedCategories removeObject:category];
+  }
 }
 
 - (void)reset
+{
+  [self performBatchUpdates:^{
+    for (FBTweakCategory *category in self.tweakCategories) {
+      for (FBTweakCollection *collection in category.tweakCollections) {
+        for (FBTweak *tweak in collection.tweaks) {
+          if (!tweak.isAction) {
+            tweak.currentValue = nil;
+          }
+        }
+      }
+    }
+  }];
+}
+
+- (BOOL)isFrozen
+{
+  return _FBTweakIsFrozen();
+}
+
+- (void)setFrozen:(BOOL)frozen
+{
+  if (frozen == _FBTweakIsFrozen()) {
+    return;
+  }
+
+  __atomic_store_n(&_FBTweakFrozen, frozen, __ATOMIC_RELAXED);
+  [_FBTweakBindObserver updateAllObservers];
+  [FBTweak _storeAllBindings];
+}
+
+- (void)_releaseCachedTweaks
 {
   for (FBTweakCategory *category in self.tweakCategories) {
     for (FBTweakCollection *collection in category.tweakCollections) {
-      for (FBTweak *tweak in collection.tweaks) {
-        if (!tweak.isAction) {
-          tweak.currentValue = nil;
-        }
+      [collection _releaseCachedTweaks];
+    }
+  }
+}
+
+- (void)performBatchUpdates:(dispatch_block_t)updates
+{
+  NSParameterAssert(updates != NULL);
+
+  _FBTweakBatchBegin();
+  updates();
+  _FBTweakBatchEnd();
+}
+
++ (void)withOverrides:(dispatch_block_t)block
+{
+  NSParameterAssert(block != NULL);
+
+  _FBTweakOverridesPush();
+  block();
+  _FBTweakOverridesPop();
+}
+
+- (BOOL)watchOverridesFileAtPath:(NSString *)path error:(NSError **)error
+{
+  NSParameterAssert(path != nil);
+
+  [self stopWatchingOverridesFile];
+
+  _FBTweakOverridesFile *overridesFile = [[_FBTweakOverridesFile alloc] initWithPath:path store:self];
+  if (![overridesFile startWithError:error]) {
+    return NO;
+  }
+
+  _overridesFile = overridesFile;
+  return YES;
+}
+
+- (void)stopWatchingOverridesFile
+{
+  [_overridesFile stop];
+  _overridesFile = nil;
+}
+
+- (NSSet *)_registeredIdentifierHashes
+{
+  NSMutableSet *registeredHashes = [[NSMutableSet alloc] init];
+  for (FBTweakCategory *category in self.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      [collection _enumerateIdentifierHashesUsingBlock:^(uint64_t identifierHash) {
+        [registeredHashes addObject:@(identifierHash)];
+      }];
+    }
+  }
+  return registeredHashes;
+}
+
+- (void)_forgetRegisteredOrphanedValues
+{
+  // Nothing to do until compaction has found orphans, e.g. at launch.
+  if (!_hasOrphanedValues) {
+    return;
+  }
+
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  NSMutableDictionary *orphanedSince = [[defaults dictionaryForKey:_FBTweakStoreOrphanedSinceKey] mutableCopy];
+  NSSet *registeredHashes = [self _registeredIdentifierHashes];
+
+  NSMutableArray *registeredIdentifiers = [[NSMutableArray alloc] init];
+  for (NSString *identifier in orphanedSince) {
+    if ([identifier isKindOfClass:[NSString class]] && [registeredHashes containsObject:@(_FBTweakIdentifierHash(identifier))]) {
+      [registeredIdentifiers addObject:identifier];
+    }
+  }
+
+  if (registeredIdentifiers.count == 0) {
+    return;
+  }
+
+  [orphanedSince removeObjectsForKeys:registeredIdentifiers];
+  if (orphanedSince.count > 0) {
+    [defaults setObject:orphanedSince forKey:_FBTweakStoreOrphanedSinceKey];
+  } else {
+    [defaults removeObjectForKey:_FBTweakStoreOrphanedSinceKey];
+    _hasOrphanedValues = NO;
+  }
+}
+
+- (FBTweakCompactionReport *)compactPersistedValuesWithRetentionInterval:(NSTimeInterval)retentionInterval dryRun:(BOOL)dryRun
+{
+  NSParameterAssert(retentionInterval >= 0);
+
+  NSSet *registeredHashes = [self _registeredIdentifierHashes];
+
+  // Only the app's own domain is rewritten; fall back to everything
+  // visible, such as in test bundles without a bundle identifier.
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  NSString *domainName = [[NSBundle mainBundle] bundleIdentifier];
+  NSDictionary *persisted = (domainName != nil ? [defaults persistentDomainForName:domainName] : nil) ?: [defaults dictionaryRepresentation];
+
+  NSDictionary *previousOrphanedSince = persisted[_FBTweakStoreOrphanedSinceKey];
+  NSMutableDictionary *orphanedSince = [[NSMutableDictionary alloc] init];
+  NSMutableArray *removedIdentifiers = [[NSMutableArray alloc] init];
+  NSMutableArray *retainedIdentifiers = [[NSMutableArray alloc] init];
+  NSUInteger removedBytes = 0;
+  NSDate *now = [NSDate date];
+
+  for (NSString *identifier in persisted) {
+    if (![identifier isKindOfClass:[NSString class]] || ![identifier hasPrefix:_FBTweakStorePersistedIdentifierPrefix]) {
+      continue;
+    }
+
+    // A hash collision keeps a value it could have removed, never the reverse.
+    if ([registeredHashes containsObject:@(_FBTweakIdentifierHash(identifier))]) {
+      continue;
+    }
+
+    NSDate *since = previousOrphanedSince[identifier];
+    if (![since isKindOfClass:[NSDate class]]) {
+      since = now;
+    }
+
+    if ([now timeIntervalSinceDate:since] >= retentionInterval) {
+      [removedIdentifiers addObject:identifier];
+      id value = persisted[identifier];
+      if ([value isKindOfClass:[NSData class]]) {
+        removedBytes += [value length];
+      } else if ([value isKindOfClass:[NSString class]]) {
+        removedBytes += [value lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+      }
+    } else {
+      [retainedIdentifiers addObject:identifier];
+      orphanedSince[identifier] = since;
+    }
+  }
+
+  if (!dryRun) {
+    _hasOrphanedValues = (orphanedSince.count > 0);
+
+    NSMutableDictionary *domain = (domainName != nil ? [[defaults persistentDomainForName:domainName] mutableCopy] : nil);
+    if (domain != nil) {
+      [domain removeObjectsForKeys:removedIdentifiers];
+      if (orphanedSince.count > 0) {
+        domain[_FBTweakStoreOrphanedSinceKey] = orphanedSince;
+      } else {
+        [domain removeObjectForKey:_FBTweakStoreOrphanedSinceKey];
+      }
+      [defaults setPersistentDomain:domain forName:domainName];
+    } else {
+      for (NSString *identifier in removedIdentifiers) {
+        [defaults removeObjectForKey:identifier];
+      }
+      if (orphanedSince.count > 0) {
+        [defaults setObject:orphanedSince forKey:_FBTweakStoreOrphanedSinceKey];
+      } else {
+        [defaults removeObjectForKey:_FBTweakStoreOrphanedSinceKey];
       }
     }
   }
+
+  NSArray *sortedRemoved = [removedIdentifiers sortedArrayUsingSelector:@selector(compare:)];
+  NSArray *sortedRetained = [retainedIdentifiers sortedArrayUsingSelector:@selector(compare:)];
+  return [[FBTweakCompactionReport alloc] initWithRemovedIdentifiers:sortedRemoved retainedIdentifiers:sortedRetained removedBytes:removedBytes dryRun:dryRun];
 }
 
 @end
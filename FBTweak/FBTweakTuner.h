@@ -0,0 +1,132 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+@class FBTweakStore;
+
+/**
+  @abstract How a tuner chooses configurations to measure.
+ */
+typedef NS_ENUM(NSUInteger, FBTweakTunerStrategy) {
+  /** Measures every combination of evenly spaced values for each tweak. */
+  FBTweakTunerStrategyGrid,
+  /** Searches with the Nelder-Mead simplex method. Needs no derivatives. */
+  FBTweakTunerStrategyNelderMead,
+};
+
+/**
+  @abstract Reports the cost of the configuration being measured.
+  @param cost The measured cost. Lower is better.
+ */
+typedef void (^FBTweakTunerReportBlock)(double cost);
+
+/**
+  @abstract Measures the configuration currently applied to the tweaks.
+  @param report Call once, on any queue, when the measurement is done.
+  @discussion Called on the main queue. May report asynchronously, for
+    example after sampling frame times over several frames.
+ */
+typedef void (^FBTweakTunerMeasurementBlock)(FBTweakTunerReportBlock report);
+
+/**
+  @abstract One measured configuration.
+ */
+@interface FBTweakTunerResult : NSObject
+
+/**
+  @abstract The value of each tweak, keyed by identifier.
+ */
+@property (nonatomic, copy, readonly) NSDictionary *values;
+
+/**
+  @abstract The measured cost.
+ */
+@property (nonatomic, assign, readonly) double cost;
+
+@end
+
+/**
+  @abstract Called when tuning finishes.
+  @param best The lowest cost configuration, or nil if nothing was measured.
+  @param results Every measured configuration, in measurement order.
+ */
+typedef void (^FBTweakTunerCompletionBlock)(FBTweakTunerResult *best, NSArray *results);
+
+/**
+  @abstract Searches the ranges of numeric tweaks for the lowest cost.
+  @discussion Each candidate configuration is applied as one store batch
+    before it is measured. Tweaks must have an {@ref FBTweakNumericRange}
+    as their possible values. Integer tweaks are rounded. Tuning runs on
+    the main queue, yielding to the run loop between measurements.
+ */
+@interface FBTweakTuner : NSObject
+
+/**
+  @abstract Creates a tuner.
+  @discussion This is the designated initializer.
+  @param store The store the tweaks are in, used to batch changes.
+  @param tweaks The numeric tweaks to tune.
+ */
+- (instancetype)initWithStore:(FBTweakStore *)store tweaks:(NSArray *)tweaks;
+
+/**
+  @abstract The tweaks being tuned.
+ */
+@property (nonatomic, copy, readonly) NSArray *tweaks;
+
+/**
+  @abstract How configurations are chosen. Defaults to grid.
+ */
+@property (nonatomic, assign, readwrite) FBTweakTunerStrategy strategy;
+
+/**
+  @abstract For grid searches, the number of values tried for each tweak.
+  @discussion Defaults to 5. The grid has this many to the power of the
+    number of tweaks configurations.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger samplesPerTweak;
+
+/**
+  @abstract For Nelder-Mead, the most configurations to measure.
+  @discussion Defaults to 100.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger maximumMeasurements;
+
+/**
+  @abstract For Nelder-Mead, stops when costs across the simplex differ
+    by less than this. Defaults to 1e-4.
+ */
+@property (nonatomic, assign, readwrite) double tolerance;
+
+/**
+  @abstract If the original values are restored when tuning finishes.
+  @discussion Defaults to NO, which applies the best configuration.
+ */
+@property (nonatomic, assign, readwrite) BOOL restoresOriginalValues;
+
+/**
+  @abstract If tuning is in progress.
+ */
+@property (nonatomic, assign, readonly, getter = isRunning) BOOL running;
+
+/**
+  @abstract Starts tuning.
+  @param measurement Measures each candidate configuration.
+  @param completion Called on the main queue when tuning finishes or is cancelled.
+ */
+- (void)startWithMeasurement:(FBTweakTunerMeasurementBlock)measurement completion:(FBTweakTunerCompletionBlock)completion;
+
+/**
+  @abstract Stops tuning after the current measurement.
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,389 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "FBTweakTuner.h"
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+
+// Nelder-Mead coefficients: reflection, expansion, contraction and shrink.
+static const double _FBTweakTunerReflection = 1.0;
+static const double _FBTweakTunerExpansion = 2.0;
+static const double _FBTweakTunerContraction = 0.5;
+static const double _FBTweakTunerShrink = 0.5;
+
+// Size of the initial simplex, as a fraction of each range.
+static const double _FBTweakTunerInitialStep = 0.25;
+
+@interface FBTweakTunerResult ()
+
+- (instancetype)initWithValues:(NSDictionary *)values cost:(double)cost;
+
+@end
+
+@implementation FBTweakTunerResult
+
+- (instancetype)initWithValues:(NSDictionary *)values cost:(double)cost
+{
+  if ((self = [super init])) {
+    _values = [values copy];
+    _cost = cost;
+  }
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %p; cost = %f; values = %@>", [self class], self, _cost, _values];
+}
+
+@end
+
+@implementation FBTweakTuner {
+  FBTweakStore *_store;
+  NSArray *_originalValues;
+  FBTweakTunerMeasurementBlock _measurement;
+  FBTweakTunerCompletionBlock _completion;
+  NSMutableArray *_results;
+  FBTweakTunerResult *_best;
+  BOOL _cancelled;
+
+  // Nelder-Mead state. Points are in normalized coordinates, where each
+  // tweak's range maps to [0, 1].
+  NSMutableArray *_simplex;
+  NSMutableArray *_simplexCosts;
+}
+
+- (instancetype)initWithStore:(FBTweakStore *)store tweaks:(NSArray *)tweaks
+{
+  NSParameterAssert(store != nil);
+  NSParameterAssert(tweaks.count > 0);
+
+  if ((self = [super init])) {
+    _store = store;
+    _tweaks = [tweaks copy];
+    _strategy = FBTweakTunerStrategyGrid;
+    _samplesPerTweak = 5;
+    _maximumMeasurements = 100;
+    _tolerance = 1e-4;
+
+    for (FBTweak *tweak in _tweaks) {
+      NSAssert([tweak.possibleValues isKindOfClass:[FBTweakNumericRange class]], @"tweak %@ must have a numeric range", tweak.identifier);
+    }
+  }
+
+  return self;
+}
+
+#pragma mark Running
+
+- (void)startWithMeasurement:(FBTweakTunerMeasurementBlock)measurement completion:(FBTweakTunerCompletionBlock)completion
+{
+  NSParameterAssert(measurement != NULL);
+  NSAssert([NSThread isMainThread], @"tuning must start on the main thread");
+  NSAssert(!_running, @"tuner is already running");
+
+  NSMutableArray *originalValues = [[NSMutableArray alloc] initWithCapacity:_tweaks.count];
+  for (FBTweak *tweak in _tweaks) {
+    [originalValues addObject:(tweak.currentValue ?: [NSNull null])];
+  }
+
+  _originalValues = originalValues;
+  _measurement = [measurement copy];
+  _completion = [completion copy];
+  _results = [[NSMutableArray alloc] init];
+  _best = nil;
+  _cancelled = NO;
+  _running = YES;
+
+  dispatch_async(dispatch_get_main_queue(), ^{
+    if (_strategy == FBTweakTunerStrategyNelderMead) {
+      [self _startNelderMead];
+    } else {
+      [self _measureGridIndex:0];
+    }
+  });
+}
+
+- (void)cancel
+{
+  _cancelled = YES;
+}
+
+- (void)_finish
+{
+  NSArray *originalValues = _originalValues;
+  NSDictionary *bestValues = _best.values;
+  BOOL restore = (_restoresOriginalValues || bestValues == nil);
+
+  [_store performBatchUpdates:^{
+    [_tweaks enumerateObjectsUsingBlock:^(FBTweak *tweak, NSUInteger i, BOOL *stop) {
+      FBTweakValue value = (restore ? originalValues[i] : bestValues[tweak.identifier]);
+      tweak.currentValue = (value == [NSNull null] ? nil : value);
+    }];
+  }];
+
+  FBTweakTunerCompletionBlock completion = _completion;
+  FBTweakTunerResult *best = _best;
+  NSArray *results = [_results copy];
+
+  _measurement = nil;
+  _completion = nil;
+  _originalValues = nil;
+  _simplex = nil;
+  _simplexCosts = nil;
+  _running = NO;
+
+  if (completion != NULL) {
+    completion(best, results);
+  }
+}
+
+#pragma mark Measuring
+
+static double _FBTweakTunerClamp(double value)
+{
+  return MIN(MAX(value, 0.0), 1.0);
+}
+
+static BOOL _FBTweakTunerIsInteger(FBTweak *tweak)
+{
+  FBTweakValue value = tweak.defaultValue;
+  if (![value isKindOfClass:[NSNumber class]]) {
+    return NO;
+  }
+
+  const char *type = [value objCType];
+  return (strcmp(type, @encode(float)) != 0 && strcmp(type, @encode(double)) != 0);
+}
+
+- (NSDictionary *)_valuesForPoint:(NSArray *)point
+{
+  NSMutableDictionary *values = [[NSMutableDictionary alloc] initWithCapacity:_tweaks.count];
+  [_tweaks enumerateObjectsUsingBlock:^(FBTweak *tweak, NSUInteger i, BOOL *stop) {
+    double minimum = [tweak.minimumValue doubleValue];
+    double maximum = [tweak.maximumValue doubleValue];
+    double value = minimum + _FBTweakTunerClamp([point[i] doubleValue]) * (maximum - minimum);
+
+    if (_FBTweakTunerIsInteger(tweak)) {
+      values[tweak.identifier] = @((long long)llround(value));
+    } else {
+      values[tweak.identifier] = @(value);
+    }
+  }];
+  return values;
+}
+
+- (NSArray *)_pointForCurrentValues
+{
+  NSMutableArray *point = [[NSMutableArray alloc] initWithCapacity:_tweaks.count];
+  for (FBTweak *tweak in _tweaks) {
+    double minimum = [tweak.minimumValue doubleValue];
+    double maximum = [tweak.maximumValue doubleValue];
+    double value = [(tweak.currentValue ?: tweak.defaultValue) doubleValue];
+    [point addObject:@(maximum > minimum ? _FBTweakTunerClamp((value - minimum) / (maximum - minimum)) : 0.0)];
+  }
+  return point;
+}
+
+- (void)_measurePoint:(NSArray *)point then:(void (^)(double cost))next
+{
+  NSDictionary *values = [self _valuesForPoint:point];
+
+  [_store performBatchUpdates:^{
+    for (FBTweak *tweak in _tweaks) {
+      tweak.currentValue = values[tweak.identifier];
+    }
+  }];
+
+  __block BOOL reported = NO;
+  _measurement(^(double cost) {
+    dispatch_async(dispatch_get_main_queue(), ^{
+      NSAssert(!reported, @"measurement reported more than once");
+      reported = YES;
+
+      FBTweakTunerResult *result = [[FBTweakTunerResult alloc] initWithValues:values cost:cost];
+      [_results addObject:result];
+      if (_best == nil || cost < _best.cost) {
+        _best = result;
+      }
+
+      if (_cancelled) {
+        [self _finish];
+      } else {
+        next(cost);
+      }
+    });
+  });
+}
+
+#pragma mark Grid
+
+- (void)_measureGridIndex:(NSUInteger)index
+{
+  NSUInteger samples = MAX(_samplesPerTweak, (NSUInteger)1);
+  NSUInteger count = 1;
+  for (NSUInteger i = 0; i < _tweaks.count; i++) {
+    count *= samples;
+  }
+
+  if (index >= count) {
+    [self _finish];
+    return;
+  }
+
+  // Treat the index as a number in base samples, one digit per tweak.
+  NSMutableArray *point = [[NSMutableArray alloc] initWithCapacity:_tweaks.count];
+  NSUInteger remainder = index;
+  for (NSUInteger i = 0; i < _tweaks.count; i++) {
+    NSUInteger digit = remainder % samples;
+    remainder /= samples;
+    [point addObject:@(samples > 1 ? (double)digit / (samples - 1) : 0.5)];
+  }
+
+  [self _measurePoint:point then:^(double cost) {
+    [self _measureGridIndex:index + 1];
+  }];
+}
+
+#pragma mark Nelder-Mead
+
+static NSArray *_FBTweakTunerCombine(NSArray *origin, NSArray *toward, double scale)
+{
+  NSMutableArray *point = [[NSMutableArray alloc] initWithCapacity:origin.count];
+  for (NSUInteger i = 0; i < origin.count; i++) {
+    double o = [origin[i] doubleValue];
+    [point addObject:@(_FBTweakTunerClamp(o + scale * ([toward[i] doubleValue] - o)))];
+  }
+  return point;
+}
+
+- (void)_startNelderMead
+{
+  NSArray *start = [self _pointForCurrentValues];
+
+  _simplex = [[NSMutableArray alloc] initWithObjects:start, nil];
+  for (NSUInteger i = 0; i < start.count; i++) {
+    NSMutableArray *vertex = [start mutableCopy];
+    double value = [start[i] doubleValue];
+    vertex[i] = @(value + _FBTweakTunerInitialStep <= 1.0 ? value + _FBTweakTunerInitialStep : value - _FBTweakTunerInitialStep);
+    [_simplex addObject:vertex];
+  }
+
+  _simplexCosts = [[NSMutableArray alloc] init];
+  for (NSUInteger i = 0; i < _simplex.count; i++) {
+    [_simplexCosts addObject:@(INFINITY)];
+  }
+
+  [self _measureSimplexVertex:0];
+}
+
+- (void)_measureSimplexVertex:(NSUInteger)index
+{
+  if (index >= _simplex.count) {
+    [self _iterateNelderMead];
+    return;
+  }
+
+  if (_results.count >= _maximumMeasurements) {
+    [self _finish];
+    return;
+  }
+
+  [self _measurePoint:_simplex[index] then:^(double cost) {
+    _simplexCosts[index] = @(cost);
+    [self _measureSimplexVertex:index + 1];
+  }];
+}
+
+- (void)_iterateNelderMead
+{
+  // Order vertices from best to worst.
+  NSMutableArray *indexes = [[NSMutableArray alloc] initWithCapacity:_simplex.count];
+  for (NSUInteger i = 0; i < _simplex.count; i++) {
+    [indexes addObject:@(i)];
+  }
+  [indexes sortUsingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+    return [_simplexCosts[[a unsignedIntegerValue]] compare:_simplexCosts[[b unsignedIntegerValue]]];
+  }];
+
+  NSMutableArray *simplex = [[NSMutableArray alloc] initWithCapacity:_simplex.count];
+  NSMutableArray *costs = [[NSMutableArray alloc] initWithCapacity:_simplex.count];
+  for (NSNumber *index in indexes) {
+    [simplex addObject:_simplex[[index unsignedIntegerValue]]];
+    [costs addObject:_simplexCosts[[index unsignedIntegerValue]]];
+  }
+  _simplex = simplex;
+  _simplexCosts = costs;
+
+  NSUInteger worst = _simplex.count - 1;
+  double bestCost = [_simplexCosts[0] doubleValue];
+  double secondWorstCost = [_simplexCosts[worst - 1] doubleValue];
+  double worstCost = [_simplexCosts[worst] doubleValue];
+
+  if (_results.count >= _maximumMeasurements || worstCost - bestCost < _tolerance) {
+    [self _finish];
+    return;
+  }
+
+  // Centroid of every vertex but the worst.
+  NSUInteger dimensions = _tweaks.count;
+  NSMutableArray *centroid = [[NSMutableArray alloc] initWithCapacity:dimensions];
+  for (NSUInteger d = 0; d < dimensions; d++) {
+    double sum = 0.0;
+    for (NSUInteger v = 0; v < worst; v++) {
+      sum += [_simplex[v][d] doubleValue];
+    }
+    [centroid addObject:@(sum / worst)];
+  }
+
+  NSArray *worstPoint = _simplex[worst];
+  NSArray *reflected = _FBTweakTunerCombine(centroid, worstPoint, -_FBTweakTunerReflection);
+
+  [self _measurePoint:reflected then:^(double reflectedCost) {
+    if (reflectedCost < bestCost) {
+      NSArray *expanded = _FBTweakTunerCombine(centroid, reflected, _FBTweakTunerExpansion);
+      [self _measurePoint:expanded then:^(double expandedCost) {
+        BOOL expand = (expandedCost < reflectedCost);
+        [self _replaceWorstWithPoint:(expand ? expanded : reflected) cost:(expand ? expandedCost : reflectedCost)];
+      }];
+    } else if (reflectedCost < secondWorstCost) {
+      [self _replaceWorstWithPoint:reflected cost:reflectedCost];
+    } else {
+      NSArray *contracted = _FBTweakTunerCombine(centroid, worstPoint, _FBTweakTunerContraction);
+      [self _measurePoint:contracted then:^(double contractedCost) {
+        if (contractedCost < worstCost) {
+          [self _replaceWorstWithPoint:contracted cost:contractedCost];
+        } else {
+          [self _shrinkSimplex];
+        }
+      }];
+    }
+  }];
+}
+
+- (void)_replaceWorstWithPoint:(NSArray *)point cost:(double)cost
+{
+  NSUInteger worst = _simplex.count - 1;
+  _simplex[worst] = point;
+  _simplexCosts[worst] = @(cost);
+  [self _iterateNelderMead];
+}
+
+- (void)_shrinkSimplex
+{
+  NSArray *best = _simplex[0];
+  for (NSUInteger i = 1; i < _simplex.count; i++) {
+    _simplex[i] = _FBTweakTunerCombine(best, _simplex[i], _FBTweakTunerShrink);
+  }
+
+  [self _measureSimplexVertex:1];
+}
+
+@end
@@ -13,6 +13,7 @@
 
 /**
   @abstract Displays list of values in an array tweak.
+  @discussion Values are read a page at a time as rows scroll into view.
  */
 @interface _FBTweakArrayViewController : UIViewController
 
@@ -20,7 +21,7 @@
   @abstract Creates a tweak array view controller.
   @discussion This is the designated initializer.
   @param tweak The tweak the view controller is for.
-    Must not be nil, and must have an array of possibleValues.
+    Must not be nil, and must have an array or a provider of possibleValues.
  */
 - (instancetype)initWithTweak:(FBTweak *)tweak;
 
@@ -9,6 +9,7 @@
 
 #import "_FBTweakArrayViewController.h"
 #import "FBTweak.h"
+#import "_FBTweakPossibleValues.h"
 
 @interface _FBTweakArrayViewController () <UITableViewDataSource, UITableViewDelegate>
 
@@ -16,15 +17,18 @@
 
 @implementation _FBTweakArrayViewController {
   UITableView *_tableView;
+  _FBTweakPossibleValuesPager *_pager;
 }
 
 - (instancetype)initWithTweak:(FBTweak *)tweak
 {
   NSParameterAssert(tweak != nil);
-  NSParameterAssert([tweak.possibleValues isKindOfClass:[NSArray class]]);
+  NSParameterAssert([tweak.possibleValues isKindOfClass:[NSArray class]] ||
+                    [tweak.possibleValues conformsToProtocol:@protocol(FBTweakPossibleValuesProvider)]);
 
   if ((self = [super init])) {
     _tweak = tweak;
+    _pager = [[_FBTweakPossibleValuesPager alloc] initWithProvider:_FBTweakPossibleValuesProvider(tweak.possibleValues)];
     self.title = _tweak.name;
   }
 
@@ -55,7 +59,7 @@
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
-  return [self.tweak.possibleValues count];
+  return _pager.count;
 }
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
@@ -66,9 +70,8 @@
     cell = [[UITableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:_FBTweakDictionaryViewControllerCellIdentifier];
   }
 
-  FBTweakValue rowValue = self.tweak.possibleValues[indexPath.row];
-  NSString *stringValue = [rowValue description];
-  cell.textLabel.text = stringValue;
+  FBTweakValue rowValue = [_pager valueAtIndex:indexPath.row];
+  cell.textLabel.text = [_pager titleAtIndex:indexPath.row];
 
   cell.accessoryType = UITableViewCellAccessoryNone;
   FBTweakValue selectedValue = (self.tweak.currentValue ?: self.tweak.defaultValue);
@@ -81,7 +84,7 @@
 
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
-  NSString *value = self.tweak.possibleValues[indexPath.row];
+  FBTweakValue value = [_pager valueAtIndex:indexPath.row];
   self.tweak.currentValue = value;
   [self.navigationController popViewControllerAnimated:YES];
 }
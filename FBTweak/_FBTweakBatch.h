@@ -0,0 +1,46 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+ 
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+
+/**
+  @abstract Begins a batch of tweak changes on the current thread.
+  @discussion Batches nest. This is an implementation detail of
+    {@ref -[FBTweakStore performBatchUpdates:]}.
+ */
+extern void _FBTweakBatchBegin(void);
+
+/**
+  @abstract Ends a batch of tweak changes on the current thread.
+  @discussion When the outermost batch ends, each changed tweak
+    notifies its observers once, in the order it first changed.
+ */
+extern void _FBTweakBatchEnd(void);
+
+/**
+  @abstract If a batch is in progress on the current thread.
+ */
+extern BOOL _FBTweakBatchIsActive(void);
+
+/**
+  @abstract Defers change notification for a tweak to the end of the batch.
+  @return YES if the tweak was not already waiting to notify in this batch.
+ */
+extern BOOL _FBTweakBatchEnqueueTweak(FBTweak *tweak);
+
+@interface FBTweak (Batch)
+
+/**
+  @abstract Notifies observers that a batched change has been committed.
+ */
+- (void)_notifyObserversDidChange;
+
+@end
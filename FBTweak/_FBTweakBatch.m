@@ -0,0 +1,67 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+ 
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakBatch.h"
+#import "FBTweak.h"
+
+static NSString *const _FBTweakBatchPendingKey = @"_FBTweakBatchPending";
+
+static __thread NSUInteger _FBTweakBatchDepth = 0;
+
+static NSMutableOrderedSet *_FBTweakBatchPendingTweaks(BOOL create)
+{
+  NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+  NSMutableOrderedSet *pending = threadDictionary[_FBTweakBatchPendingKey];
+  if (pending == nil && create) {
+    pending = [[NSMutableOrderedSet alloc] init];
+    threadDictionary[_FBTweakBatchPendingKey] = pending;
+  }
+  return pending;
+}
+
+void _FBTweakBatchBegin(void)
+{
+  _FBTweakBatchDepth++;
+}
+
+void _FBTweakBatchEnd(void)
+{
+  NSCAssert(_FBTweakBatchDepth > 0, @"unbalanced batch end");
+  if (--_FBTweakBatchDepth > 0) {
+    return;
+  }
+
+  NSMutableOrderedSet *pending = _FBTweakBatchPendingTweaks(NO);
+  if (pending.count == 0) {
+    return;
+  }
+
+  // Observers may start a new batch, so detach the pending set first.
+  [[[NSThread currentThread] threadDictionary] removeObjectForKey:_FBTweakBatchPendingKey];
+
+  for (FBTweak *tweak in pending) {
+    [tweak _notifyObserversDidChange];
+  }
+}
+
+BOOL _FBTweakBatchIsActive(void)
+{
+  return (_FBTweakBatchDepth > 0);
+}
+
+BOOL _FBTweakBatchEnqueueTweak(FBTweak *tweak)
+{
+  NSMutableOrderedSet *pending = _FBTweakBatchPendingTweaks(YES);
+  if ([pending containsObject:tweak]) {
+    return NO;
+  }
+
+  [pending addObject:tweak];
+  return YES;
+}
@@ -0,0 +1,79 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+ 
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+/**
+  @abstract The type tag that starts each encoded value.
+  @discussion Multi-byte fields are little-endian. Strings are a
+    uint32 byte count followed by that many bytes of UTF-8.
+ */
+typedef NS_ENUM(uint8_t, _FBTweakBinaryValueType) {
+  /** No value. No payload. */
+  _FBTweakBinaryValueTypeNil = 0,
+  /** A boolean. One byte, 0 or 1. */
+  _FBTweakBinaryValueTypeBool = 1,
+  /** A signed integer. Eight bytes. */
+  _FBTweakBinaryValueTypeInteger = 2,
+  /** A floating point number. Eight byte IEEE 754 double. */
+  _FBTweakBinaryValueTypeDouble = 3,
+  /** A string. */
+  _FBTweakBinaryValueTypeString = 4,
+  /** A color. Four IEEE 754 floats, red, green, blue and alpha. */
+  _FBTweakBinaryValueTypeColor = 5,
+};
+
+extern void _FBTweakBinaryAppendUInt8(NSMutableData *data, uint8_t value);
+extern void _FBTweakBinaryAppendUInt32(NSMutableData *data, uint32_t value);
+extern void _FBTweakBinaryAppendUInt64(NSMutableData *data, uint64_t value);
+extern void _FBTweakBinaryAppendString(NSMutableData *data, NSString *string);
+
+/**
+  @abstract Appends a tagged value.
+  @discussion Values that aren't numbers, strings or colors are written as nil.
+ */
+extern void _FBTweakBinaryAppendValue(NSMutableData *data, FBTweakValue value);
+
+/**
+  @abstract Reads from a buffer of encoded data.
+  @discussion Reading past the end sets failed and returns zero values;
+    check failed once after reading a complete message.
+ */
+typedef struct {
+  const uint8_t *bytes;
+  NSUInteger length;
+  NSUInteger offset;
+  BOOL failed;
+} _FBTweakBinaryReader;
+
+extern _FBTweakBinaryReader _FBTweakBinaryReaderMake(const void *bytes, NSUInteger length);
+extern uint8_t _FBTweakBinaryReadUInt8(_FBTweakBinaryReader *reader);
+extern uint32_t _FBTweakBinaryReadUInt32(_FBTweakBinaryReader *reader);
+extern uint64_t _FBTweakBinaryReadUInt64(_FBTweakBinaryReader *reader);
+extern NSString *_FBTweakBinaryReadString(_FBTweakBinaryReader *reader);
+extern FBTweakValue _FBTweakBinaryReadValue(_FBTweakBinaryReader *reader);
+
+/**
+  @abstract Encodes a value into a fixed-size buffer, without allocating.
+  @param value The value to encode. Nil is encoded as the nil type.
+  @param type On output, the value's type.
+  @param payload The buffer to encode into. Must hold at least 16 bytes.
+  @param payloadSize The size of the buffer.
+  @param length On output, the string length in bytes. Zero for other types.
+  @return NO if the value isn't a supported type or is a string longer
+    than the buffer; the buffer then holds as much of the string as fits.
+ */
+extern BOOL _FBTweakBinaryEncodeFixedValue(FBTweakValue value, _FBTweakBinaryValueType *type, uint8_t *payload, size_t payloadSize, size_t *length);
+
+/**
+  @abstract Decodes a value encoded by {@ref _FBTweakBinaryEncodeFixedValue}.
+ */
+extern FBTweakValue _FBTweakBinaryDecodeFixedValue(_FBTweakBinaryValueType type, const uint8_t *payload, size_t length);
@@ -0,0 +1,242 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+ 
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakBinaryCoding.h"
+
+#import <UIKit/UIKit.h>
+#import <libkern/OSByteOrder.h>
+
+void _FBTweakBinaryAppendUInt8(NSMutableData *data, uint8_t value)
+{
+  [data appendBytes:&value length:sizeof(value)];
+}
+
+void _FBTweakBinaryAppendUInt32(NSMutableData *data, uint32_t value)
+{
+  uint32_t littleValue = OSSwapHostToLittleInt32(value);
+  [data appendBytes:&littleValue length:sizeof(littleValue)];
+}
+
+void _FBTweakBinaryAppendUInt64(NSMutableData *data, uint64_t value)
+{
+  uint64_t littleValue = OSSwapHostToLittleInt64(value);
+  [data appendBytes:&littleValue length:sizeof(littleValue)];
+}
+
+void _FBTweakBinaryAppendString(NSMutableData *data, NSString *string)
+{
+  const char *utf8 = [string UTF8String] ?: "";
+  uint32_t length = (uint32_t)strlen(utf8);
+  _FBTweakBinaryAppendUInt32(data, length);
+  [data appendBytes:utf8 length:length];
+}
+
+static void _FBTweakBinaryAppendFloat(NSMutableData *data, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  _FBTweakBinaryAppendUInt32(data, bits);
+}
+
+void _FBTweakBinaryAppendValue(NSMutableData *data, FBTweakValue value)
+{
+  if ([value isKindOfClass:[NSNumber class]]) {
+    const char *type = [value objCType];
+    if (CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID() || strcmp(type, @encode(BOOL)) == 0) {
+      _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeBool);
+      _FBTweakBinaryAppendUInt8(data, [value boolValue] ? 1 : 0);
+    } else if (strcmp(type, @encode(float)) == 0 || strcmp(type, @encode(double)) == 0) {
+      double doubleValue = [value doubleValue];
+      uint64_t bits;
+      memcpy(&bits, &doubleValue, sizeof(bits));
+      _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeDouble);
+      _FBTweakBinaryAppendUInt64(data, bits);
+    } else {
+      _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeInteger);
+      _FBTweakBinaryAppendUInt64(data, (uint64_t)[value longLongValue]);
+    }
+  } else if ([value isKindOfClass:[NSString class]]) {
+    _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeString);
+    _FBTweakBinaryAppendString(data, value);
+  } else if ([value isKindOfClass:[UIColor class]]) {
+    CGFloat red = 0, green = 0, blue = 0, alpha = 0;
+    [(UIColor *)value getRed:&red green:&green blue:&blue alpha:&alpha];
+    _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeColor);
+    _FBTweakBinaryAppendFloat(data, red);
+    _FBTweakBinaryAppendFloat(data, green);
+    _FBTweakBinaryAppendFloat(data, blue);
+    _FBTweakBinaryAppendFloat(data, alpha);
+  } else {
+    _FBTweakBinaryAppendUInt8(data, _FBTweakBinaryValueTypeNil);
+  }
+}
+
+_FBTweakBinaryReader _FBTweakBinaryReaderMake(const void *bytes, NSUInteger length)
+{
+  _FBTweakBinaryReader reader = { bytes, length, 0, NO };
+  return reader;
+}
+
+static const uint8_t *_FBTweakBinaryReadBytes(_FBTweakBinaryReader *reader, NSUInteger length)
+{
+  if (reader->failed || reader->length - reader->offset < length) {
+    reader->failed = YES;
+    return NULL;
+  }
+
+  const uint8_t *bytes = reader->bytes + reader->offset;
+  reader->offset += length;
+  return bytes;
+}
+
+uint8_t _FBTweakBinaryReadUInt8(_FBTweakBinaryReader *reader)
+{
+  const uint8_t *bytes = _FBTweakBinaryReadBytes(reader, sizeof(uint8_t));
+  return (bytes != NULL ? *bytes : 0);
+}
+
+uint32_t _FBTweakBinaryReadUInt32(_FBTweakBinaryReader *reader)
+{
+  const uint8_t *bytes = _FBTweakBinaryReadBytes(reader, sizeof(uint32_t));
+  return (bytes != NULL ? OSReadLittleInt32(bytes, 0) : 0);
+}
+
+uint64_t _FBTweakBinaryReadUInt64(_FBTweakBinaryReader *reader)
+{
+  const uint8_t *bytes = _FBTweakBinaryReadBytes(reader, sizeof(uint64_t));
+  return (bytes != NULL ? OSReadLittleInt64(bytes, 0) : 0);
+}
+
+NSString *_FBTweakBinaryReadString(_FBTweakBinaryReader *reader)
+{
+  uint32_t length = _FBTweakBinaryReadUInt32(reader);
+  const uint8_t *bytes = _FBTweakBinaryReadBytes(reader, length);
+  if (bytes == NULL) {
+    return nil;
+  }
+
+  return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+}
+
+static float _FBTweakBinaryReadFloat(_FBTweakBinaryReader *reader)
+{
+  uint32_t bits = _FBTweakBinaryReadUInt32(reader);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+FBTweakValue _FBTweakBinaryReadValue(_FBTweakBinaryReader *reader)
+{
+  _FBTweakBinaryValueType type = _FBTweakBinaryReadUInt8(reader);
+  FBTweakValue value = nil;
+
+  switch (type) {
+    case _FBTweakBinaryValueTypeNil:
+      break;
+    case _FBTweakBinaryValueTypeBool:
+      value = @(_FBTweakBinaryReadUInt8(reader) != 0 ? YES : NO);
+      break;
+    case _FBTweakBinaryValueTypeInteger:
+      value = @((long long)_FBTweakBinaryReadUInt64(reader));
+      break;
+    case _FBTweakBinaryValueTypeDouble: {
+      uint64_t bits = _FBTweakBinaryReadUInt64(reader);
+      double doubleValue;
+      memcpy(&doubleValue, &bits, sizeof(doubleValue));
+      value = @(doubleValue);
+      break;
+    }
+    case _FBTweakBinaryValueTypeString:
+      value = _FBTweakBinaryReadString(reader);
+      break;
+    case _FBTweakBinaryValueTypeColor: {
+      float red = _FBTweakBinaryReadFloat(reader);
+      float green = _FBTweakBinaryReadFloat(reader);
+      float blue = _FBTweakBinaryReadFloat(reader);
+      float alpha = _FBTweakBinaryReadFloat(reader);
+      value = [UIColor colorWithRed:red green:green blue:blue alpha:alpha];
+      break;
+    }
+    default:
+      reader->failed = YES;
+      break;
+  }
+
+  return (reader->failed ? nil : value);
+}
+
+BOOL _FBTweakBinaryEncodeFixedValue(FBTweakValue value, _FBTweakBinaryValueType *type, uint8_t *payload, size_t payloadSize, size_t *length)
+{
+  memset(payload, 0, payloadSize);
+  *type = _FBTweakBinaryValueTypeNil;
+  *length = 0;
+
+  if (value == nil) {
+    return YES;
+  } else if ([value isKindOfClass:[NSNumber class]]) {
+    const char *objCType = [value objCType];
+    if (CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID() || strcmp(objCType, @encode(BOOL)) == 0) {
+      *type = _FBTweakBinaryValueTypeBool;
+      payload[0] = [value boolValue];
+    } else if (strcmp(objCType, @encode(float)) == 0 || strcmp(objCType, @encode(double)) == 0) {
+      double doubleValue = [value doubleValue];
+      *type = _FBTweakBinaryValueTypeDouble;
+      memcpy(payload, &doubleValue, sizeof(doubleValue));
+    } else {
+      long long integerValue = [value longLongValue];
+      *type = _FBTweakBinaryValueTypeInteger;
+      memcpy(payload, &integerValue, sizeof(integerValue));
+    }
+    return YES;
+  } else if ([value isKindOfClass:[NSString class]]) {
+    const char *utf8 = [value UTF8String];
+    size_t utf8Length = strlen(utf8);
+    *type = _FBTweakBinaryValueTypeString;
+    *length = MIN(utf8Length, payloadSize);
+    memcpy(payload, utf8, *length);
+    return (utf8Length <= payloadSize);
+  } else if ([value isKindOfClass:[UIColor class]]) {
+    CGFloat red = 0, green = 0, blue = 0, alpha = 0;
+    [(UIColor *)value getRed:&red green:&green blue:&blue alpha:&alpha];
+    float components[4] = { red, green, blue, alpha };
+    *type = _FBTweakBinaryValueTypeColor;
+    memcpy(payload, components, sizeof(components));
+    return YES;
+  } else {
+    return NO;
+  }
+}
+
+FBTweakValue _FBTweakBinaryDecodeFixedValue(_FBTweakBinaryValueType type, const uint8_t *payload, size_t length)
+{
+  switch (type) {
+    case _FBTweakBinaryValueTypeBool:
+      return @(payload[0] ? YES : NO);
+    case _FBTweakBinaryValueTypeInteger: {
+      long long integerValue;
+      memcpy(&integerValue, payload, sizeof(integerValue));
+      return @(integerValue);
+    }
+    case _FBTweakBinaryValueTypeDouble: {
+      double doubleValue;
+      memcpy(&doubleValue, payload, sizeof(doubleValue));
+      return @(doubleValue);
+    }
+    case _FBTweakBinaryValueTypeString:
+      return [[NSString alloc] initWithBytes:payload length:length encoding:NSUTF8StringEncoding];
+    case _FBTweakBinaryValueTypeColor: {
+      float components[4];
+      memcpy(components, payload, sizeof(components));
+      return [UIColor colorWithRed:components[0] green:components[1] blue:components[2] alpha:components[3]];
+    }
+    default:
+      return nil;
+  }
+}
@@ -26,10 +26,12 @@ typedef void (^_FBTweakBindObserverBlock)(id object);
 /**
   @abstract Designated initializer.
   @param tweak The tweak to observe.
+  @param file The source file the bind is in, for profiling.
+  @param line The line the bind is on, for profiling.
   @param block The block to call on change.
   @return A new bind observer.
 */
-- (instancetype)initWithTweak:(FBTweak *)tweak block:(_FBTweakBindObserverBlock)block;
+- (instancetype)initWithTweak:(FBTweak *)tweak file:(const char *)file line:(int)line block:(_FBTweakBindObserverBlock)block;
 
 /**
   @abstract Attaches to an object and deallocates with it.
@@ -37,4 +39,11 @@ typedef void (^_FBTweakBindObserverBlock)(id object);
  */
 - (void)attachToObject:(id)object;
 
+/**
+  @abstract Updates the objects of all bind observers.
+  @discussion Used when tweaks are frozen or thawed, as while frozen
+    observers ignore changes and bound properties have their defaults.
+ */
++ (void)updateAllObservers;
+
 @end
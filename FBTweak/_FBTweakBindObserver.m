@@ -11,17 +11,32 @@
 
 #import "FBTweak.h"
 #import "_FBTweakBindObserver.h"
+#import "_FBTweakFrozen.h"
+#import "_FBTweakObserverProfiler.h"
 
-@interface _FBTweakBindObserver () <FBTweakObserver>
+@interface _FBTweakBindObserver () <FBTweakObserver, _FBTweakObserverProfiling>
 @end
 
 @implementation _FBTweakBindObserver {
   FBTweak *_tweak;
   _FBTweakBindObserverBlock _block;
   __weak id _object;
+  const char *_file;
+  int _line;
 }
 
-- (instancetype)initWithTweak:(FBTweak *)tweak block:(_FBTweakBindObserverBlock)block
+// Every bind observer, so they can be updated when tweaks are frozen.
+static NSHashTable *_FBTweakBindObservers(void)
+{
+  static NSHashTable *observers = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    observers = [NSHashTable weakObjectsHashTable];
+  });
+  return observers;
+}
+
+- (instancetype)initWithTweak:(FBTweak *)tweak file:(const char *)file line:(int)line block:(_FBTweakBindObserverBlock)block
 {
   if ((self = [super init])) {
     NSAssert(tweak != nil, @"tweak is required");
@@ -29,14 +44,36 @@
     
     _tweak = tweak;
     _block = block;
+    _file = file;
+    _line = line;
     
     [tweak addObserver:self];
+
+    @synchronized (_FBTweakBindObservers()) {
+      [_FBTweakBindObservers() addObject:self];
+    }
   }
   
   return self;
 }
 
 - (void)tweakDidChange:(FBTweak *)tweak
+{
+  if (_FBTweakIsFrozen()) {
+    return;
+  }
+
+  [self _update];
+}
+
+- (NSString *)_profileName
+{
+  // Each bind is its own profile, as the work it does is up to the caller.
+  NSString *file = (_file != NULL ? [@(_file) lastPathComponent] : @"?");
+  return [NSString stringWithFormat:@"FBTweakBind %@:%d", file, _line];
+}
+
+- (void)_update
 {
   __attribute__((objc_precise_lifetime)) id strongObject = _object;
   
@@ -54,4 +91,16 @@
   objc_setAssociatedObject(object, (__bridge void *)self, self, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
++ (void)updateAllObservers
+{
+  NSArray *observers = nil;
+  @synchronized (_FBTweakBindObservers()) {
+    observers = [_FBTweakBindObservers() allObjects];
+  }
+
+  for (_FBTweakBindObserver *observer in observers) {
+    [observer _update];
+  }
+}
+
 @end
@@ -0,0 +1,43 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+#import "FBTweakC.h"
+
+/**
+  @abstract The default value a C handle was declared with, boxed.
+ */
+extern FBTweakValue _FBTweakCHandleDefaultValue(const fb_tweak_c_handle_header *handle);
+
+/**
+  @abstract The range a C handle was declared with, or nil if none.
+ */
+extern FBTweakNumericRange *_FBTweakCHandlePossibleValues(const fb_tweak_c_handle_header *handle);
+
+/**
+  @abstract Stores a tweak's current value in a C handle.
+  @param value The value, or nil to store the handle's default.
+ */
+extern void _FBTweakCHandleStore(fb_tweak_c_handle_header *handle, FBTweakValue value);
+
+@interface FBTweak (CHandle)
+
+/**
+  @abstract Keeps a C handle up to date with the tweak's current value.
+ */
+- (void)_attachCHandle:(fb_tweak_c_handle_header *)handle;
+
+/**
+  @abstract Stops updating a C handle, as when its image is unloaded.
+ */
+- (void)_detachCHandle:(fb_tweak_c_handle_header *)handle;
+
+@end
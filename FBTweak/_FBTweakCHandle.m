@@ -0,0 +1,76 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakCHandle.h"
+
+FBTweakValue _FBTweakCHandleDefaultValue(const fb_tweak_c_handle_header *handle)
+{
+  switch ((fb_tweak_c_type)handle->type) {
+    case fb_tweak_c_type_bool:
+      return @(((const fb_tweak_bool_handle *)handle)->default_value ? YES : NO);
+    case fb_tweak_c_type_integer:
+      return @(((const fb_tweak_integer_handle *)handle)->default_value);
+    case fb_tweak_c_type_double:
+      return @(((const fb_tweak_double_handle *)handle)->default_value);
+  }
+
+  NSCAssert(NO, @"Unknown C tweak type %u.", handle->type);
+  return nil;
+}
+
+FBTweakNumericRange *_FBTweakCHandlePossibleValues(const fb_tweak_c_handle_header *handle)
+{
+  if (!handle->has_range) {
+    return nil;
+  }
+
+  switch ((fb_tweak_c_type)handle->type) {
+    case fb_tweak_c_type_integer: {
+      const fb_tweak_integer_handle *integer = (const fb_tweak_integer_handle *)handle;
+      return [[FBTweakNumericRange alloc] initWithMinimumValue:@(integer->minimum_value) maximumValue:@(integer->maximum_value)];
+    }
+    case fb_tweak_c_type_double: {
+      const fb_tweak_double_handle *value = (const fb_tweak_double_handle *)handle;
+      return [[FBTweakNumericRange alloc] initWithMinimumValue:@(value->minimum_value) maximumValue:@(value->maximum_value)];
+    }
+    case fb_tweak_c_type_bool:
+      return nil;
+  }
+
+  return nil;
+}
+
+void _FBTweakCHandleStore(fb_tweak_c_handle_header *handle, FBTweakValue value)
+{
+  // Values of another type, like a string written over a number, read as
+  // the handle's default.
+  BOOL numeric = [value isKindOfClass:[NSNumber class]];
+
+  switch ((fb_tweak_c_type)handle->type) {
+    case fb_tweak_c_type_bool: {
+      fb_tweak_bool_handle *typed = (fb_tweak_bool_handle *)handle;
+      __atomic_store_n(&typed->value, (bool)(numeric ? [value boolValue] : typed->default_value), __ATOMIC_RELEASE);
+      break;
+    }
+    case fb_tweak_c_type_integer: {
+      fb_tweak_integer_handle *typed = (fb_tweak_integer_handle *)handle;
+      __atomic_store_n(&typed->value, (int64_t)(numeric ? [value longLongValue] : typed->default_value), __ATOMIC_RELEASE);
+      break;
+    }
+    case fb_tweak_c_type_double: {
+      fb_tweak_double_handle *typed = (fb_tweak_double_handle *)handle;
+      // Stored as bits, so the write is a single integer store.
+      double doubleValue = (numeric ? [value doubleValue] : typed->default_value);
+      uint64_t bits;
+      memcpy(&bits, &doubleValue, sizeof(bits));
+      __atomic_store_n((uint64_t *)&typed->value, bits, __ATOMIC_RELEASE);
+      break;
+    }
+  }
+}
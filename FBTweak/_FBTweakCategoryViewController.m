@@ -9,7 +9,9 @@
 
 #import "FBTweakStore.h"
 #import "FBTweakCategory.h"
+#import "FBTweakObserverProfiler.h"
 #import "_FBTweakCategoryViewController.h"
+#import "_FBTweakObserverProfilerViewController.h"
 #import <MessageUI/MessageUI.h>
 
 @interface _FBTweakCategoryViewController () <UITableViewDataSource, UITableViewDelegate, MFMailComposeViewControllerDelegate>
@@ -69,11 +71,15 @@
   self.navigationItem.leftBarButtonItem = [[UIBarButtonItem alloc] initWithTitle:@"Reset" style:UIBarButtonItemStylePlain target:self action:@selector(_reset)];
   self.navigationItem.rightBarButtonItem = [[UIBarButtonItem alloc] initWithBarButtonSystemItem:UIBarButtonSystemItemDone target:self action:@selector(_done)];
   
+  UIBarButtonItem *observersItem = [[UIBarButtonItem alloc] initWithTitle:@"Observers" style:UIBarButtonItemStylePlain target:self action:@selector(_showObservers)];
+  UIBarButtonItem *flexibleSpaceItem = [[UIBarButtonItem alloc] initWithBarButtonSystemItem:UIBarButtonSystemItemFlexibleSpace target:nil action:nil];
+
   if ([MFMailComposeViewController canSendMail]) {
     UIBarButtonItem *exportItem = [[UIBarButtonItem alloc] initWithTitle:@"Export" style:UIBarButtonItemStyleDone target:self action:@selector(_export)];
-    UIBarButtonItem *flexibleSpaceItem = [[UIBarButtonItem alloc] initWithBarButtonSystemItem:UIBarButtonSystemItemFlexibleSpace target:nil action:nil];
     
-    _toolbar.items = @[flexibleSpaceItem, exportItem];
+    _toolbar.items = @[observersItem, flexibleSpaceItem, exportItem];
+  } else {
+    _toolbar.items = @[observersItem, flexibleSpaceItem];
   }
 }
 
@@ -123,6 +129,12 @@
 #endif
 }
 
+- (void)_showObservers
+{
+  _FBTweakObserverProfilerViewController *viewController = [[_FBTweakObserverProfilerViewController alloc] initWithProfiler:[FBTweakObserverProfiler sharedInstance]];
+  [self.navigationController pushViewController:viewController animated:YES];
+}
+
 - (void)_export
 {
   NSString *version = [[NSBundle mainBundle] objectForInfoDictionaryKey:(__bridge NSString *)kCFBundleVersionKey];
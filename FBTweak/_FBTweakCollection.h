@@ -0,0 +1,109 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+#import "FBTweakCollection.h"
+#import "FBTweakStore.h"
+
+/**
+  @abstract The initial value for identifier hashes.
+ */
+#define _FBTweakIdentifierHashInitial 14695981039346656037ULL
+
+/**
+  @abstract Adds a UTF-8 string to an identifier hash.
+  @discussion Hashing the parts of an identifier in order gives the same
+    result as hashing the whole identifier.
+ */
+extern uint64_t _FBTweakIdentifierHashAppend(uint64_t hash, const char *string);
+
+/**
+  @abstract Hashes an identifier.
+ */
+extern uint64_t _FBTweakIdentifierHash(NSString *identifier);
+
+/**
+  @abstract Creates the tweak for a section entry.
+  @discussion Defined by the inline loader.
+ */
+extern FBTweak *_FBTweakInlineCreateTweak(const void *entry);
+
+@interface FBTweakCollection (Entries)
+
+/**
+  @abstract Adds a tweak declared in a binary without creating it.
+  @discussion The tweak is created from the entry the first time it is
+    looked up, and may be released again under memory pressure.
+  @param entry The section entry. Must stay mapped until removed.
+  @param identifierHash The hash of the tweak's identifier.
+  @return NO if the collection already has a tweak with the identifier.
+ */
+- (BOOL)_addTweakEntry:(const void *)entry identifierHash:(uint64_t)identifierHash;
+
+/**
+  @abstract Looks up a tweak by the hash of its identifier.
+  @discussion Matches on hash alone, like {@ref _addTweakEntry:identifierHash:},
+    so inline tweaks can be found without formatting their identifier.
+  @return The tweak, or nil if the collection has no tweak with the hash.
+ */
+- (FBTweak *)_tweakWithIdentifierHash:(uint64_t)identifierHash;
+
+/**
+  @abstract Removes tweaks added from entries in a range.
+  @param entries The first entry of the range.
+  @param size The size of the range, in bytes.
+ */
+- (void)_removeTweakEntries:(const void *)entries size:(size_t)size;
+
+/**
+  @abstract The number of tweaks, without creating any.
+ */
+- (NSUInteger)_tweakCount;
+
+/**
+  @abstract Releases tweaks created from entries that nothing else uses.
+ */
+- (void)_releaseCachedTweaks;
+
+/**
+  @abstract Calls a block with the identifier hash of each tweak, without
+    creating any.
+ */
+- (void)_enumerateIdentifierHashesUsingBlock:(void (^)(uint64_t identifierHash))block;
+
+@end
+
+@interface FBTweak (Entries)
+
+/**
+  @abstract If the tweak has state that would be lost if it were released
+    and created again from its entry.
+ */
+- (BOOL)_isPinned;
+
+/**
+  @abstract Sets a block to create the possible values when first read.
+  @discussion Entries can declare large sets of possible values, so they
+    aren't created unless something reads them.
+ */
+- (void)_setPossibleValuesBlock:(id (^)(void))block;
+
+@end
+
+@interface FBTweakStore (Entries)
+
+/**
+  @abstract Releases tweaks created from entries in every collection.
+  @discussion Called automatically under memory pressure.
+ */
+- (void)_releaseCachedTweaks;
+
+@end
@@ -10,6 +10,7 @@
 #import "FBTweakCollection.h"
 #import "FBTweakCategory.h"
 #import "FBTweak.h"
+#import "FBTweakActionRunner.h"
 #import "_FBTweakCollectionViewController.h"
 #import "_FBTweakTableViewCell.h"
 #import "_FBTweakColorViewController.h"
@@ -126,16 +127,20 @@
   if ([tweak.possibleValues isKindOfClass:[NSDictionary class]]) {
     _FBTweakDictionaryViewController *vc = [[_FBTweakDictionaryViewController alloc] initWithTweak:tweak];
     [self.navigationController pushViewController:vc animated:YES];
-  } else if ([tweak.possibleValues isKindOfClass:[NSArray class]]) {
+  } else if ([tweak.possibleValues isKindOfClass:[NSArray class]] ||
+             [tweak.possibleValues conformsToProtocol:@protocol(FBTweakPossibleValuesProvider)]) {
     _FBTweakArrayViewController *vc = [[_FBTweakArrayViewController alloc] initWithTweak:tweak];
     [self.navigationController pushViewController:vc animated:YES];
   } else if ([tweak.defaultValue isKindOfClass:[UIColor class]]) {
     _FBTweakColorViewController *vc = [[_FBTweakColorViewController alloc] initWithTweak:tweak];
     [self.navigationController pushViewController:vc animated:YES];
   } else if (tweak.isAction) {
-    dispatch_block_t block = tweak.defaultValue;
-    if (block != NULL) {
-        block();
+    // Selecting an action while it runs cancels it instead.
+    FBTweakActionRunner *runner = [FBTweakActionRunner sharedInstance];
+    if ([runner progressForAction:tweak] != nil) {
+      [runner cancelAction:tweak];
+    } else {
+      [runner runAction:tweak];
     }
     [tableView deselectRowAtIndexPath:indexPath animated:YES];
   }
@@ -0,0 +1,30 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract The dependencies of the derived value computing on this thread,
+    or NULL when none is.
+  @discussion Read directly so tweaks pay one thread-local load when no
+    derived value is computing.
+ */
+extern __thread CFMutableSetRef _FBTweakDerivedDependencies;
+
+/**
+  @abstract Records an object read by the derived value computing on this
+    thread, if any.
+ */
+static inline void _FBTweakDerivedRecordDependency(id object)
+{
+  CFMutableSetRef dependencies = _FBTweakDerivedDependencies;
+  if (dependencies != NULL) {
+    CFSetAddValue(dependencies, (__bridge const void *)object);
+  }
+}
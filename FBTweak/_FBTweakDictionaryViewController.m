@@ -9,6 +9,7 @@
 
 #import "_FBTweakDictionaryViewController.h"
 #import "FBTweak.h"
+#import "_FBTweakPossibleValues.h"
 
 @interface _FBTweakDictionaryViewController () <UITableViewDataSource, UITableViewDelegate>
 
@@ -16,6 +17,7 @@
 
 @implementation _FBTweakDictionaryViewController {
   UITableView *_tableView;
+  _FBTweakPossibleValuesPager *_pager;
 }
 
 - (instancetype)initWithTweak:(FBTweak *)tweak
@@ -25,6 +27,7 @@
 
   if ((self = [super init])) {
     _tweak = tweak;
+    _pager = [[_FBTweakPossibleValuesPager alloc] initWithProvider:_FBTweakPossibleValuesProvider(tweak.possibleValues)];
     self.title = _tweak.name;
   }
 
@@ -55,7 +58,7 @@
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
-  return [_tweak.possibleValues count];
+  return _pager.count;
 }
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
@@ -66,10 +69,8 @@
     cell = [[UITableViewCell alloc] initWithStyle:UITableViewCellStyleValue1 reuseIdentifier:_FBTweakDictionaryViewControllerCellIdentifier];
   }
   
-  NSArray *allKeys = [self allTweakKeys];
-  FBTweakValue key = allKeys[indexPath.row];
-  NSString *value = _tweak.possibleValues[key];
-  cell.textLabel.text = value;
+  FBTweakValue key = [_pager valueAtIndex:indexPath.row];
+  cell.textLabel.text = [_pager titleAtIndex:indexPath.row];
   
   cell.accessoryType = UITableViewCellAccessoryNone;
   NSString *selectedKey = (_tweak.currentValue ?: _tweak.defaultValue);
@@ -82,21 +83,10 @@
 
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
-  NSArray *allKeys = [self allTweakKeys];
-  NSString *key = allKeys[indexPath.row];
+  FBTweakValue key = [_pager valueAtIndex:indexPath.row];
   
   self.tweak.currentValue = key;
   [self.navigationController popViewControllerAnimated:YES];
 }
 
-- (NSArray *)allTweakKeys
-{
-  // Sort by visible name.
-  return [[_tweak.possibleValues allKeys] sortedArrayUsingComparator:^NSComparisonResult(id obj1, id obj2) {
-    id value1 = _tweak.possibleValues[obj1];
-    id value2 = _tweak.possibleValues[obj2];
-    return [value1 compare:value2];
-  }];
-}
-
 @end
\ No newline at end of file
@@ -0,0 +1,35 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @abstract If inline tweaks are frozen to their defaults.
+  @discussion Set with {@ref -[FBTweakStore setFrozen:]}; read with
+    {@ref _FBTweakIsFrozen}.
+ */
+extern BOOL _FBTweakFrozen;
+
+/**
+  @abstract If inline tweaks are frozen to their defaults.
+  @discussion A single load, predicted not to be taken, so call sites pay
+    one branch while tweaks are live.
+ */
+static inline BOOL _FBTweakIsFrozen(void)
+{
+  return __builtin_expect(__atomic_load_n(&_FBTweakFrozen, __ATOMIC_RELAXED), NO);
+}
+
+#ifdef __cplusplus
+}
+#endif
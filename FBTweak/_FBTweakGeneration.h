@@ -0,0 +1,28 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract Locks out other changes to tweak values, and snapshots.
+  @discussion Held while a tweak's current value is assigned, and while a
+    snapshot reads, so a snapshot never sees a change half made. Keep the
+    work done while holding it to a few loads and stores.
+ */
+extern void _FBTweakGenerationLock(void);
+
+/**
+  @abstract Unlocks {@ref _FBTweakGenerationLock}.
+ */
+extern void _FBTweakGenerationUnlock(void);
+
+/**
+  @abstract Advances the generation after a change, with the lock held.
+ */
+extern void _FBTweakGenerationAdvance(void);
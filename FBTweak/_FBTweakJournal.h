@@ -0,0 +1,28 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+@class FBTweakJournal;
+
+/**
+  @abstract The active journal. Nil unless recording.
+ */
+extern FBTweakJournal *__unsafe_unretained volatile _FBTweakJournalActive;
+
+/**
+  @abstract Records a change in the active journal.
+  @param journal The active journal, loaded once by the caller.
+  @param tweak The tweak that changed.
+  @param identifierIndex Storage, owned by the tweak, for its interned
+    identifier. Zero until first recorded.
+ */
+extern void _FBTweakJournalRecord(FBTweakJournal *journal, FBTweak *tweak, uint32_t *identifierIndex, FBTweakValue oldValue, FBTweakValue newValue);
@@ -0,0 +1,48 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+
+/**
+  @abstract If observer deliveries are being timed.
+  @discussion Set with {@ref -[FBTweakObserverProfiler setEnabled:]}; read
+    with {@ref _FBTweakObserverProfilerIsEnabled}.
+ */
+extern BOOL _FBTweakObserverProfilerEnabled;
+
+/**
+  @abstract If observer deliveries are being timed.
+  @discussion Checked once per notification, predicted not to be taken.
+ */
+static inline BOOL _FBTweakObserverProfilerIsEnabled(void)
+{
+  return __builtin_expect(__atomic_load_n(&_FBTweakObserverProfilerEnabled, __ATOMIC_RELAXED), NO);
+}
+
+/**
+  @abstract Adds one delivery to an observer's profile.
+  @param observer The observer that was notified.
+  @param duration The delivery's duration, in mach_absolute_time units.
+ */
+extern void _FBTweakObserverProfilerRecord(id observer, uint64_t duration);
+
+/**
+  @abstract Observers that name their own profile.
+  @discussion Observers that don't are profiled by their class.
+ */
+@protocol _FBTweakObserverProfiling <NSObject>
+
+/**
+  @abstract The name of the profile to add the observer's deliveries to.
+ */
+- (NSString *)_profileName;
+
+@end
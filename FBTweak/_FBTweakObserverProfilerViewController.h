@@ -0,0 +1,32 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <UIKit/UIKit.h>
+
+@class FBTweakObserverProfiler;
+
+/**
+  @abstract Displays what tweak observers cost, and turns profiling on and off.
+  @discussion Profiles over the profiler's budget are shown in red.
+ */
+@interface _FBTweakObserverProfilerViewController : UIViewController
+
+/**
+  @abstract Creates an observer profiler view controller.
+  @discussion This is the designated initializer.
+  @param profiler The profiler to display. Must not be nil.
+ */
+- (instancetype)initWithProfiler:(FBTweakObserverProfiler *)profiler;
+
+/**
+  @abstract The profiler displayed in the view controller.
+ */
+@property (nonatomic, strong, readonly) FBTweakObserverProfiler *profiler;
+
+@end
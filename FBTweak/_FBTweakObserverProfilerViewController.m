@@ -0,0 +1,150 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakObserverProfilerViewController.h"
+#import "FBTweakObserverProfiler.h"
+
+typedef NS_ENUM(NSInteger, _FBTweakObserverProfilerSection) {
+  _FBTweakObserverProfilerSectionSettings,
+  _FBTweakObserverProfilerSectionProfiles,
+  _FBTweakObserverProfilerSectionCount,
+};
+
+@interface _FBTweakObserverProfilerViewController () <UITableViewDataSource, UITableViewDelegate>
+
+@end
+
+@implementation _FBTweakObserverProfilerViewController {
+  UITableView *_tableView;
+  UISwitch *_enabledSwitch;
+
+  NSArray *_profiles;
+}
+
+- (instancetype)initWithProfiler:(FBTweakObserverProfiler *)profiler
+{
+  NSParameterAssert(profiler != nil);
+
+  if ((self = [super init])) {
+    _profiler = profiler;
+    self.title = @"Observers";
+  }
+
+  return self;
+}
+
+- (void)viewDidLoad
+{
+  [super viewDidLoad];
+
+  _tableView = [[UITableView alloc] initWithFrame:self.view.bounds style:UITableViewStyleGrouped];
+  _tableView.delegate = self;
+  _tableView.dataSource = self;
+  _tableView.autoresizingMask = (UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight);
+  [self.view addSubview:_tableView];
+
+  _enabledSwitch = [[UISwitch alloc] init];
+  [_enabledSwitch addTarget:self action:@selector(_enabledChanged:) forControlEvents:UIControlEventValueChanged];
+
+  self.navigationItem.rightBarButtonItem = [[UIBarButtonItem alloc] initWithTitle:@"Clear" style:UIBarButtonItemStylePlain target:self action:@selector(_clear)];
+}
+
+- (void)dealloc
+{
+  _tableView.delegate = nil;
+  _tableView.dataSource = nil;
+}
+
+- (void)viewWillAppear:(BOOL)animated
+{
+  [super viewWillAppear:animated];
+
+  [self _reloadData];
+}
+
+- (void)_reloadData
+{
+  _enabledSwitch.on = _profiler.enabled;
+  _profiles = [_profiler profiles];
+  [_tableView reloadData];
+}
+
+- (void)_enabledChanged:(UISwitch *)sender
+{
+  _profiler.enabled = sender.on;
+  [self _reloadData];
+}
+
+- (void)_clear
+{
+  [_profiler reset];
+  [self _reloadData];
+}
+
+- (NSInteger)numberOfSectionsInTableView:(UITableView *)tableView
+{
+  return _FBTweakObserverProfilerSectionCount;
+}
+
+- (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
+{
+  if (section == _FBTweakObserverProfilerSectionSettings) {
+    return 1;
+  } else {
+    return _profiles.count;
+  }
+}
+
+- (NSString *)tableView:(UITableView *)tableView titleForFooterInSection:(NSInteger)section
+{
+  if (section == _FBTweakObserverProfilerSectionSettings) {
+    return [NSString stringWithFormat:@"Times each observer as tweaks change. Observers that take over %.1f ms are shown in red.", _profiler.budget * 1000.0];
+  } else {
+    return nil;
+  }
+}
+
+- (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
+{
+  if (indexPath.section == _FBTweakObserverProfilerSectionSettings) {
+    static NSString *_FBTweakObserverProfilerViewControllerSettingsCellIdentifier = @"_FBTweakObserverProfilerViewControllerSettingsCellIdentifier";
+    UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:_FBTweakObserverProfilerViewControllerSettingsCellIdentifier];
+    if (cell == nil) {
+      cell = [[UITableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:_FBTweakObserverProfilerViewControllerSettingsCellIdentifier];
+      cell.selectionStyle = UITableViewCellSelectionStyleNone;
+    }
+
+    cell.textLabel.text = @"Profile Observers";
+    cell.accessoryView = _enabledSwitch;
+
+    return cell;
+  }
+
+  static NSString *_FBTweakObserverProfilerViewControllerProfileCellIdentifier = @"_FBTweakObserverProfilerViewControllerProfileCellIdentifier";
+  UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:_FBTweakObserverProfilerViewControllerProfileCellIdentifier];
+  if (cell == nil) {
+    cell = [[UITableViewCell alloc] initWithStyle:UITableViewCellStyleSubtitle reuseIdentifier:_FBTweakObserverProfilerViewControllerProfileCellIdentifier];
+    cell.selectionStyle = UITableViewCellSelectionStyleNone;
+  }
+
+  FBTweakObserverProfile *profile = _profiles[indexPath.row];
+  NSTimeInterval averageDuration = (profile.deliveries != 0 ? profile.totalDuration / profile.deliveries : 0);
+
+  cell.textLabel.text = profile.name;
+  cell.textLabel.textColor = (profile.slowDeliveries != 0 ? [UIColor redColor] : [UIColor blackColor]);
+  cell.detailTextLabel.text = [NSString stringWithFormat:@"%lu × %.3f ms, max %.3f ms, %lu slow",
+                               (unsigned long)profile.deliveries,
+                               averageDuration * 1000.0,
+                               profile.maximumDuration * 1000.0,
+                               (unsigned long)profile.slowDeliveries];
+
+  return cell;
+}
+
+@end
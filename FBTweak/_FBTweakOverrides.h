@@ -0,0 +1,33 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class FBTweak;
+
+/**
+  @abstract The current thread's override layer, or NULL outside one.
+  @discussion Maps tweaks to their overridden values, with kCFNull for a
+    tweak reset within the layer. Read directly so tweaks pay one
+    thread-local load when no layer is active.
+ */
+extern __thread CFMutableDictionaryRef _FBTweakOverridesLayer;
+
+/**
+  @abstract Starts an override layer on the current thread.
+  @discussion Layers nest; a new layer starts with the values of the
+    layer it's nested in. This is an implementation detail of
+    {@ref +[FBTweakStore withOverrides:]}.
+ */
+extern void _FBTweakOverridesPush(void);
+
+/**
+  @abstract Ends the innermost override layer on the current thread.
+ */
+extern void _FBTweakOverridesPop(void);
@@ -0,0 +1,47 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakOverrides.h"
+
+static NSString *const _FBTweakOverridesParentsKey = @"_FBTweakOverridesParents";
+
+__thread CFMutableDictionaryRef _FBTweakOverridesLayer = NULL;
+
+void _FBTweakOverridesPush(void)
+{
+  CFMutableDictionaryRef parent = _FBTweakOverridesLayer;
+
+  // Remember the enclosing layer, to restore when this one ends.
+  NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+  NSMutableArray *parents = threadDictionary[_FBTweakOverridesParentsKey];
+  if (parents == nil) {
+    parents = [[NSMutableArray alloc] init];
+    threadDictionary[_FBTweakOverridesParentsKey] = parents;
+  }
+  [parents addObject:(parent != NULL ? (__bridge id)parent : [NSNull null])];
+
+  if (parent != NULL) {
+    _FBTweakOverridesLayer = CFDictionaryCreateMutableCopy(kCFAllocatorDefault, 0, parent);
+  } else {
+    _FBTweakOverridesLayer = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+  }
+}
+
+void _FBTweakOverridesPop(void)
+{
+  CFMutableDictionaryRef layer = _FBTweakOverridesLayer;
+  NSCAssert(layer != NULL, @"unbalanced override layer");
+
+  NSMutableArray *parents = [[NSThread currentThread] threadDictionary][_FBTweakOverridesParentsKey];
+  id parent = [parents lastObject];
+  _FBTweakOverridesLayer = (parent != [NSNull null] ? (__bridge CFMutableDictionaryRef)parent : NULL);
+  [parents removeLastObject];
+
+  CFRelease(layer);
+}
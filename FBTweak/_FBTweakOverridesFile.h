@@ -0,0 +1,69 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+@class FBTweakStore;
+
+/**
+  @abstract Reads the records of an overrides file.
+  @discussion Only complete lines are read, as the last line may still be
+    being written.
+  @param data The file's contents, or nil if it doesn't exist.
+  @return The text of each record's value, keyed by identifier, or nil if
+    the file isn't valid UTF-8, which can happen mid-write.
+ */
+extern NSDictionary *_FBTweakOverridesFileRecords(NSData *data);
+
+/**
+  @abstract Parses the text of a record's value.
+  @param text The value's text, a JSON number, boolean, string or null.
+  @param value Set to the value, or nil for null.
+  @return NO if the text isn't a value.
+ */
+extern BOOL _FBTweakOverridesFileParseValue(NSString *text, FBTweakValue *value);
+
+/**
+  @abstract Applies an overrides file to a store whenever it changes.
+  @discussion Each line of the file is a record, `identifier = value`,
+    where the value is a JSON number, boolean or string, or null to reset
+    the tweak. Lines starting with # are comments. Only records whose text
+    changed are parsed, and the changes are applied as one batch on the
+    main queue. Removing a record resets its tweak, once the file reads
+    the same twice in a row. Records for tweaks that aren't registered yet
+    are applied when an image registers them.
+ */
+@interface _FBTweakOverridesFile : NSObject
+
+/**
+  @abstract Creates an overrides file watcher.
+  @param path The path of the overrides file. It need not exist yet.
+  @param store The store to apply overrides to. Not retained.
+ */
+- (instancetype)initWithPath:(NSString *)path store:(FBTweakStore *)store;
+
+/**
+  @abstract The path of the overrides file.
+ */
+@property (nonatomic, copy, readonly) NSString *path;
+
+/**
+  @abstract Applies the file, then watches it for changes.
+  @return NO if the file's directory can't be watched.
+ */
+- (BOOL)startWithError:(NSError **)error;
+
+/**
+  @abstract Stops watching. Values already applied are kept.
+ */
+- (void)stop;
+
+@end
@@ -0,0 +1,356 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakOverridesFile.h"
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "_FBTweakStore.h"
+
+#import <fcntl.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+// Changes are read after a quiet period, so a file written in several
+// steps is usually read once, when it's complete.
+static const int64_t _FBTweakOverridesFileSettleTime = 50 * NSEC_PER_MSEC;
+
+// Set on each file's queue to the file, to tell when already on it.
+static char _FBTweakOverridesFileQueueKey;
+
+NSDictionary *_FBTweakOverridesFileRecords(NSData *data)
+{
+  if (data == nil) {
+    return @{};
+  }
+
+  NSString *contents = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  if (contents == nil) {
+    return nil;
+  }
+
+  NSRange lastNewline = [contents rangeOfString:@"\n" options:NSBackwardsSearch];
+  if (lastNewline.location == NSNotFound) {
+    return @{};
+  }
+
+  NSMutableDictionary *records = [[NSMutableDictionary alloc] init];
+  NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+
+  for (NSString *line in [[contents substringToIndex:lastNewline.location] componentsSeparatedByString:@"\n"]) {
+    NSString *record = [line stringByTrimmingCharactersInSet:whitespace];
+    if (record.length == 0 || [record hasPrefix:@"#"]) {
+      continue;
+    }
+
+    NSRange equals = [record rangeOfString:@"="];
+    if (equals.location == NSNotFound) {
+      continue;
+    }
+
+    NSString *identifier = [[record substringToIndex:equals.location] stringByTrimmingCharactersInSet:whitespace];
+    NSString *value = [[record substringFromIndex:NSMaxRange(equals)] stringByTrimmingCharactersInSet:whitespace];
+    if (identifier.length > 0) {
+      records[identifier] = value;
+    }
+  }
+
+  return records;
+}
+
+BOOL _FBTweakOverridesFileParseValue(NSString *text, FBTweakValue *value)
+{
+  id object = [NSJSONSerialization JSONObjectWithData:[text dataUsingEncoding:NSUTF8StringEncoding] options:NSJSONReadingAllowFragments error:NULL];
+
+  if ([object isKindOfClass:[NSNull class]]) {
+    *value = nil;
+    return YES;
+  } else if ([object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSString class]]) {
+    *value = object;
+    return YES;
+  } else {
+    return NO;
+  }
+}
+
+static FBTweak *_FBTweakOverridesFileTweak(FBTweakStore *store, NSString *identifier)
+{
+  for (FBTweakCategory *category in store.tweakCategories) {
+    for (FBTweakCollection *collection in category.tweakCollections) {
+      FBTweak *tweak = [collection tweakWithIdentifier:identifier];
+      if (tweak != nil) {
+        return tweak;
+      }
+    }
+  }
+
+  return nil;
+}
+
+@implementation _FBTweakOverridesFile {
+  __weak FBTweakStore *_store;
+
+  // Everything below is only used on the queue.
+  dispatch_queue_t _queue;
+  dispatch_source_t _directorySource;
+  dispatch_source_t _fileSource;
+  ino_t _fileInode;
+  uint64_t _generation;
+  NSData *_contents;
+  NSDictionary *_records;
+  id _registrationObserver;
+}
+
+- (instancetype)initWithPath:(NSString *)path store:(FBTweakStore *)store
+{
+  NSParameterAssert(path != nil);
+  NSParameterAssert(store != nil);
+
+  if ((self = [super init])) {
+    _path = [path copy];
+    _store = store;
+    _queue = dispatch_queue_create("com.facebook.tweaks.overrides", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(_queue, &_FBTweakOverridesFileQueueKey, (__bridge void *)self, NULL);
+    _records = @{};
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  // The last reference can go away on the queue, from a scheduled reload
+  // or a source's event handler.
+  [self stop];
+}
+
+- (dispatch_source_t)_sourceWithPath:(NSString *)path mask:(unsigned long)mask
+{
+  int fd = open([path fileSystemRepresentation], O_EVTONLY);
+  if (fd < 0) {
+    return nil;
+  }
+
+  __weak _FBTweakOverridesFile *weakSelf = self;
+  dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE, fd, mask, _queue);
+  dispatch_source_set_event_handler(source, ^{
+    [weakSelf _scheduleReload];
+  });
+  dispatch_source_set_cancel_handler(source, ^{
+    close(fd);
+  });
+  dispatch_resume(source);
+
+  return source;
+}
+
+- (BOOL)startWithError:(NSError **)error
+{
+  // Watching the directory catches the file being created, deleted or
+  // replaced by an atomic rename; watching the file catches writes to it.
+  NSString *directory = [_path stringByDeletingLastPathComponent];
+  __block int openError = 0;
+
+  dispatch_sync(_queue, ^{
+    _directorySource = [self _sourceWithPath:directory mask:DISPATCH_VNODE_WRITE];
+    if (_directorySource == nil) {
+      openError = errno;
+      return;
+    }
+
+    [self _reload];
+  });
+
+  if (openError != 0) {
+    if (error != NULL) {
+      *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:openError userInfo:@{NSFilePathErrorKey: directory}];
+    }
+    return NO;
+  }
+
+  // Records for tweaks in images not loaded yet are applied once they are.
+  __weak _FBTweakOverridesFile *weakSelf = self;
+  _registrationObserver = [[NSNotificationCenter defaultCenter] addObserverForName:_FBTweakStoreDidRegisterTweaksNotification object:_store queue:nil usingBlock:^(NSNotification *notification) {
+    _FBTweakOverridesFile *strongSelf = weakSelf;
+    if (strongSelf != nil) {
+      dispatch_async(strongSelf->_queue, ^{
+        if (strongSelf->_directorySource != nil) {
+          [strongSelf _reload];
+        }
+      });
+    }
+  }];
+
+  return YES;
+}
+
+- (void)stop
+{
+  if (_registrationObserver != nil) {
+    [[NSNotificationCenter defaultCenter] removeObserver:_registrationObserver];
+    _registrationObserver = nil;
+  }
+
+  if (dispatch_get_specific(&_FBTweakOverridesFileQueueKey) == (__bridge void *)self) {
+    [self _cancelSources];
+  } else {
+    dispatch_sync(_queue, ^{
+      [self _cancelSources];
+    });
+  }
+}
+
+- (void)_cancelSources
+{
+  if (_directorySource != nil) {
+    dispatch_source_cancel(_directorySource);
+    _directorySource = nil;
+  }
+
+  if (_fileSource != nil) {
+    dispatch_source_cancel(_fileSource);
+    _fileSource = nil;
+  }
+
+  // Drops any reload already scheduled.
+  _generation++;
+}
+
+- (void)_scheduleReload
+{
+  uint64_t generation = ++_generation;
+
+  __weak _FBTweakOverridesFile *weakSelf = self;
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, _FBTweakOverridesFileSettleTime), _queue, ^{
+    _FBTweakOverridesFile *strongSelf = weakSelf;
+    if (strongSelf != nil && strongSelf->_generation == generation && strongSelf->_directorySource != nil) {
+      [strongSelf _reload];
+    }
+  });
+}
+
+- (void)_watchFile
+{
+  // An atomic rename replaces the file, so follow the path to the new one.
+  struct stat info;
+  BOOL exists = (stat([_path fileSystemRepresentation], &info) == 0);
+  if (_fileSource != nil && exists && info.st_ino == _fileInode) {
+    return;
+  }
+
+  if (_fileSource != nil) {
+    dispatch_source_cancel(_fileSource);
+    _fileSource = nil;
+  }
+
+  if (exists) {
+    _fileInode = info.st_ino;
+    _fileSource = [self _sourceWithPath:_path mask:(DISPATCH_VNODE_WRITE | DISPATCH_VNODE_EXTEND | DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME)];
+  }
+}
+
+- (void)_reload
+{
+  [self _watchFile];
+
+  NSData *contents = [NSData dataWithContentsOfFile:_path];
+  NSDictionary *records = _FBTweakOverridesFileRecords(contents);
+  if (records == nil) {
+    // Caught mid-write; the rest of the write triggers another reload.
+    return;
+  }
+
+  // A file caught empty or half written looks like records were removed,
+  // so removals wait until the same contents are read twice in a row.
+  BOOL settled = (contents == _contents || [contents isEqualToData:_contents]);
+  _contents = contents;
+
+  NSMutableDictionary *appliedRecords = [records mutableCopy];
+  NSMutableDictionary *changes = [[NSMutableDictionary alloc] init];
+  __block BOOL removalsPending = NO;
+
+  [records enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSString *text, BOOL *stop) {
+    if ([_records[identifier] isEqualToString:text]) {
+      return;
+    }
+
+    FBTweakValue value = nil;
+    if (_FBTweakOverridesFileParseValue(text, &value)) {
+      changes[identifier] = (value ?: [NSNull null]);
+    } else {
+      // Left out, so it's parsed again once it's fixed.
+      [appliedRecords removeObjectForKey:identifier];
+    }
+  }];
+
+  [_records enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSString *text, BOOL *stop) {
+    if (records[identifier] != nil) {
+      return;
+    }
+
+    if (settled) {
+      changes[identifier] = [NSNull null];
+    } else {
+      appliedRecords[identifier] = text;
+      removalsPending = YES;
+    }
+  }];
+
+  NSDictionary *texts = [appliedRecords copy];
+  _records = texts;
+
+  if (removalsPending) {
+    [self _scheduleReload];
+  }
+
+  if (changes.count > 0) {
+    __weak FBTweakStore *weakStore = _store;
+    __weak _FBTweakOverridesFile *weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+      FBTweakStore *store = weakStore;
+      NSMutableDictionary *missing = [[NSMutableDictionary alloc] init];
+
+      [store performBatchUpdates:^{
+        [changes enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, id value, BOOL *stop) {
+          FBTweak *tweak = _FBTweakOverridesFileTweak(store, identifier);
+          if (tweak == nil) {
+            if (texts[identifier] != nil) {
+              missing[identifier] = texts[identifier];
+            }
+          } else if (!tweak.isAction) {
+            tweak.currentValue = (value != [NSNull null] ? value : nil);
+          }
+        }];
+      }];
+
+      if (missing.count > 0) {
+        [weakSelf _forgetRecords:missing];
+      }
+    });
+  }
+}
+
+- (void)_forgetRecords:(NSDictionary *)records
+{
+  // Only records a tweak took are kept, so the rest are applied again on
+  // the next reload, such as when an image registers its tweaks. Records
+  // changed since are left alone.
+  dispatch_async(_queue, ^{
+    NSMutableDictionary *remaining = [_records mutableCopy];
+    [records enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSString *text, BOOL *stop) {
+      if ([remaining[identifier] isEqualToString:text]) {
+        [remaining removeObjectForKey:identifier];
+      }
+    }];
+    _records = remaining;
+  });
+}
+
+@end
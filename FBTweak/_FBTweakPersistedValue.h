@@ -0,0 +1,31 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+/**
+  @abstract Converts a value to the object it's saved as in user defaults.
+  @discussion Numbers, booleans and strings are saved as themselves, and
+    colors as an {@ref _FBTweakBinaryValueTypeColor} tag followed by their
+    red, green, blue and alpha components. Other values, which can't go in
+    a property list, are saved as a keyed archive.
+  @return The object to save, or nil for nil.
+ */
+extern id _FBTweakPersistedObjectForValue(FBTweakValue value);
+
+/**
+  @abstract Converts an object read from user defaults back to a value.
+  @param object The saved object. Can be nil.
+  @param migrate Set to YES if the object is a keyed archive of a value
+    now saved natively, so should be saved again. Can be NULL.
+  @return The value, or nil if there's none or it can't be read.
+ */
+extern FBTweakValue _FBTweakValueForPersistedObject(id object, BOOL *migrate);
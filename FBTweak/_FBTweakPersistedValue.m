@@ -0,0 +1,71 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakPersistedValue.h"
+#import "_FBTweakBinaryCoding.h"
+
+#import <UIKit/UIKit.h>
+
+// A tag and four floats; keyed archives start with "bplist" instead.
+static const NSUInteger _FBTweakPersistedColorLength = 1 + 4 * sizeof(float);
+
+static BOOL _FBTweakPersistedValueIsNative(FBTweakValue value)
+{
+  // Decimal numbers would lose their precision as a property list number.
+  return (([value isKindOfClass:[NSNumber class]] && ![value isKindOfClass:[NSDecimalNumber class]]) ||
+          [value isKindOfClass:[NSString class]]);
+}
+
+static BOOL _FBTweakPersistedValueIsPackedColor(FBTweakValue value)
+{
+  // Pattern colors, for example, have no components.
+  CGFloat red, green, blue, alpha;
+  return ([value isKindOfClass:[UIColor class]] && [(UIColor *)value getRed:&red green:&green blue:&blue alpha:&alpha]);
+}
+
+id _FBTweakPersistedObjectForValue(FBTweakValue value)
+{
+  if (value == nil) {
+    return nil;
+  } else if (_FBTweakPersistedValueIsNative(value)) {
+    return value;
+  } else if (_FBTweakPersistedValueIsPackedColor(value)) {
+    NSMutableData *data = [[NSMutableData alloc] initWithCapacity:_FBTweakPersistedColorLength];
+    _FBTweakBinaryAppendValue(data, value);
+    return data;
+  }
+
+  // We can't store other objects in the plist file.
+  return [NSKeyedArchiver archivedDataWithRootObject:value];
+}
+
+FBTweakValue _FBTweakValueForPersistedObject(id object, BOOL *migrate)
+{
+  if (migrate != NULL) {
+    *migrate = NO;
+  }
+
+  if (![object isKindOfClass:[NSData class]]) {
+    return object;
+  }
+
+  NSData *data = object;
+  const uint8_t *bytes = data.bytes;
+  if (data.length == _FBTweakPersistedColorLength && bytes[0] == _FBTweakBinaryValueTypeColor) {
+    _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(bytes, data.length);
+    return _FBTweakBinaryReadValue(&reader);
+  }
+
+  // Saved before values were stored by kind, or of a kind that's archived.
+  FBTweakValue value = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+  if (migrate != NULL) {
+    *migrate = (_FBTweakPersistedValueIsNative(value) || _FBTweakPersistedValueIsPackedColor(value));
+  }
+  return value;
+}
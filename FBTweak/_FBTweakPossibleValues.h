@@ -0,0 +1,54 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+/**
+  @abstract A provider for a tweak's list of possible values.
+  @discussion Wraps arrays and dictionaries, whose keys are listed in
+    order of their titles, and returns providers as they are.
+  @return The provider, or nil if the possible values aren't a list.
+ */
+extern id<FBTweakPossibleValuesProvider> _FBTweakPossibleValuesProvider(id possibleValues);
+
+/**
+  @abstract The title to display for one of a tweak's possible values.
+ */
+extern NSString *_FBTweakPossibleValuesTitle(id possibleValues, FBTweakValue value);
+
+/**
+  @abstract Reads possible values from a provider a page at a time.
+  @discussion Pages are kept once read, so scrolling back is free.
+ */
+@interface _FBTweakPossibleValuesPager : NSObject
+
+/**
+  @abstract Designated initializer.
+  @param provider The provider to read from.
+ */
+- (instancetype)initWithProvider:(id<FBTweakPossibleValuesProvider>)provider;
+
+/**
+  @abstract The number of possible values.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+  @abstract The value at an index, reading its page if needed.
+ */
+- (FBTweakValue)valueAtIndex:(NSUInteger)index;
+
+/**
+  @abstract The title to display for the value at an index.
+ */
+- (NSString *)titleAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,155 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakPossibleValues.h"
+
+static const NSUInteger _FBTweakPossibleValuesPageSize = 64;
+
+@interface _FBTweakArrayPossibleValues : NSObject <FBTweakPossibleValuesProvider>
+@end
+
+@implementation _FBTweakArrayPossibleValues {
+  NSArray *_values;
+}
+
+- (instancetype)initWithArray:(NSArray *)values
+{
+  if ((self = [super init])) {
+    _values = values;
+  }
+  return self;
+}
+
+- (NSUInteger)numberOfValues
+{
+  return _values.count;
+}
+
+- (NSArray *)valuesInRange:(NSRange)range
+{
+  return [_values subarrayWithRange:range];
+}
+
+- (BOOL)containsValue:(FBTweakValue)value
+{
+  return [_values containsObject:value];
+}
+
+@end
+
+@interface _FBTweakDictionaryPossibleValues : NSObject <FBTweakPossibleValuesProvider>
+@end
+
+@implementation _FBTweakDictionaryPossibleValues {
+  NSDictionary *_titles;
+  NSArray *_sortedKeys;
+}
+
+- (instancetype)initWithDictionary:(NSDictionary *)titles
+{
+  if ((self = [super init])) {
+    _titles = titles;
+  }
+  return self;
+}
+
+- (NSArray *)_sortedKeys
+{
+  // Sorted once, by visible name, the first time a page is read.
+  if (_sortedKeys == nil) {
+    _sortedKeys = [_titles keysSortedByValueUsingSelector:@selector(compare:)];
+  }
+  return _sortedKeys;
+}
+
+- (NSUInteger)numberOfValues
+{
+  return _titles.count;
+}
+
+- (NSArray *)valuesInRange:(NSRange)range
+{
+  return [[self _sortedKeys] subarrayWithRange:range];
+}
+
+- (BOOL)containsValue:(FBTweakValue)value
+{
+  return (_titles[value] != nil);
+}
+
+- (NSString *)titleForValue:(FBTweakValue)value
+{
+  return _titles[value];
+}
+
+@end
+
+id<FBTweakPossibleValuesProvider> _FBTweakPossibleValuesProvider(id possibleValues)
+{
+  if ([possibleValues isKindOfClass:[NSArray class]]) {
+    return [[_FBTweakArrayPossibleValues alloc] initWithArray:possibleValues];
+  } else if ([possibleValues isKindOfClass:[NSDictionary class]]) {
+    return [[_FBTweakDictionaryPossibleValues alloc] initWithDictionary:possibleValues];
+  } else if ([possibleValues conformsToProtocol:@protocol(FBTweakPossibleValuesProvider)]) {
+    return possibleValues;
+  } else {
+    return nil;
+  }
+}
+
+NSString *_FBTweakPossibleValuesTitle(id possibleValues, FBTweakValue value)
+{
+  if ([possibleValues isKindOfClass:[NSDictionary class]]) {
+    return possibleValues[value];
+  } else if ([possibleValues respondsToSelector:@selector(titleForValue:)]) {
+    return [possibleValues titleForValue:value];
+  } else {
+    return [value description];
+  }
+}
+
+@implementation _FBTweakPossibleValuesPager {
+  id<FBTweakPossibleValuesProvider> _provider;
+  NSMutableDictionary *_pages;
+}
+
+- (instancetype)initWithProvider:(id<FBTweakPossibleValuesProvider>)provider
+{
+  NSParameterAssert(provider != nil);
+
+  if ((self = [super init])) {
+    _provider = provider;
+    _count = [provider numberOfValues];
+    _pages = [[NSMutableDictionary alloc] init];
+  }
+
+  return self;
+}
+
+- (FBTweakValue)valueAtIndex:(NSUInteger)index
+{
+  NSParameterAssert(index < _count);
+
+  NSUInteger pageIndex = index / _FBTweakPossibleValuesPageSize;
+  NSArray *page = _pages[@(pageIndex)];
+  if (page == nil) {
+    NSUInteger location = pageIndex * _FBTweakPossibleValuesPageSize;
+    page = [_provider valuesInRange:NSMakeRange(location, MIN(_FBTweakPossibleValuesPageSize, _count - location))];
+    _pages[@(pageIndex)] = page;
+  }
+
+  return page[index % _FBTweakPossibleValuesPageSize];
+}
+
+- (NSString *)titleAtIndex:(NSUInteger)index
+{
+  return _FBTweakPossibleValuesTitle(_provider, [self valueAtIndex:index]);
+}
+
+@end
@@ -0,0 +1,44 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+/**
+  @abstract Delivers a tweak's changes to one observer on a queue.
+  @discussion This is an implementation detail of
+    {@ref -[FBTweak addObserver:queue:delivery:]}.
+ */
+@interface _FBTweakQueuedObserver : NSObject
+
+/**
+  @abstract Designated initializer.
+  @param observer The observer, which is referenced weakly.
+  @param queue The queue to notify on, or nil for the default.
+  @param delivery When to notify.
+ */
+- (instancetype)initWithObserver:(id<FBTweakObserver>)observer queue:(dispatch_queue_t)queue delivery:(FBTweakObserverDelivery)delivery;
+
+/**
+  @abstract The observer, or nil if it has been deallocated.
+ */
+@property (nonatomic, weak, readonly) id<FBTweakObserver> observer;
+
+/**
+  @abstract Tells a synchronous observer that a tweak will change.
+ */
+- (void)tweakWillChange:(FBTweak *)tweak;
+
+/**
+  @abstract Tells the observer that a tweak changed.
+ */
+- (void)tweakDidChange:(FBTweak *)tweak;
+
+@end
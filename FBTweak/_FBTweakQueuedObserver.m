@@ -0,0 +1,136 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <libkern/OSAtomic.h>
+#import <mach/mach_time.h>
+
+#import "_FBTweakQueuedObserver.h"
+#import "_FBTweakObserverProfiler.h"
+
+// Marks queues so synchronous delivery can tell when it's already on one.
+static void *_FBTweakQueuedObserverQueueKey = &_FBTweakQueuedObserverQueueKey;
+
+@interface _FBTweakQueuedObserver () <_FBTweakObserverProfiling>
+@end
+
+@implementation _FBTweakQueuedObserver {
+  FBTweakObserverDelivery _delivery;
+  dispatch_queue_t _queue;
+
+  // Serial, so an observer's notifications stay in order on any queue.
+  dispatch_queue_t _serialQueue;
+
+  // Set while a coalesced notification is waiting to be delivered.
+  volatile int32_t _pending;
+}
+
+- (instancetype)initWithObserver:(id<FBTweakObserver>)observer queue:(dispatch_queue_t)queue delivery:(FBTweakObserverDelivery)delivery
+{
+  NSParameterAssert(observer != nil);
+
+  if ((self = [super init])) {
+    _observer = observer;
+    _delivery = delivery;
+
+    if (delivery == FBTweakObserverDeliverySynchronous) {
+      _queue = queue;
+      if (queue != nil) {
+        dispatch_queue_set_specific(queue, _FBTweakQueuedObserverQueueKey, (__bridge void *)queue, NULL);
+      }
+    } else {
+      _serialQueue = dispatch_queue_create("com.facebook.tweaks.observer", DISPATCH_QUEUE_SERIAL);
+      dispatch_set_target_queue(_serialQueue, queue ?: dispatch_get_main_queue());
+    }
+  }
+
+  return self;
+}
+
+- (void)_performSynchronously:(dispatch_block_t)block
+{
+  // Also inline on the main thread for the main queue: code run from the
+  // main run loop isn't always seen as being on the main queue.
+  if (_queue == nil || dispatch_get_specific(_FBTweakQueuedObserverQueueKey) == (__bridge void *)_queue || (_queue == dispatch_get_main_queue() && [NSThread isMainThread])) {
+    block();
+  } else {
+    dispatch_sync(_queue, block);
+  }
+}
+
+- (void)_deliverToObserver:(id<FBTweakObserver>)observer tweak:(FBTweak *)tweak willChange:(BOOL)willChange
+{
+  uint64_t start = (_FBTweakObserverProfilerIsEnabled() ? mach_absolute_time() : 0);
+
+  if (willChange) {
+    [observer tweakWillChange:tweak];
+  } else {
+    [observer tweakDidChange:tweak];
+  }
+
+  if (start != 0) {
+    _FBTweakObserverProfilerRecord(self, mach_absolute_time() - start);
+  }
+}
+
+- (NSString *)_profileName
+{
+  id<FBTweakObserver> observer = _observer;
+  return (observer != nil ? [NSStringFromClass([observer class]) stringByAppendingString:@" (queued)"] : nil);
+}
+
+- (void)tweakWillChange:(FBTweak *)tweak
+{
+  if (_delivery != FBTweakObserverDeliverySynchronous) {
+    return;
+  }
+
+  id<FBTweakObserver> observer = _observer;
+  if ([observer respondsToSelector:@selector(tweakWillChange:)]) {
+    [self _performSynchronously:^{
+      [self _deliverToObserver:observer tweak:tweak willChange:YES];
+    }];
+  }
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  if (_delivery == FBTweakObserverDeliverySynchronous) {
+    id<FBTweakObserver> observer = _observer;
+    if (observer != nil) {
+      [self _performSynchronously:^{
+        [self _deliverToObserver:observer tweak:tweak willChange:NO];
+      }];
+    }
+    return;
+  }
+
+  if (_delivery == FBTweakObserverDeliveryCoalesced && !OSAtomicCompareAndSwap32Barrier(0, 1, &_pending)) {
+    // Already waiting, and it will see this change too.
+    return;
+  }
+
+  __weak _FBTweakQueuedObserver *weakSelf = self;
+  dispatch_async(_serialQueue, ^{
+    _FBTweakQueuedObserver *strongSelf = weakSelf;
+    if (strongSelf == nil) {
+      return;
+    }
+
+    if (strongSelf->_delivery == FBTweakObserverDeliveryCoalesced) {
+      OSAtomicCompareAndSwap32Barrier(1, 0, &strongSelf->_pending);
+    }
+
+    id<FBTweakObserver> observer = strongSelf.observer;
+    if (observer != nil) {
+      [strongSelf _deliverToObserver:observer tweak:tweak willChange:NO];
+    }
+  });
+}
+
+@end
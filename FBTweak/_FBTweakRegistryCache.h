@@ -0,0 +1,84 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+  @abstract Marks a cached entry declared with FBTweakC.h.
+ */
+#define _FBTweakRegistryCacheEntryC 1
+
+/**
+  @abstract What the loader worked out about one section entry.
+ */
+typedef struct {
+  uint64_t identifierHash;
+  uint32_t collection;
+  uint32_t flags;
+} _FBTweakRegistryCacheEntry;
+
+/**
+  @abstract The registry built from an image's tweak section, saved to
+    skip rebuilding it on the next launch of the same binary.
+  @discussion The file is read in place from mapped memory: a header with
+    the image's UUID, then a table of collections, then one record per
+    section entry, in section order, then the names.
+ */
+@interface _FBTweakRegistryCache : NSObject
+
+/**
+  @abstract The path of the cache for an image.
+  @param imageName The file name of the image.
+ */
++ (NSString *)pathForImageName:(NSString *)imageName;
+
+/**
+  @abstract Serializes a registry.
+  @param uuid The image's 16 byte UUID.
+  @param categoryNames The category of each collection.
+  @param collectionNames The name of each collection.
+  @param entries One record per section entry.
+  @param count The number of entries.
+ */
++ (NSData *)dataWithUUID:(const uint8_t *)uuid
+           categoryNames:(NSArray *)categoryNames
+         collectionNames:(NSArray *)collectionNames
+                 entries:(const _FBTweakRegistryCacheEntry *)entries
+                   count:(NSUInteger)count;
+
+/**
+  @abstract Reads a cache, if it was built from the same binary.
+  @param data The cache, ideally mapped.
+  @param uuid The image's 16 byte UUID.
+  @param entryCount The number of entries in the image's section.
+  @return nil if the cache is for another binary, or malformed.
+ */
+- (instancetype)initWithData:(NSData *)data UUID:(const uint8_t *)uuid entryCount:(NSUInteger)entryCount;
+
+/**
+  @abstract The number of collections.
+ */
+@property (nonatomic, assign, readonly) NSUInteger collectionCount;
+
+/**
+  @abstract The name of the category of a collection.
+ */
+- (NSString *)categoryNameAtIndex:(NSUInteger)index;
+
+/**
+  @abstract The name of a collection.
+ */
+- (NSString *)collectionNameAtIndex:(NSUInteger)index;
+
+/**
+  @abstract One record per section entry, in section order.
+ */
+@property (nonatomic, assign, readonly) const _FBTweakRegistryCacheEntry *entries;
+
+@end
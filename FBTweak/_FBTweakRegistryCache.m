@@ -0,0 +1,154 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakRegistryCache.h"
+
+#define _FBTweakRegistryCacheMagic 0x52544246 /* FBTR */
+#define _FBTweakRegistryCacheVersion 1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint8_t uuid[16];
+  uint32_t entry_count;
+  uint32_t collection_count;
+  uint32_t strings_size;
+  uint32_t pointer_size;
+} _FBTweakRegistryCacheHeader;
+
+typedef struct {
+  uint32_t category_name;
+  uint32_t collection_name;
+} _FBTweakRegistryCacheCollection;
+
+@implementation _FBTweakRegistryCache {
+  NSData *_data;
+  const _FBTweakRegistryCacheCollection *_collections;
+  const char *_strings;
+}
+
++ (NSString *)pathForImageName:(NSString *)imageName
+{
+  NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+  NSString *fileName = [imageName stringByAppendingPathExtension:@"fbtweakregistry"];
+  return [[caches stringByAppendingPathComponent:@"FBTweak"] stringByAppendingPathComponent:fileName];
+}
+
+static uint32_t _FBTweakRegistryCacheAppendString(NSMutableData *strings, NSString *string)
+{
+  uint32_t offset = (uint32_t)strings.length;
+  const char *utf8 = [string UTF8String];
+  [strings appendBytes:utf8 length:strlen(utf8) + 1];
+  return offset;
+}
+
++ (NSData *)dataWithUUID:(const uint8_t *)uuid
+           categoryNames:(NSArray *)categoryNames
+         collectionNames:(NSArray *)collectionNames
+                 entries:(const _FBTweakRegistryCacheEntry *)entries
+                   count:(NSUInteger)count
+{
+  NSParameterAssert(uuid != NULL);
+  NSParameterAssert(categoryNames.count == collectionNames.count);
+
+  NSUInteger collectionCount = collectionNames.count;
+  _FBTweakRegistryCacheCollection *collections = calloc(MAX(collectionCount, (NSUInteger)1), sizeof(*collections));
+  NSMutableData *strings = [[NSMutableData alloc] init];
+  for (NSUInteger i = 0; i < collectionCount; i++) {
+    collections[i].category_name = _FBTweakRegistryCacheAppendString(strings, categoryNames[i]);
+    collections[i].collection_name = _FBTweakRegistryCacheAppendString(strings, collectionNames[i]);
+  }
+
+  _FBTweakRegistryCacheHeader header = {
+    .magic = _FBTweakRegistryCacheMagic,
+    .version = _FBTweakRegistryCacheVersion,
+    .entry_count = (uint32_t)count,
+    .collection_count = (uint32_t)collectionCount,
+    .strings_size = (uint32_t)strings.length,
+    .pointer_size = sizeof(void *),
+  };
+  memcpy(header.uuid, uuid, sizeof(header.uuid));
+
+  NSMutableData *data = [[NSMutableData alloc] init];
+  [data appendBytes:&header length:sizeof(header)];
+  [data appendBytes:collections length:collectionCount * sizeof(*collections)];
+  [data appendBytes:entries length:count * sizeof(*entries)];
+  [data appendData:strings];
+
+  free(collections);
+  return data;
+}
+
+- (instancetype)initWithData:(NSData *)data UUID:(const uint8_t *)uuid entryCount:(NSUInteger)entryCount
+{
+  NSParameterAssert(uuid != NULL);
+
+  if (data.length < sizeof(_FBTweakRegistryCacheHeader)) {
+    return nil;
+  }
+
+  const uint8_t *bytes = data.bytes;
+  const _FBTweakRegistryCacheHeader *header = (const _FBTweakRegistryCacheHeader *)bytes;
+  if (header->magic != _FBTweakRegistryCacheMagic ||
+      header->version != _FBTweakRegistryCacheVersion ||
+      header->pointer_size != sizeof(void *) ||
+      memcmp(header->uuid, uuid, sizeof(header->uuid)) != 0 ||
+      header->entry_count != entryCount) {
+    return nil;
+  }
+
+  size_t collectionsOffset = sizeof(*header);
+  size_t entriesOffset = collectionsOffset + (size_t)header->collection_count * sizeof(_FBTweakRegistryCacheCollection);
+  size_t stringsOffset = entriesOffset + (size_t)header->entry_count * sizeof(_FBTweakRegistryCacheEntry);
+  if (data.length != stringsOffset + header->strings_size) {
+    return nil;
+  }
+
+  // Everything is checked once here, so lookups can trust the file.
+  const _FBTweakRegistryCacheCollection *collections = (const _FBTweakRegistryCacheCollection *)(bytes + collectionsOffset);
+  const _FBTweakRegistryCacheEntry *entries = (const _FBTweakRegistryCacheEntry *)(bytes + entriesOffset);
+  const char *strings = (const char *)(bytes + stringsOffset);
+  if (header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+    return nil;
+  }
+  for (uint32_t i = 0; i < header->collection_count; i++) {
+    if (collections[i].category_name >= header->strings_size || collections[i].collection_name >= header->strings_size) {
+      return nil;
+    }
+  }
+  for (uint32_t i = 0; i < header->entry_count; i++) {
+    if (entries[i].collection >= header->collection_count) {
+      return nil;
+    }
+  }
+
+  if ((self = [super init])) {
+    _data = data;
+    _collections = collections;
+    _strings = strings;
+    _entries = entries;
+    _collectionCount = header->collection_count;
+  }
+
+  return self;
+}
+
+- (NSString *)categoryNameAtIndex:(NSUInteger)index
+{
+  NSParameterAssert(index < _collectionCount);
+  return [NSString stringWithUTF8String:_strings + _collections[index].category_name];
+}
+
+- (NSString *)collectionNameAtIndex:(NSUInteger)index
+{
+  NSParameterAssert(index < _collectionCount);
+  return [NSString stringWithUTF8String:_strings + _collections[index].collection_name];
+}
+
+@end
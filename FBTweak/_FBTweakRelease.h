@@ -0,0 +1,67 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweakC.h"
+
+#ifndef FBTweakReleaseSectionName
+#define FBTweakReleaseSectionName "FBTweakRelease"
+#endif
+
+#if defined(__ELF__)
+#define _FBTweakReleaseSection FBTweakReleaseSectionName
+#else
+#define _FBTweakReleaseSection FBTweakSegmentName "," FBTweakReleaseSectionName
+#endif
+
+#define _FBTweakReleaseEntryAttributes __attribute__((used, section(_FBTweakReleaseSection), aligned(sizeof(void *))))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @abstract A call site of {@ref FBTweakReleaseValue} in a release build.
+  @discussion Reading the tweak reads through value, which points at the
+    site's default until the site is resolved, then at the tweak's slot
+    in a read-only table if it's overridden.
+ */
+typedef struct {
+  __unsafe_unretained NSString *category;
+  __unsafe_unretained NSString *collection;
+  __unsafe_unretained NSString *name;
+  const char *encoding;
+  const void *defaultValue;
+  const void *value;
+} fb_tweak_release_entry;
+
+/**
+  @abstract A slot in the table of overridden values.
+  @discussion Holds one value of the type its sites read, at offset zero.
+ */
+typedef union {
+  int64_t integer;
+  double floating;
+  const void *pointer;
+} fb_tweak_release_value;
+
+/**
+  @abstract Points each site at its overridden value, or its default.
+  @discussion Called for every loaded image at launch. Sites of the same
+    tweak and type share a slot. The table is made read-only once filled.
+  @param entries The sites to resolve.
+  @param count The number of sites.
+  @param overrides Values keyed by identifier, as parsed from an overrides file.
+ */
+extern void _FBTweakReleaseResolveEntries(fb_tweak_release_entry *entries, size_t count, NSDictionary *overrides);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+@class FBTweakSharedTable;
+
+/**
+  @abstract One tweak's value in a {@ref FBTweakSharedTable}.
+ */
+typedef struct _FBTweakSharedSlot _FBTweakSharedSlot;
+
+/**
+  @abstract Reads a slot if it changed.
+  @param slot The slot to read.
+  @param sequence On input, the sequence last read. On output, the
+    sequence of the value read.
+  @param value On output, the value, if the slot changed.
+  @return NO without reading if the slot still has the given sequence, or
+    if a write is in progress; the value last read stays current until
+    the next read.
+ */
+extern BOOL _FBTweakSharedSlotRead(_FBTweakSharedSlot *slot, uint32_t *sequence, FBTweakValue *value);
+
+/**
+  @abstract Writes a value to a slot.
+  @discussion Values whose encoding is over 44 bytes, such as longer
+    strings, aren't shared: the slot keeps its previous value and the
+    writer keeps the value locally.
+  @return The sequence of the written value, or zero if the value
+    can't be shared.
+ */
+extern uint32_t _FBTweakSharedTableWrite(FBTweakSharedTable *table, _FBTweakSharedSlot *slot, FBTweakValue value);
+
+@interface FBTweak (SharedTable)
+
+/**
+  @abstract Backs the tweak's current value with a shared slot.
+ */
+- (void)_attachSharedTable:(FBTweakSharedTable *)table slot:(_FBTweakSharedSlot *)slot;
+
+/**
+  @abstract Takes a value written by another process and notifies observers.
+ */
+- (void)_synchronizeSharedValue;
+
+@end
@@ -0,0 +1,34 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweakStore.h"
+
+/**
+  @abstract Posted on the main queue after an image's inline tweaks are
+    added to the shared store.
+  @discussion Images loaded after launch, e.g. with dlopen, add tweaks
+    long after anything that looked them up by identifier. The object is
+    the store.
+ */
+extern NSString *const _FBTweakStoreDidRegisterTweaksNotification;
+
+@interface FBTweakStore (Registration)
+
+/**
+  @abstract Stops counting tweaks registered since compaction as orphaned.
+  @discussion Called on the main queue after an image registers its
+    tweaks, so values for tweaks in images loaded after launch aren't
+    removed by a later compaction. Does nothing until compaction has found
+    orphaned values.
+ */
+- (void)_forgetRegisteredOrphanedValues;
+
+@end
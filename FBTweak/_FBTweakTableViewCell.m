@@ -8,7 +8,9 @@
  */
 
 #import "FBTweak.h"
+#import "FBTweakActionRunner.h"
 #import "_FBTweakTableViewCell.h"
+#import "_FBTweakPossibleValues.h"
 
 static UIImage *_FBCreateColorCellsThumbnail(UIColor *color, CGSize size) {
   UIGraphicsBeginImageContext(size);
@@ -42,6 +44,7 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
   UISwitch *_switch;
   UITextField *_textField;
   UIStepper *_stepper;
+  UIActivityIndicatorView *_activityIndicator;
 }
 
 - (instancetype)initWithReuseIdentifier:(NSString *)reuseIdentifier
@@ -63,6 +66,8 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
     [_accessoryView addSubview:_stepper];
     
     self.detailTextLabel.textColor = [UIColor blackColor];
+
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_actionDidChange:) name:FBTweakActionRunnerDidChangeNotification object:nil];
   }
 
   return self;
@@ -70,6 +75,7 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
 
 - (void)dealloc
 {
+  [[NSNotificationCenter defaultCenter] removeObserver:self name:FBTweakActionRunnerDidChangeNotification object:nil];
   [_switch removeTarget:self action:@selector(_switchChanged:) forControlEvents:UIControlEventValueChanged];
   _textField.delegate = nil;
   [_stepper removeTarget:self action:@selector(_stepperChanged:) forControlEvents:UIControlEventValueChanged];
@@ -125,7 +131,8 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
   _FBTweakTableViewCellMode mode = _FBTweakTableViewCellModeNone;
   if ([tweak.possibleValues isKindOfClass:[NSDictionary class]]) {
     mode = _FBTweakTableViewCellModeDictionary;
-  } else if ([tweak.possibleValues isKindOfClass:[NSArray class]]) {
+  } else if ([tweak.possibleValues isKindOfClass:[NSArray class]] ||
+             [tweak.possibleValues conformsToProtocol:@protocol(FBTweakPossibleValuesProvider)]) {
     mode = _FBTweakTableViewCellModeArray;
   } else if ([value isKindOfClass:[UIColor class]]) {
     mode = _FBTweakTableViewCellModeColor;
@@ -232,6 +239,7 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
     self.accessoryView = nil;
     self.accessoryType = UITableViewCellAccessoryDisclosureIndicator;
     self.selectionStyle = UITableViewCellSelectionStyleBlue;
+    [self _updateActionStatus];
   } else if (_mode == _FBTweakTableViewCellModeDictionary) {
     _switch.hidden = YES;
     _textField.hidden = YES;
@@ -263,6 +271,38 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
   [self layoutIfNeeded];
 }
 
+- (void)_updateActionStatus
+{
+  NSProgress *progress = [[FBTweakActionRunner sharedInstance] progressForAction:_tweak];
+  if (progress == nil) {
+    self.detailTextLabel.text = nil;
+    self.accessoryView = nil;
+    return;
+  }
+
+  if (progress.cancelled) {
+    self.detailTextLabel.text = @"Cancelling";
+  } else if (progress.fractionCompleted > 0) {
+    self.detailTextLabel.text = [NSString stringWithFormat:@"%.0f%%", progress.fractionCompleted * 100.0];
+  } else {
+    self.detailTextLabel.text = @"Running";
+  }
+
+  if (_activityIndicator == nil) {
+    _activityIndicator = [[UIActivityIndicatorView alloc] initWithActivityIndicatorStyle:UIActivityIndicatorViewStyleGray];
+  }
+  [_activityIndicator startAnimating];
+  self.accessoryView = _activityIndicator;
+}
+
+- (void)_actionDidChange:(NSNotification *)notification
+{
+  if (_mode == _FBTweakTableViewCellModeAction && notification.object == _tweak) {
+    [self _updateActionStatus];
+    [self setNeedsLayout];
+  }
+}
+
 #pragma mark - Actions
 
 - (void)_switchChanged:(UISwitch *)switch_
@@ -340,7 +380,7 @@ typedef NS_ENUM(NSUInteger, _FBTweakTableViewCellMode) {
     }
   } else if (_mode == _FBTweakTableViewCellModeArray) {
     if (primary) {
-      self.detailTextLabel.text = [value description];
+      self.detailTextLabel.text = _FBTweakPossibleValuesTitle(_tweak.possibleValues, value);
     }
   } else if (_mode == _FBTweakTableViewCellModeColor) {
     [self.imageView setImage:_FBCreateColorCellsThumbnail(value, CGSizeMake(30, 30))];
@@ -0,0 +1,50 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBTweak.h"
+
+/**
+  @abstract If variables of a type can be bound to a tweak.
+  @param encoding The @encode of the variable's type.
+  @discussion Integers, floating point numbers and BOOL are supported.
+ */
+extern BOOL _FBTweakVariableEncodingIsSupported(const char *encoding);
+
+/**
+  @abstract Stores a tweak's value in a bound variable.
+  @discussion The store is a single atomic write of the variable's width,
+    so readers on other threads never see a partially written value.
+  @param address The variable.
+  @param encoding The @encode of the variable's type.
+  @param value The value to store. If not a number, defaultValue is stored.
+  @param defaultValue The tweak's default value.
+ */
+extern void _FBTweakVariableStore(void *address, const char *encoding, FBTweakValue value, FBTweakValue defaultValue);
+
+@interface FBTweak (Variable)
+
+/**
+  @abstract Keeps a variable up to date with the tweak's current value.
+  @discussion This is an implementation detail of {@ref FBTweakBindVariable}.
+    Binding the same variable again does nothing.
+  @param address The variable. Must stay valid while the tweak exists.
+  @param encoding The @encode of the variable's type.
+ */
+- (void)_bindVariable:(void *)address encoding:(const char *)encoding;
+
+/**
+  @abstract Stores every tweak's value in its bound variables and C handles.
+  @discussion Used when tweaks are frozen or thawed, as while frozen they
+    hold their defaults.
+ */
++ (void)_storeAllBindings;
+
+@end
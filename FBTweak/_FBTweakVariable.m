@@ -0,0 +1,82 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "_FBTweakVariable.h"
+
+#import <stdbool.h>
+#import <string.h>
+
+BOOL _FBTweakVariableEncodingIsSupported(const char *encoding)
+{
+  return (encoding != NULL && encoding[0] != '\0' && encoding[1] == '\0' && strchr("cCsSiIlLqQfdB", encoding[0]) != NULL);
+}
+
+#define _FBTweakVariableStoreBits(type_, address_, value_) \
+  __atomic_store_n((type_ *)(address_), (type_)(value_), __ATOMIC_RELEASE)
+
+void _FBTweakVariableStore(void *address, const char *encoding, FBTweakValue value, FBTweakValue defaultValue)
+{
+  NSCParameterAssert(address != NULL);
+  NSCParameterAssert(_FBTweakVariableEncodingIsSupported(encoding));
+
+  // Values of another type, like a string written over a number, are
+  // stored as the tweak's default.
+  NSNumber *number = ([value isKindOfClass:[NSNumber class]] ? value : defaultValue);
+
+  switch (encoding[0]) {
+    case 'c':
+      _FBTweakVariableStoreBits(int8_t, address, [number charValue]);
+      break;
+    case 'C':
+      _FBTweakVariableStoreBits(uint8_t, address, [number unsignedCharValue]);
+      break;
+    case 'B':
+      _FBTweakVariableStoreBits(bool, address, [number boolValue]);
+      break;
+    case 's':
+      _FBTweakVariableStoreBits(int16_t, address, [number shortValue]);
+      break;
+    case 'S':
+      _FBTweakVariableStoreBits(uint16_t, address, [number unsignedShortValue]);
+      break;
+    case 'i':
+      _FBTweakVariableStoreBits(int32_t, address, [number intValue]);
+      break;
+    case 'I':
+      _FBTweakVariableStoreBits(uint32_t, address, [number unsignedIntValue]);
+      break;
+    case 'l':
+      _FBTweakVariableStoreBits(long, address, [number longValue]);
+      break;
+    case 'L':
+      _FBTweakVariableStoreBits(unsigned long, address, [number unsignedLongValue]);
+      break;
+    case 'q':
+      _FBTweakVariableStoreBits(int64_t, address, [number longLongValue]);
+      break;
+    case 'Q':
+      _FBTweakVariableStoreBits(uint64_t, address, [number unsignedLongLongValue]);
+      break;
+    case 'f': {
+      // Stored as bits, so the write is a single integer store.
+      float floatValue = [number floatValue];
+      uint32_t bits;
+      memcpy(&bits, &floatValue, sizeof(bits));
+      _FBTweakVariableStoreBits(uint32_t, address, bits);
+      break;
+    }
+    case 'd': {
+      double doubleValue = [number doubleValue];
+      uint64_t bits;
+      memcpy(&bits, &doubleValue, sizeof(bits));
+      _FBTweakVariableStoreBits(uint64_t, address, bits);
+      break;
+    }
+  }
+}
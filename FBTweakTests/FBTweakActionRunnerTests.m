@@ -0,0 +1,128 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakActionRunner.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakInline.h"
+#import "FBTweakStore.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+FBTweakActionWithPolicy(@"Action Runner", @"Inline", @"Background", FBTweakActionPolicyBackground, ^{
+});
+
+@interface FBTweakActionRunnerTests : XCTestCase
+
+@end
+
+@implementation FBTweakActionRunnerTests
+
+- (FBTweak *)_actionWithIdentifier:(NSString *)identifier policy:(FBTweakActionPolicy)policy block:(dispatch_block_t)block
+{
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:identifier];
+  tweak.defaultValue = block;
+  tweak.actionPolicy = policy;
+  return tweak;
+}
+
+- (void)_waitForAction:(FBTweak *)tweak
+{
+  FBTweakActionRunner *runner = [FBTweakActionRunner sharedInstance];
+  [self expectationForNotification:FBTweakActionRunnerDidChangeNotification object:tweak handler:^BOOL(NSNotification *notification) {
+    return ([runner progressForAction:tweak] == nil);
+  }];
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testRunsOnceAtATime
+{
+  FBTweakActionRunner *runner = [FBTweakActionRunner sharedInstance];
+  dispatch_semaphore_t release = dispatch_semaphore_create(0);
+  __block NSUInteger runs = 0;
+
+  FBTweak *tweak = [self _actionWithIdentifier:@"FBTweakActionRunnerTests.once" policy:FBTweakActionPolicyBackground block:^{
+    runs++;
+    dispatch_semaphore_wait(release, DISPATCH_TIME_FOREVER);
+  }];
+
+  NSProgress *progress = [runner runAction:tweak];
+  XCTAssertNotNil(progress, @"not started");
+  XCTAssertEqual([runner progressForAction:tweak], progress, @"progress");
+  XCTAssertNil([runner runAction:tweak], @"started twice");
+
+  dispatch_semaphore_signal(release);
+  [self _waitForAction:tweak];
+  XCTAssertEqual(runs, (NSUInteger)1, @"runs %lu", (unsigned long)runs);
+  XCTAssertEqual(progress.fractionCompleted, 1.0, @"progress %@", progress);
+
+  XCTAssertNotNil([runner runAction:tweak], @"not started again");
+  dispatch_semaphore_signal(release);
+  [self _waitForAction:tweak];
+  XCTAssertEqual(runs, (NSUInteger)2, @"runs %lu", (unsigned long)runs);
+}
+
+- (void)testReportsProgressAndCancels
+{
+  FBTweakActionRunner *runner = [FBTweakActionRunner sharedInstance];
+  dispatch_semaphore_t started = dispatch_semaphore_create(0);
+  __block BOOL sawCancellation = NO;
+
+  FBTweak *tweak = [self _actionWithIdentifier:@"FBTweakActionRunnerTests.cancel" policy:FBTweakActionPolicyConcurrent block:^{
+    NSProgress *progress = [NSProgress progressWithTotalUnitCount:4];
+    progress.completedUnitCount = 1;
+    dispatch_semaphore_signal(started);
+
+    while (!progress.cancelled) {
+      usleep(1000);
+    }
+    sawCancellation = YES;
+  }];
+
+  NSProgress *progress = [runner runAction:tweak];
+  dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+  XCTAssertEqualWithAccuracy(progress.fractionCompleted, 0.25, 0.001, @"progress %@", progress);
+
+  [runner cancelAction:tweak];
+  [self _waitForAction:tweak];
+  XCTAssertTrue(progress.cancelled, @"not cancelled");
+  XCTAssertTrue(sawCancellation, @"action didn't see cancellation");
+}
+
+- (void)testSkipsActionsCancelledBeforeStarting
+{
+  FBTweakActionRunner *runner = [FBTweakActionRunner sharedInstance];
+  __block BOOL ran = NO;
+
+  FBTweak *tweak = [self _actionWithIdentifier:@"FBTweakActionRunnerTests.skip" policy:FBTweakActionPolicyMainThread block:^{
+    ran = YES;
+  }];
+
+  // Main thread actions can't start until this test returns to the run loop.
+  [runner runAction:tweak];
+  [runner cancelAction:tweak];
+  [self _waitForAction:tweak];
+  XCTAssertFalse(ran, @"ran after being cancelled");
+}
+
+- (void)testInlineActionsKeepTheirPolicy
+{
+  FBTweakCategory *category = [[FBTweakStore sharedInstance] tweakCategoryWithName:@"Action Runner"];
+  FBTweakCollection *collection = [category tweakCollectionWithName:@"Inline"];
+  FBTweak *tweak = [collection tweakWithIdentifier:@"FBTweak:Action Runner-Inline-Background"];
+  XCTAssertTrue(tweak.isAction, @"tweak %@", tweak);
+  XCTAssertEqual(tweak.actionPolicy, FBTweakActionPolicyBackground, @"policy %lu", (unsigned long)tweak.actionPolicy);
+}
+
+@end
@@ -0,0 +1,85 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweakInline.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static double g_tension;
+static float g_friction;
+static short g_bounces;
+static unsigned long long g_seed;
+static BOOL g_enabled;
+
+@interface FBTweakBindVariableTests : XCTestCase
+
+@end
+
+@implementation FBTweakBindVariableTests
+
+- (void)setUp
+{
+  [super setUp];
+  [[FBTweakStore sharedInstance] reset];
+}
+
+- (void)testBindSetsDefault
+{
+  g_tension = 0;
+  FBTweakBindVariable(&g_tension, @"Variable", @"Spring", @"Tension", 0.5);
+  XCTAssertEqual(g_tension, 0.5);
+
+  g_enabled = NO;
+  FBTweakBindVariable(&g_enabled, @"Variable", @"Spring", @"Enabled", YES);
+  XCTAssertEqual(g_enabled, YES);
+}
+
+- (void)testChangesAreStored
+{
+  FBTweakBindVariable(&g_friction, @"Variable", @"Spring", @"Friction", 2);
+  FBTweakBindVariable(&g_seed, @"Variable", @"Spring", @"Seed", 1);
+  FBTweak *friction = FBTweakInline(@"Variable", @"Spring", @"Friction", (float)2);
+  FBTweak *seed = FBTweakInline(@"Variable", @"Spring", @"Seed", (unsigned long long)1);
+
+  friction.currentValue = @(3.5f);
+  XCTAssertEqual(g_friction, 3.5f);
+
+  seed.currentValue = @(ULLONG_MAX);
+  XCTAssertEqual(g_seed, ULLONG_MAX);
+
+  friction.currentValue = nil;
+  XCTAssertEqual(g_friction, 2.0f);
+}
+
+- (void)testRangeClampsStoredValue
+{
+  FBTweakBindVariable(&g_bounces, @"Variable", @"Spring", @"Bounces", 3, 1, 10);
+  FBTweak *bounces = FBTweakInline(@"Variable", @"Spring", @"Bounces", (short)3, 1, 10);
+
+  bounces.currentValue = @(20);
+  XCTAssertEqual(g_bounces, (short)10);
+}
+
+- (void)testNonNumericValueStoresDefault
+{
+  FBTweakBindVariable(&g_tension, @"Variable", @"Spring", @"Tension", 0.5);
+  FBTweak *tension = FBTweakInline(@"Variable", @"Spring", @"Tension", (double)0.5);
+
+  tension.currentValue = @(0.75);
+  XCTAssertEqual(g_tension, 0.75);
+
+  tension.currentValue = @"tight";
+  XCTAssertEqual(g_tension, 0.5);
+}
+
+@end
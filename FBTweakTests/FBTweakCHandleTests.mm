@@ -0,0 +1,102 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakInline.h"
+#import "FBTweakC.h"
+#import "FBTweakCpp.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+FBTweakCDoubleRange(FBTweakCHandleTestsDouble, "C Handles", "Values", "Double", 0.25, 0.0, 1.0);
+FBTweakCInteger(FBTweakCHandleTestsInteger, "C Handles", "Values", "Integer", 7);
+FBTweakCBool(FBTweakCHandleTestsBool, "C Handles", "Values", "Bool", true);
+FBTweakCppRange(float, FBTweakCHandleTestsFloat, "C Handles", "Values", "Float", 2.0f, 1.0f, 4.0f);
+FBTweakCpp(int, FBTweakCHandleTestsShared, "C Handles", "Values", "Shared", 3);
+
+@interface FBTweakCHandleTests : XCTestCase
+
+@end
+
+@implementation FBTweakCHandleTests
+
+- (FBTweak *)_tweakWithName:(NSString *)name
+{
+  FBTweakCategory *category = [[FBTweakStore sharedInstance] tweakCategoryWithName:@"C Handles"];
+  FBTweakCollection *collection = [category tweakCollectionWithName:@"Values"];
+  return [collection tweakWithIdentifier:[NSString stringWithFormat:@"FBTweak:C Handles-Values-%@", name]];
+}
+
+- (void)tearDown
+{
+  for (NSString *name in @[@"Double", @"Integer", @"Bool", @"Float", @"Shared"]) {
+    [self _tweakWithName:name].currentValue = nil;
+  }
+
+  [super tearDown];
+}
+
+- (void)testRegistersTweaks
+{
+  FBTweak *tweak = [self _tweakWithName:@"Double"];
+  XCTAssertNotNil(tweak, @"not registered");
+  XCTAssertEqualObjects(tweak.name, @"Double", @"name %@", tweak.name);
+  XCTAssertEqualObjects(tweak.defaultValue, @(0.25), @"default %@", tweak.defaultValue);
+  XCTAssertEqualObjects(tweak.minimumValue, @(0.0), @"minimum %@", tweak.minimumValue);
+  XCTAssertEqualObjects(tweak.maximumValue, @(1.0), @"maximum %@", tweak.maximumValue);
+  XCTAssertNil([self _tweakWithName:@"Integer"].possibleValues, @"unexpected range");
+}
+
+- (void)testReadsFollowChanges
+{
+  XCTAssertEqual(fb_tweak_get_double(FBTweakCHandleTestsDouble), 0.25);
+  XCTAssertEqual(fb_tweak_get_integer(FBTweakCHandleTestsInteger), (int64_t)7);
+  XCTAssertTrue(fb_tweak_get_bool(FBTweakCHandleTestsBool));
+
+  [self _tweakWithName:@"Double"].currentValue = @(0.75);
+  [self _tweakWithName:@"Integer"].currentValue = @(-2);
+  [self _tweakWithName:@"Bool"].currentValue = @NO;
+  XCTAssertEqual(fb_tweak_get_double(FBTweakCHandleTestsDouble), 0.75);
+  XCTAssertEqual(fb_tweak_get_integer(FBTweakCHandleTestsInteger), (int64_t)-2);
+  XCTAssertFalse(fb_tweak_get_bool(FBTweakCHandleTestsBool));
+
+  // Clamped to the declared range, then back to the default on reset.
+  [self _tweakWithName:@"Double"].currentValue = @(5.0);
+  XCTAssertEqual(fb_tweak_get_double(FBTweakCHandleTestsDouble), 1.0);
+  [self _tweakWithName:@"Double"].currentValue = nil;
+  XCTAssertEqual(fb_tweak_get_double(FBTweakCHandleTestsDouble), 0.25);
+}
+
+- (void)testTemplateReads
+{
+  float value = FBTweakCHandleTestsFloat;
+  XCTAssertEqual(value, 2.0f);
+
+  [self _tweakWithName:@"Float"].currentValue = @(3.5);
+  XCTAssertEqual(FBTweakCHandleTestsFloat.get(), 3.5f);
+}
+
+- (void)testSharesValueWithObjectiveCTweak
+{
+  // Same name as the C++ declaration, so both refer to one tweak.
+  FBTweak *tweak = FBTweakInline(@"C Handles", @"Values", @"Shared", 3);
+  XCTAssertEqual(tweak, [self _tweakWithName:@"Shared"], @"tweak %@", tweak);
+
+  tweak.currentValue = @(9);
+  XCTAssertEqual(FBTweakCHandleTestsShared.get(), 9);
+}
+
+@end
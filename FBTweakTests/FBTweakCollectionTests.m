@@ -0,0 +1,224 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+#import <malloc/malloc.h>
+
+#import "FBTweak.h"
+#import "FBTweakCollection.h"
+#import "FBTweakInline.h"
+#import "_FBTweakCollection.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static FBTweakLiteralString _FBTweakCollectionTestsCategory = @"Tests";
+static FBTweakLiteralString _FBTweakCollectionTestsCollection = @"Entries";
+static const int _FBTweakCollectionTestsDefault = 7;
+
+@interface FBTweakCollectionTests : XCTestCase <FBTweakObserver>
+
+@end
+
+@implementation FBTweakCollectionTests {
+  NSMutableArray *_names;
+  fb_tweak_entry *_entries;
+  NSUInteger _count;
+}
+
+- (void)_makeEntries:(NSUInteger)count
+{
+  _count = count;
+  _names = [[NSMutableArray alloc] initWithCapacity:count];
+  _entries = calloc(count, sizeof(fb_tweak_entry));
+
+  for (NSUInteger i = 0; i < count; i++) {
+    NSString *name = [NSString stringWithFormat:@"Tweak %lu", (unsigned long)i];
+    [_names addObject:name];
+
+    _entries[i].category = _FBTweakCollectionTestsCategory;
+    _entries[i].collection = _FBTweakCollectionTestsCollection;
+    _entries[i].name = name;
+    _entries[i].value = &_FBTweakCollectionTestsDefault;
+    _entries[i].possible = NULL;
+    _entries[i].encoding = @encode(int);
+  }
+}
+
+- (FBTweakCollection *)_collectionWithEntries
+{
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:_FBTweakCollectionTestsCollection];
+  for (NSUInteger i = 0; i < _count; i++) {
+    [collection _addTweakEntry:&_entries[i] identifierHash:_FBTweakIdentifierHash(_FBTweakIdentifier(&_entries[i]))];
+  }
+  return collection;
+}
+
+- (void)tearDown
+{
+  free(_entries);
+  _names = nil;
+
+  [super tearDown];
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+}
+
+- (void)testCreatesTweaksOnDemand
+{
+  [self _makeEntries:3];
+  FBTweakCollection *collection = [self _collectionWithEntries];
+  XCTAssertEqual([collection _tweakCount], (NSUInteger)3, @"count");
+
+  NSString *identifier = _FBTweakIdentifier(&_entries[1]);
+  FBTweak *tweak = [collection tweakWithIdentifier:identifier];
+  XCTAssertEqualObjects(tweak.identifier, identifier, @"identifier %@", tweak.identifier);
+  XCTAssertEqualObjects(tweak.name, @"Tweak 1", @"name %@", tweak.name);
+  XCTAssertEqualObjects(tweak.defaultValue, @(7), @"default %@", tweak.defaultValue);
+  XCTAssertEqual([collection tweakWithIdentifier:identifier], tweak, @"created twice");
+  XCTAssertNil([collection tweakWithIdentifier:@"FBTweak:Tests-Entries-Missing"], @"unexpected tweak");
+
+  NSArray *tweaks = collection.tweaks;
+  XCTAssertEqual(tweaks.count, (NSUInteger)3, @"tweaks %@", tweaks);
+  XCTAssertEqual(tweaks[1], tweak, @"order %@", tweaks);
+
+  XCTAssertFalse([collection _addTweakEntry:&_entries[1] identifierHash:_FBTweakIdentifierHash(identifier)], @"added duplicate");
+}
+
+- (void)testFindsTweaksByIdentifierHash
+{
+  [self _makeEntries:3];
+  FBTweakCollection *collection = [self _collectionWithEntries];
+
+  NSString *identifier = _FBTweakIdentifier(&_entries[2]);
+  FBTweak *tweak = [collection _tweakWithIdentifierHash:_FBTweakIdentifierHash(identifier)];
+  XCTAssertEqual(tweak, [collection tweakWithIdentifier:identifier], @"tweak %@", tweak);
+  XCTAssertNil([collection _tweakWithIdentifierHash:_FBTweakIdentifierHash(@"FBTweak:Tests-Entries-Missing")], @"unexpected tweak");
+}
+
+- (void)testMixesEntriesAndTweaksInOrder
+{
+  [self _makeEntries:2];
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:_FBTweakCollectionTestsCollection];
+
+  FBTweak *added = [[FBTweak alloc] initWithIdentifier:@"FBTweakCollectionTests.added"];
+  [collection _addTweakEntry:&_entries[0] identifierHash:_FBTweakIdentifierHash(_FBTweakIdentifier(&_entries[0]))];
+  [collection addTweak:added];
+  [collection _addTweakEntry:&_entries[1] identifierHash:_FBTweakIdentifierHash(_FBTweakIdentifier(&_entries[1]))];
+
+  NSArray *tweaks = collection.tweaks;
+  XCTAssertEqual(tweaks[1], added, @"order %@", tweaks);
+  XCTAssertEqual([collection tweakWithIdentifier:added.identifier], added, @"lookup");
+
+  [collection removeTweak:tweaks[0]];
+  [collection _removeTweakEntries:&_entries[1] size:sizeof(fb_tweak_entry)];
+  XCTAssertEqualObjects(collection.tweaks, @[added], @"tweaks %@", collection.tweaks);
+}
+
+- (void)testReleasesUnpinnedTweaks
+{
+  [self _makeEntries:2];
+  FBTweakCollection *collection = [self _collectionWithEntries];
+
+  __weak FBTweak *released = nil;
+  @autoreleasepool {
+    released = [collection tweakWithIdentifier:_FBTweakIdentifier(&_entries[0])];
+  }
+
+  FBTweak *observed = [collection tweakWithIdentifier:_FBTweakIdentifier(&_entries[1])];
+  [observed addObserver:self];
+  __weak FBTweak *weakObserved = observed;
+  observed = nil;
+
+  [collection _releaseCachedTweaks];
+  XCTAssertNil(released, @"not released");
+  XCTAssertNotNil(weakObserved, @"released a tweak with observers");
+  XCTAssertEqual([collection tweakWithIdentifier:_FBTweakIdentifier(&_entries[1])], weakObserved, @"created twice");
+  XCTAssertNotNil([collection tweakWithIdentifier:_FBTweakIdentifier(&_entries[0])], @"not created again");
+}
+
+- (void)testCreatesOneTweakPerEntryAcrossThreads
+{
+  [self _makeEntries:64];
+  FBTweakCollection *collection = [self _collectionWithEntries];
+
+  NSMutableArray *results = [[NSMutableArray alloc] init];
+  dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+    NSArray *tweaks = collection.tweaks;
+    if (iteration % 2 == 0) {
+      [collection _releaseCachedTweaks];
+    }
+    @synchronized (results) {
+      [results addObject:tweaks];
+    }
+  });
+
+  // Each result holds its tweaks, so none could have been created twice.
+  for (NSArray *tweaks in results) {
+    XCTAssertEqual(tweaks.count, (NSUInteger)64, @"tweaks %@", tweaks);
+    for (NSUInteger i = 0; i < tweaks.count; i++) {
+      XCTAssertEqual(tweaks[i], results[0][i], @"created twice");
+    }
+  }
+}
+
+static size_t _FBTweakCollectionTestsMemoryInUse(void)
+{
+  malloc_statistics_t statistics;
+  malloc_zone_statistics(NULL, &statistics);
+  return statistics.size_in_use;
+}
+
+- (void)testMemoryPerTweak
+{
+  const NSUInteger count = 10000;
+  [self _makeEntries:count];
+
+  FBTweakCollection *collection = nil;
+  NSArray *tweaks = nil;
+  size_t start, registered, created;
+
+  @autoreleasepool {
+    start = _FBTweakCollectionTestsMemoryInUse();
+    collection = [self _collectionWithEntries];
+  }
+  registered = _FBTweakCollectionTestsMemoryInUse();
+
+  @autoreleasepool {
+    tweaks = collection.tweaks;
+  }
+  created = _FBTweakCollectionTestsMemoryInUse();
+
+  double registeredPerTweak = (double)(registered - start) / count;
+  double createdPerTweak = (double)(created - start) / count;
+  NSLog(@"%lu tweaks: %.0f bytes each registered, %.0f bytes each once created", (unsigned long)count, registeredPerTweak, createdPerTweak);
+
+  XCTAssertEqual(tweaks.count, count, @"tweaks");
+  XCTAssertTrue(registeredPerTweak < createdPerTweak, @"registered %f created %f", registeredPerTweak, createdPerTweak);
+}
+
+- (void)testRegisteringEntriesPerformance
+{
+  // Like a binary with 5000 call sites, where some tweaks are read in
+  // several places.
+  [self _makeEntries:5000];
+  for (NSUInteger i = 0; i < _count; i += 5) {
+    _entries[i].name = _names[i + 1];
+  }
+
+  [self measureBlock:^{
+    FBTweakCollection *collection = [self _collectionWithEntries];
+    XCTAssertEqual([collection _tweakCount], (NSUInteger)4000, @"count");
+  }];
+}
+
+@end
@@ -0,0 +1,107 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakCompactionReport.h"
+#import "FBTweakStore.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static NSString *const FBTweakCompactionTestsRegistered = @"FBTweak:FBTweakCompactionTests-Registered-Value";
+static NSString *const FBTweakCompactionTestsOrphaned = @"FBTweak:FBTweakCompactionTests-Orphaned-Value";
+static NSString *const FBTweakCompactionTestsOther = @"FBTweakCompactionTestsOther";
+
+@interface FBTweakCompactionTests : XCTestCase
+
+@end
+
+@implementation FBTweakCompactionTests {
+  FBTweakCategory *_category;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:FBTweakCompactionTestsRegistered];
+  tweak.defaultValue = @1;
+  tweak.currentValue = @2;
+
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:@"Registered"];
+  [collection addTweak:tweak];
+  _category = [[FBTweakCategory alloc] initWithName:@"FBTweakCompactionTests"];
+  [_category addTweakCollection:collection];
+  [[FBTweakStore sharedInstance] addTweakCategory:_category];
+
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  [defaults setObject:[NSKeyedArchiver archivedDataWithRootObject:@3] forKey:FBTweakCompactionTestsOrphaned];
+  [defaults setObject:@"other" forKey:FBTweakCompactionTestsOther];
+}
+
+- (void)tearDown
+{
+  [[FBTweakStore sharedInstance] removeTweakCategory:_category];
+
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  [defaults removeObjectForKey:FBTweakCompactionTestsRegistered];
+  [defaults removeObjectForKey:FBTweakCompactionTestsOrphaned];
+  [defaults removeObjectForKey:FBTweakCompactionTestsOther];
+  [defaults removeObjectForKey:@"FBTweakStoreOrphanedSince"];
+
+  [super tearDown];
+}
+
+- (void)testDryRunReportsWithoutRemoving
+{
+  FBTweakCompactionReport *report = [[FBTweakStore sharedInstance] compactPersistedValuesWithRetentionInterval:0 dryRun:YES];
+
+  XCTAssertTrue(report.isDryRun);
+  XCTAssertTrue([report.removedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+  XCTAssertFalse([report.removedIdentifiers containsObject:FBTweakCompactionTestsRegistered]);
+  XCTAssertGreaterThan(report.removedBytes, (NSUInteger)0);
+  XCTAssertNotNil([[NSUserDefaults standardUserDefaults] objectForKey:FBTweakCompactionTestsOrphaned]);
+}
+
+- (void)testRemovesOnlyOrphanedValues
+{
+  FBTweakCompactionReport *report = [[FBTweakStore sharedInstance] compactPersistedValuesWithRetentionInterval:0 dryRun:NO];
+
+  XCTAssertFalse(report.isDryRun);
+  XCTAssertTrue([report.removedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  XCTAssertNil([defaults objectForKey:FBTweakCompactionTestsOrphaned]);
+  XCTAssertNotNil([defaults objectForKey:FBTweakCompactionTestsRegistered]);
+  XCTAssertEqualObjects([defaults objectForKey:FBTweakCompactionTestsOther], @"other");
+}
+
+- (void)testRetentionKeepsRecentlyOrphanedValues
+{
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+
+  FBTweakCompactionReport *report = [store compactPersistedValuesWithRetentionInterval:60 * 60 dryRun:NO];
+  XCTAssertTrue([report.retainedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+  XCTAssertFalse([report.removedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+  XCTAssertNotNil([[NSUserDefaults standardUserDefaults] objectForKey:FBTweakCompactionTestsOrphaned]);
+
+  // Still within the interval, measured from the first pass.
+  report = [store compactPersistedValuesWithRetentionInterval:60 * 60 dryRun:NO];
+  XCTAssertTrue([report.retainedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+
+  report = [store compactPersistedValuesWithRetentionInterval:0 dryRun:NO];
+  XCTAssertTrue([report.removedIdentifiers containsObject:FBTweakCompactionTestsOrphaned]);
+}
+
+@end
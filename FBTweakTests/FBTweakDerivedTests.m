@@ -0,0 +1,147 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakDerived.h"
+#import "FBTweakStore.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakDerivedTests : XCTestCase
+
+@end
+
+@implementation FBTweakDerivedTests {
+  FBTweak *_scale;
+  FBTweak *_offset;
+  FBTweak *_unused;
+}
+
+- (FBTweak *)_tweakWithName:(NSString *)name defaultValue:(FBTweakValue)defaultValue
+{
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:[@"FBTweakDerivedTests." stringByAppendingString:name]];
+  tweak.defaultValue = defaultValue;
+  tweak.currentValue = nil;
+  return tweak;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _scale = [self _tweakWithName:@"scale" defaultValue:@2];
+  _offset = [self _tweakWithName:@"offset" defaultValue:@1];
+  _unused = [self _tweakWithName:@"unused" defaultValue:@0];
+}
+
+- (void)testComputesLazilyAndCaches
+{
+  __block NSUInteger runs = 0;
+  FBTweak *scale = _scale;
+  FBTweakDerivedValue *derived = FBTweakDerived(^id{
+    runs++;
+    return @([(scale.currentValue ?: scale.defaultValue) integerValue] * 10);
+  });
+  XCTAssertEqual(runs, (NSUInteger)0);
+
+  XCTAssertEqualObjects(derived.value, @20);
+  XCTAssertEqualObjects(derived.value, @20);
+  XCTAssertEqual(runs, (NSUInteger)1);
+  XCTAssertEqualObjects(derived.dependencies, [NSSet setWithObject:_scale]);
+}
+
+- (void)testInvalidatedOnlyByDependencies
+{
+  __block NSUInteger runs = 0;
+  FBTweak *scale = _scale;
+  FBTweakDerivedValue *derived = FBTweakDerived(^id{
+    runs++;
+    return @([(scale.currentValue ?: scale.defaultValue) integerValue] * 10);
+  });
+  XCTAssertEqualObjects(derived.value, @20);
+
+  _unused.currentValue = @5;
+  XCTAssertEqualObjects(derived.value, @20);
+  XCTAssertEqual(runs, (NSUInteger)1);
+
+  _scale.currentValue = @3;
+  _scale.currentValue = @4;
+  XCTAssertEqual(runs, (NSUInteger)1);
+  XCTAssertEqualObjects(derived.value, @40);
+  XCTAssertEqual(runs, (NSUInteger)2);
+}
+
+- (void)testChainedDerivedValues
+{
+  FBTweak *scale = _scale;
+  FBTweak *offset = _offset;
+  FBTweakDerivedValue *scaled = FBTweakDerived(^id{
+    return @([(scale.currentValue ?: scale.defaultValue) integerValue] * 10);
+  });
+
+  __block NSUInteger runs = 0;
+  FBTweakDerivedValue *shifted = FBTweakDerived(^id{
+    runs++;
+    return @([scaled.value integerValue] + [(offset.currentValue ?: offset.defaultValue) integerValue]);
+  });
+
+  XCTAssertEqualObjects(shifted.value, @21);
+  XCTAssertEqualObjects(shifted.dependencies, ([NSSet setWithObjects:scaled, _offset, nil]));
+
+  _scale.currentValue = @3;
+  XCTAssertEqualObjects(shifted.value, @31);
+
+  _offset.currentValue = @2;
+  XCTAssertEqualObjects(shifted.value, @32);
+  XCTAssertEqual(runs, (NSUInteger)3);
+}
+
+- (void)testDependenciesChangeWithBranches
+{
+  FBTweak *scale = _scale;
+  FBTweak *offset = _offset;
+  FBTweakDerivedValue *derived = FBTweakDerived(^id{
+    if ([(scale.currentValue ?: scale.defaultValue) integerValue] > 2) {
+      return offset.currentValue ?: offset.defaultValue;
+    }
+    return @0;
+  });
+
+  XCTAssertEqualObjects(derived.value, @0);
+  XCTAssertEqualObjects(derived.dependencies, [NSSet setWithObject:_scale]);
+
+  _scale.currentValue = @3;
+  XCTAssertEqualObjects(derived.value, @1);
+  XCTAssertEqualObjects(derived.dependencies, ([NSSet setWithObjects:_scale, _offset, nil]));
+
+  _offset.currentValue = @7;
+  XCTAssertEqualObjects(derived.value, @7);
+}
+
+- (void)testOverridesAreNotCached
+{
+  FBTweak *scale = _scale;
+  FBTweakDerivedValue *derived = FBTweakDerived(^id{
+    return @([(scale.currentValue ?: scale.defaultValue) integerValue] * 10);
+  });
+  XCTAssertEqualObjects(derived.value, @20);
+
+  [FBTweakStore withOverrides:^{
+    scale.currentValue = @5;
+    XCTAssertEqualObjects(derived.value, @50);
+  }];
+
+  XCTAssertEqualObjects(derived.value, @20);
+}
+
+@end
@@ -0,0 +1,130 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweakInline.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+// Kept in line with FBTweakFrozenTestsCompiledOut.m, so measurements compare.
+static const NSUInteger FBTweakFrozenTestsIterations = 1000000;
+
+static NSInteger FBTweakFrozenTestsReadValues(void)
+{
+  // Volatile, so each read is kept even when the value is a constant.
+  volatile NSInteger sum = 0;
+  for (NSUInteger i = 0; i < FBTweakFrozenTestsIterations; i++) {
+    sum += FBTweakValue(@"Frozen", @"Benchmark", @"Value", 1);
+  }
+  return sum;
+}
+
+@interface FBTweakFrozenTests : XCTestCase
+
+@end
+
+@implementation FBTweakFrozenTests
+
+- (void)setUp
+{
+  [super setUp];
+  [[FBTweakStore sharedInstance] reset];
+}
+
+- (void)tearDown
+{
+  [FBTweakStore sharedInstance].frozen = NO;
+  [super tearDown];
+}
+
+- (void)testFrozenValuesAreDefaults
+{
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+  FBTweak *tweak = FBTweakInline(@"Frozen", @"Value", @"Count", 5);
+  tweak.currentValue = @7;
+  XCTAssertEqual(FBTweakValue(@"Frozen", @"Value", @"Count", 5), 7);
+
+  store.frozen = YES;
+  XCTAssertTrue(store.isFrozen);
+  XCTAssertEqual(FBTweakValue(@"Frozen", @"Value", @"Count", 5), 5);
+  XCTAssertEqualObjects(FBTweakValue(@"Frozen", @"Value", @"Name", @"default"), @"default");
+  XCTAssertEqual(strcmp(FBTweakValue(@"Frozen", @"Value", @"String", "default"), "default"), 0);
+  XCTAssertEqual(FBTweakInline(@"Frozen", @"Value", @"Count", 5), tweak);
+  XCTAssertEqualObjects(tweak.currentValue, @7);
+
+  FBTweakInline(@"Frozen", @"Value", @"Count", 5).currentValue = @9;
+  XCTAssertEqual(FBTweakValue(@"Frozen", @"Value", @"Count", 5), 5);
+
+  store.frozen = NO;
+  XCTAssertEqual(FBTweakValue(@"Frozen", @"Value", @"Count", 5), 9);
+}
+
+- (void)testFrozenSuspendsBind
+{
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+  NSMutableURLRequest *request = [[NSMutableURLRequest alloc] init];
+  FBTweakBind(request, timeoutInterval, @"Frozen", @"Bind", @"Timeout", 5.0);
+  FBTweak *tweak = FBTweakInline(@"Frozen", @"Bind", @"Timeout", 5.0);
+
+  tweak.currentValue = @20.0;
+  XCTAssertEqual(request.timeoutInterval, (NSTimeInterval)20.0);
+
+  store.frozen = YES;
+  XCTAssertEqual(request.timeoutInterval, (NSTimeInterval)5.0);
+
+  tweak.currentValue = @30.0;
+  XCTAssertEqual(request.timeoutInterval, (NSTimeInterval)5.0);
+
+  store.frozen = NO;
+  XCTAssertEqual(request.timeoutInterval, (NSTimeInterval)30.0);
+}
+
+- (void)testFrozenStoresDefaultsInVariables
+{
+  static double frozenTension;
+  FBTweakStore *store = [FBTweakStore sharedInstance];
+  FBTweakBindVariable(&frozenTension, @"Frozen", @"Variable", @"Tension", 0.5);
+  FBTweak *tweak = FBTweakInline(@"Frozen", @"Variable", @"Tension", 0.5);
+
+  tweak.currentValue = @0.8;
+  XCTAssertEqual(frozenTension, 0.8);
+
+  store.frozen = YES;
+  XCTAssertEqual(frozenTension, 0.5);
+
+  tweak.currentValue = @0.9;
+  XCTAssertEqual(frozenTension, 0.5);
+
+  store.frozen = NO;
+  XCTAssertEqual(frozenTension, 0.9);
+}
+
+- (void)testPerformanceLive
+{
+  XCTAssertEqual(FBTweakFrozenTestsReadValues(), (NSInteger)FBTweakFrozenTestsIterations);
+
+  [self measureBlock:^{
+    FBTweakFrozenTestsReadValues();
+  }];
+}
+
+- (void)testPerformanceFrozen
+{
+  [FBTweakStore sharedInstance].frozen = YES;
+  XCTAssertEqual(FBTweakFrozenTestsReadValues(), (NSInteger)FBTweakFrozenTestsIterations);
+
+  [self measureBlock:^{
+    FBTweakFrozenTestsReadValues();
+  }];
+}
+
+@end
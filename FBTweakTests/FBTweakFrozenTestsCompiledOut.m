@@ -0,0 +1,49 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+// Compiled as a release build would be, to compare with FBTweakFrozenTests.m.
+#undef FB_TWEAK_ENABLED
+#define FB_TWEAK_ENABLED 0
+
+#import "FBTweakInline.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static const NSUInteger FBTweakFrozenTestsCompiledOutIterations = 1000000;
+
+static NSInteger FBTweakFrozenTestsCompiledOutReadValues(void)
+{
+  // Volatile, so each read is kept even when the value is a constant.
+  volatile NSInteger sum = 0;
+  for (NSUInteger i = 0; i < FBTweakFrozenTestsCompiledOutIterations; i++) {
+    sum += FBTweakValue(@"Frozen", @"Benchmark", @"Value", 1);
+  }
+  return sum;
+}
+
+@interface FBTweakFrozenTestsCompiledOut : XCTestCase
+
+@end
+
+@implementation FBTweakFrozenTestsCompiledOut
+
+- (void)testPerformanceCompiledOut
+{
+  XCTAssertEqual(FBTweakFrozenTestsCompiledOutReadValues(), (NSInteger)FBTweakFrozenTestsCompiledOutIterations);
+
+  [self measureBlock:^{
+    FBTweakFrozenTestsCompiledOutReadValues();
+  }];
+}
+
+@end
@@ -0,0 +1,134 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakJournal.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakJournalTests : XCTestCase
+
+@end
+
+@implementation FBTweakJournalTests {
+  FBTweakStore *_store;
+  FBTweak *_tweak;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakJournalTests"];
+  _tweak.name = @"Journal";
+  _tweak.defaultValue = @(1);
+  _tweak.currentValue = nil;
+
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:@"Journal"];
+  [collection addTweak:_tweak];
+  FBTweakCategory *category = [[FBTweakCategory alloc] initWithName:@"Tests"];
+  [category addTweakCollection:collection];
+  _store = [[FBTweakStore alloc] init];
+  [_store addTweakCategory:category];
+}
+
+- (void)tearDown
+{
+  [FBTweakJournal setActiveJournal:nil];
+  _tweak.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (void)testRecordsChangesInOrder
+{
+  FBTweakJournal *journal = [[FBTweakJournal alloc] initWithCapacity:8];
+  [FBTweakJournal setActiveJournal:journal];
+
+  _tweak.currentValue = @(2);
+  _tweak.currentValue = @"three";
+  _tweak.currentValue = nil;
+
+  NSArray *entries = [journal snapshot];
+  XCTAssertEqual(entries.count, (NSUInteger)3, @"entries %@", entries);
+
+  FBTweakJournalEntry *first = entries[0];
+  XCTAssertEqualObjects(first.identifier, _tweak.identifier, @"identifier %@", first.identifier);
+  XCTAssertNil(first.oldValue, @"old %@", first.oldValue);
+  XCTAssertEqualObjects(first.newValue, @(2), @"new %@", first.newValue);
+  XCTAssertTrue(first.threadIdentifier != 0, @"thread %llu", first.threadIdentifier);
+
+  FBTweakJournalEntry *second = entries[1];
+  XCTAssertEqualObjects(second.oldValue, @(2), @"old %@", second.oldValue);
+  XCTAssertEqualObjects(second.newValue, @"three", @"new %@", second.newValue);
+  XCTAssertTrue(second.timestamp >= first.timestamp, @"timestamps %f %f", first.timestamp, second.timestamp);
+
+  FBTweakJournalEntry *third = entries[2];
+  XCTAssertNil(third.newValue, @"new %@", third.newValue);
+}
+
+- (void)testRingKeepsNewestEntries
+{
+  FBTweakJournal *journal = [[FBTweakJournal alloc] initWithCapacity:3];
+  XCTAssertEqual(journal.capacity, (NSUInteger)4, @"capacity %lu", (unsigned long)journal.capacity);
+  [FBTweakJournal setActiveJournal:journal];
+
+  for (NSInteger i = 0; i < 10; i++) {
+    _tweak.currentValue = @(i + 10);
+  }
+
+  NSArray *entries = [journal snapshot];
+  XCTAssertEqual(entries.count, (NSUInteger)4, @"entries %@", entries);
+  XCTAssertEqual([entries[0] sequence], (uint64_t)6, @"entries %@", entries);
+  XCTAssertEqualObjects([entries[3] newValue], @(19), @"entries %@", entries);
+
+  [journal clear];
+  XCTAssertEqual([journal snapshot].count, (NSUInteger)0, @"cleared %@", [journal snapshot]);
+}
+
+- (void)testInactiveJournalRecordsNothing
+{
+  FBTweakJournal *journal = [[FBTweakJournal alloc] initWithCapacity:8];
+  _tweak.currentValue = @(5);
+  XCTAssertEqual([journal snapshot].count, (NSUInteger)0, @"entries %@", [journal snapshot]);
+}
+
+- (void)testExportAndReplay
+{
+  FBTweakJournal *journal = [[FBTweakJournal alloc] initWithCapacity:8];
+  [FBTweakJournal setActiveJournal:journal];
+
+  _tweak.currentValue = @(4);
+  _tweak.currentValue = @(2.5);
+  _tweak.currentValue = [@"" stringByPaddingToLength:64 withString:@"x" startingAtIndex:0];
+  _tweak.currentValue = @[@(1)];
+  [FBTweakJournal setActiveJournal:nil];
+
+  NSData *data = [FBTweakJournal dataWithEntries:[journal snapshot]];
+  NSArray *entries = [FBTweakJournal entriesWithData:data];
+  XCTAssertEqual(entries.count, (NSUInteger)4, @"entries %@", entries);
+  XCTAssertTrue([entries[2] isTruncated], @"entries %@", entries);
+  XCTAssertTrue([entries[3] isTruncated], @"entries %@", entries);
+
+  _tweak.currentValue = nil;
+  NSUInteger applied = [FBTweakJournal replayEntries:entries inStore:_store];
+  XCTAssertEqual(applied, (NSUInteger)2, @"applied %lu", (unsigned long)applied);
+  XCTAssertEqualObjects(_tweak.currentValue, @(2.5), @"value %@", _tweak.currentValue);
+
+  XCTAssertNil([FBTweakJournal entriesWithData:[NSData dataWithBytes:"junk" length:4]], @"malformed");
+}
+
+@end
@@ -0,0 +1,181 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+#import <libkern/OSAtomic.h>
+
+#import "FBTweak.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static void *FBTweakObserverDeliveryTestsQueueKey = &FBTweakObserverDeliveryTestsQueueKey;
+
+@interface FBTweakDeliveryTestObserver : NSObject <FBTweakObserver>
+
+@property (nonatomic, assign) NSTimeInterval delay;
+@property (atomic, assign) NSUInteger changeCount;
+@property (atomic, assign) BOOL overlapped;
+@property (atomic, assign) BOOL offQueue;
+@property (atomic, strong) NSMutableArray *values;
+
+@end
+
+@implementation FBTweakDeliveryTestObserver {
+  volatile int32_t _inside;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _values = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  if (OSAtomicIncrement32Barrier(&_inside) != 1) {
+    self.overlapped = YES;
+  }
+  if (dispatch_get_specific(FBTweakObserverDeliveryTestsQueueKey) == NULL) {
+    self.offQueue = YES;
+  }
+
+  if (_delay > 0) {
+    [NSThread sleepForTimeInterval:_delay];
+  }
+  @synchronized (self) {
+    [_values addObject:tweak.currentValue ?: [NSNull null]];
+  }
+  self.changeCount++;
+
+  OSAtomicDecrement32Barrier(&_inside);
+}
+
+@end
+
+@interface FBTweakObserverDeliveryTests : XCTestCase
+
+@end
+
+@implementation FBTweakObserverDeliveryTests {
+  FBTweak *_tweak;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakObserverDeliveryTests"];
+  _tweak.defaultValue = @(0);
+  _tweak.currentValue = nil;
+}
+
+- (void)tearDown
+{
+  _tweak.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (dispatch_queue_t)_markedQueue:(dispatch_queue_attr_t)attributes
+{
+  dispatch_queue_t queue = dispatch_queue_create("FBTweakObserverDeliveryTests", attributes);
+  dispatch_queue_set_specific(queue, FBTweakObserverDeliveryTestsQueueKey, (__bridge void *)self, NULL);
+  return queue;
+}
+
+- (BOOL)_waitFor:(BOOL (^)(void))condition
+{
+  NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5.0];
+  while (!condition() && [deadline timeIntervalSinceNow] > 0) {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  return condition();
+}
+
+- (void)testAsynchronousDoesNotBlockWriter
+{
+  FBTweakDeliveryTestObserver *observer = [[FBTweakDeliveryTestObserver alloc] init];
+  observer.delay = 0.2;
+  [_tweak addObserver:observer queue:[self _markedQueue:DISPATCH_QUEUE_SERIAL] delivery:FBTweakObserverDeliveryAsynchronous];
+
+  NSDate *start = [NSDate date];
+  _tweak.currentValue = @(1);
+  _tweak.currentValue = @(2);
+  XCTAssertLessThan(-[start timeIntervalSinceNow], 0.1, @"writer blocked");
+
+  XCTAssertTrue([self _waitFor:^{ return (BOOL)(observer.changeCount == 2); }], @"changes %lu", (unsigned long)observer.changeCount);
+  XCTAssertFalse(observer.offQueue, @"delivered off queue");
+}
+
+- (void)testAsynchronousIsOrderedOnConcurrentQueue
+{
+  FBTweakDeliveryTestObserver *observer = [[FBTweakDeliveryTestObserver alloc] init];
+  [_tweak addObserver:observer queue:[self _markedQueue:DISPATCH_QUEUE_CONCURRENT] delivery:FBTweakObserverDeliveryAsynchronous];
+
+  for (NSUInteger i = 1; i <= 100; i++) {
+    _tweak.currentValue = @(i);
+  }
+
+  XCTAssertTrue([self _waitFor:^{ return (BOOL)(observer.changeCount == 100); }], @"changes %lu", (unsigned long)observer.changeCount);
+  XCTAssertFalse(observer.overlapped, @"delivered concurrently");
+  XCTAssertFalse(observer.offQueue, @"delivered off queue");
+}
+
+- (void)testCoalescedDeliversOnce
+{
+  FBTweakDeliveryTestObserver *observer = [[FBTweakDeliveryTestObserver alloc] init];
+  [_tweak addObserver:observer queue:nil delivery:FBTweakObserverDeliveryCoalesced];
+
+  for (NSUInteger i = 1; i <= 10; i++) {
+    _tweak.currentValue = @(i);
+  }
+
+  XCTAssertTrue([self _waitFor:^{ return (BOOL)(observer.changeCount > 0); }], @"not delivered");
+  [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual(observer.changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)observer.changeCount);
+  XCTAssertEqualObjects(observer.values, @[@(10)], @"values %@", observer.values);
+
+  _tweak.currentValue = @(11);
+  XCTAssertTrue([self _waitFor:^{ return (BOOL)(observer.changeCount == 2); }], @"changes %lu", (unsigned long)observer.changeCount);
+}
+
+- (void)testSynchronousOnQueue
+{
+  dispatch_queue_t queue = [self _markedQueue:DISPATCH_QUEUE_SERIAL];
+  FBTweakDeliveryTestObserver *observer = [[FBTweakDeliveryTestObserver alloc] init];
+  [_tweak addObserver:observer queue:queue delivery:FBTweakObserverDeliverySynchronous];
+
+  _tweak.currentValue = @(1);
+  XCTAssertEqual(observer.changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)observer.changeCount);
+  XCTAssertFalse(observer.offQueue, @"delivered off queue");
+
+  // Changing from the observer's own queue doesn't deadlock.
+  dispatch_sync(queue, ^{
+    _tweak.currentValue = @(2);
+  });
+  XCTAssertEqual(observer.changeCount, (NSUInteger)2, @"changes %lu", (unsigned long)observer.changeCount);
+}
+
+- (void)testRemovedObserverIsNotNotified
+{
+  FBTweakDeliveryTestObserver *observer = [[FBTweakDeliveryTestObserver alloc] init];
+  [_tweak addObserver:observer queue:nil delivery:FBTweakObserverDeliveryAsynchronous];
+
+  _tweak.currentValue = @(1);
+  [_tweak removeObserver:observer];
+
+  [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual(observer.changeCount, (NSUInteger)0, @"changes %lu", (unsigned long)observer.changeCount);
+}
+
+@end
@@ -0,0 +1,175 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweakInline.h"
+#import "FBTweakObserverProfiler.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakProfilerTestObserver : NSObject <FBTweakObserver>
+
+@property (nonatomic, assign) NSTimeInterval delay;
+
+@end
+
+@implementation FBTweakProfilerTestObserver
+
+- (void)tweakWillChange:(FBTweak *)tweak
+{
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  if (_delay > 0) {
+    [NSThread sleepForTimeInterval:_delay];
+  }
+}
+
+@end
+
+@interface FBTweakProfilerTestSlowObserver : FBTweakProfilerTestObserver
+
+@end
+
+@implementation FBTweakProfilerTestSlowObserver
+
+@end
+
+@interface FBTweakObserverProfilerTests : XCTestCase
+
+@end
+
+@implementation FBTweakObserverProfilerTests {
+  FBTweakObserverProfiler *_profiler;
+  FBTweak *_tweak;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _profiler = [FBTweakObserverProfiler sharedInstance];
+  _profiler.budget = 0.001;
+  [_profiler reset];
+
+  _tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakObserverProfilerTests"];
+  _tweak.defaultValue = @(0);
+}
+
+- (void)tearDown
+{
+  _profiler.enabled = NO;
+  [_profiler reset];
+
+  [super tearDown];
+}
+
+- (FBTweakObserverProfile *)_profileNamed:(NSString *)name
+{
+  for (FBTweakObserverProfile *profile in [_profiler profiles]) {
+    if ([profile.name isEqualToString:name]) {
+      return profile;
+    }
+  }
+  return nil;
+}
+
+- (void)testDisabledRecordsNothing
+{
+  FBTweakProfilerTestObserver *observer = [[FBTweakProfilerTestObserver alloc] init];
+  [_tweak addObserver:observer];
+
+  XCTAssertFalse(_profiler.enabled);
+  _tweak.currentValue = @(1);
+
+  XCTAssertEqual([_profiler profiles].count, (NSUInteger)0);
+}
+
+- (void)testProfilesByObserverClass
+{
+  FBTweakProfilerTestObserver *fastObserver = [[FBTweakProfilerTestObserver alloc] init];
+  FBTweakProfilerTestSlowObserver *slowObserver = [[FBTweakProfilerTestSlowObserver alloc] init];
+  slowObserver.delay = 0.01;
+  [_tweak addObserver:fastObserver];
+  [_tweak addObserver:slowObserver];
+
+  _profiler.enabled = YES;
+  _tweak.currentValue = @(1);
+  _tweak.currentValue = @(2);
+
+  // Both will and did change are counted.
+  FBTweakObserverProfile *fastProfile = [self _profileNamed:@"FBTweakProfilerTestObserver"];
+  XCTAssertEqual(fastProfile.deliveries, (NSUInteger)4);
+  XCTAssertEqual(fastProfile.slowDeliveries, (NSUInteger)0);
+
+  FBTweakObserverProfile *slowProfile = [self _profileNamed:@"FBTweakProfilerTestSlowObserver"];
+  XCTAssertEqual(slowProfile.deliveries, (NSUInteger)4);
+  XCTAssertEqual(slowProfile.slowDeliveries, (NSUInteger)2);
+  XCTAssertGreaterThanOrEqual(slowProfile.maximumDuration, 0.01);
+  XCTAssertGreaterThanOrEqual(slowProfile.totalDuration, 0.02);
+
+  // Most expensive first.
+  XCTAssertEqualObjects([[_profiler profiles] firstObject].name, @"FBTweakProfilerTestSlowObserver");
+}
+
+- (void)testBudget
+{
+  FBTweakProfilerTestSlowObserver *observer = [[FBTweakProfilerTestSlowObserver alloc] init];
+  observer.delay = 0.01;
+  [_tweak addObserver:observer];
+
+  _profiler.budget = 1.0;
+  _profiler.enabled = YES;
+  _tweak.currentValue = @(1);
+
+  XCTAssertEqual([self _profileNamed:@"FBTweakProfilerTestSlowObserver"].slowDeliveries, (NSUInteger)0);
+}
+
+- (void)testProfilesByBindSite
+{
+  NSMutableURLRequest *request = [[NSMutableURLRequest alloc] init];
+  int line = __LINE__ + 1;
+  FBTweakBind(request, timeoutInterval, @"Profiler", @"Request", @"Timeout", 5.0);
+
+  _profiler.enabled = YES;
+  FBTweakInline(@"Profiler", @"Request", @"Timeout", 5.0).currentValue = @(20.0);
+
+  NSString *name = [NSString stringWithFormat:@"FBTweakBind FBTweakObserverProfilerTests.m:%d", line];
+  XCTAssertEqual([self _profileNamed:name].deliveries, (NSUInteger)1);
+}
+
+- (void)testQueuedObservers
+{
+  FBTweakProfilerTestObserver *observer = [[FBTweakProfilerTestObserver alloc] init];
+  [_tweak addObserver:observer queue:nil delivery:FBTweakObserverDeliverySynchronous];
+
+  _profiler.enabled = YES;
+  _tweak.currentValue = @(1);
+
+  XCTAssertEqual([self _profileNamed:@"FBTweakProfilerTestObserver (queued)"].deliveries, (NSUInteger)2);
+}
+
+- (void)testReset
+{
+  FBTweakProfilerTestObserver *observer = [[FBTweakProfilerTestObserver alloc] init];
+  [_tweak addObserver:observer];
+
+  _profiler.enabled = YES;
+  _tweak.currentValue = @(1);
+  XCTAssertNotNil([self _profileNamed:@"FBTweakProfilerTestObserver"]);
+
+  [_profiler reset];
+  XCTAssertEqual([_profiler profiles].count, (NSUInteger)0);
+}
+
+@end
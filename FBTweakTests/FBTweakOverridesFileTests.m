@@ -0,0 +1,151 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakOverridesFileTests : XCTestCase <FBTweakObserver>
+
+@end
+
+@implementation FBTweakOverridesFileTests {
+  NSString *_directory;
+  NSString *_path;
+  FBTweakStore *_store;
+  FBTweak *_speed;
+  FBTweak *_title;
+  NSUInteger _changeCount;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  [[NSFileManager defaultManager] createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:NULL];
+  _path = [_directory stringByAppendingPathComponent:@"overrides"];
+
+  _speed = [[FBTweak alloc] initWithIdentifier:@"FBTweakOverridesFileTests.speed"];
+  _speed.defaultValue = @(1.0);
+  _speed.currentValue = nil;
+  [_speed addObserver:self];
+
+  _title = [[FBTweak alloc] initWithIdentifier:@"FBTweakOverridesFileTests.title"];
+  _title.defaultValue = @"Title";
+  _title.currentValue = nil;
+
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:@"Overrides"];
+  [collection addTweak:_speed];
+  [collection addTweak:_title];
+  FBTweakCategory *category = [[FBTweakCategory alloc] initWithName:@"Tests"];
+  [category addTweakCollection:collection];
+  _store = [[FBTweakStore alloc] init];
+  [_store addTweakCategory:category];
+
+  _changeCount = 0;
+}
+
+- (void)tearDown
+{
+  [_store stopWatchingOverridesFile];
+  _speed.currentValue = nil;
+  _title.currentValue = nil;
+  [[NSFileManager defaultManager] removeItemAtPath:_directory error:NULL];
+
+  [super tearDown];
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  _changeCount++;
+}
+
+- (BOOL)_waitFor:(BOOL (^)(void))condition
+{
+  NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5.0];
+  while (!condition() && [deadline timeIntervalSinceNow] > 0) {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  return condition();
+}
+
+- (void)_settle
+{
+  [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+}
+
+- (void)testAppliesExistingFile
+{
+  [@"# comment\nFBTweakOverridesFileTests.speed = 2.5\nFBTweakOverridesFileTests.title = \"Fast\"\n" writeToFile:_path atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+
+  NSError *error = nil;
+  XCTAssertTrue([_store watchOverridesFileAtPath:_path error:&error], @"error %@", error);
+  XCTAssertTrue([self _waitFor:^{ return [_title.currentValue isEqual:@"Fast"]; }], @"title %@", _title.currentValue);
+  XCTAssertEqualObjects(_speed.currentValue, @(2.5), @"speed %@", _speed.currentValue);
+}
+
+- (void)testAtomicReplaceAppliesOnlyChanges
+{
+  XCTAssertTrue([_store watchOverridesFileAtPath:_path error:NULL], @"watch");
+
+  [@"FBTweakOverridesFileTests.speed = 2\nFBTweakOverridesFileTests.title = \"A\"\n" writeToFile:_path atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertTrue([self _waitFor:^{ return [_title.currentValue isEqual:@"A"]; }], @"title %@", _title.currentValue);
+  XCTAssertEqual(_changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)_changeCount);
+
+  // Only the title changed, so the speed observer isn't told again.
+  [@"FBTweakOverridesFileTests.speed = 2\nFBTweakOverridesFileTests.title = \"B\"\n" writeToFile:_path atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertTrue([self _waitFor:^{ return [_title.currentValue isEqual:@"B"]; }], @"title %@", _title.currentValue);
+  XCTAssertEqual(_changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)_changeCount);
+
+  // Removing a record resets its tweak.
+  [@"FBTweakOverridesFileTests.speed = 2\n" writeToFile:_path atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertTrue([self _waitFor:^{ return (BOOL)(_title.currentValue == nil); }], @"title %@", _title.currentValue);
+  XCTAssertEqualObjects(_speed.currentValue, @(2), @"speed %@", _speed.currentValue);
+}
+
+- (void)testIgnoresIncompleteLines
+{
+  XCTAssertTrue([_store watchOverridesFileAtPath:_path error:NULL], @"watch");
+
+  [[NSFileManager defaultManager] createFileAtPath:_path contents:nil attributes:nil];
+  NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:_path];
+  [handle writeData:[@"FBTweakOverridesFileTests.title = \"Half" dataUsingEncoding:NSUTF8StringEncoding]];
+  [handle synchronizeFile];
+  [self _settle];
+  XCTAssertNil(_title.currentValue, @"title %@", _title.currentValue);
+
+  [handle writeData:[@" done\"\n" dataUsingEncoding:NSUTF8StringEncoding]];
+  [handle closeFile];
+  XCTAssertTrue([self _waitFor:^{ return [_title.currentValue isEqual:@"Half done"]; }], @"title %@", _title.currentValue);
+}
+
+- (void)testSkipsMalformedRecords
+{
+  [@"FBTweakOverridesFileTests.speed = [1, 2]\nFBTweakOverridesFileTests.title = \"Ok\"\n" writeToFile:_path atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+  XCTAssertTrue([_store watchOverridesFileAtPath:_path error:NULL], @"watch");
+  XCTAssertTrue([self _waitFor:^{ return [_title.currentValue isEqual:@"Ok"]; }], @"title %@", _title.currentValue);
+  XCTAssertNil(_speed.currentValue, @"speed %@", _speed.currentValue);
+}
+
+- (void)testMissingDirectoryFails
+{
+  NSError *error = nil;
+  XCTAssertFalse([_store watchOverridesFileAtPath:[_path stringByAppendingPathComponent:@"missing/overrides"] error:&error], @"watched");
+  XCTAssertEqualObjects(error.domain, NSPOSIXErrorDomain, @"error %@", error);
+}
+
+@end
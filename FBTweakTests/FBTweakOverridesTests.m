@@ -0,0 +1,113 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakOverridesTests : XCTestCase <FBTweakObserver>
+
+@end
+
+@implementation FBTweakOverridesTests {
+  FBTweak *_tweak;
+  NSUInteger _changeCount;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakOverridesTests.speed"];
+  _tweak.defaultValue = @(1);
+  _tweak.currentValue = @(2);
+  [_tweak addObserver:self];
+
+  _changeCount = 0;
+}
+
+- (void)tearDown
+{
+  [_tweak removeObserver:self];
+  _tweak.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  _changeCount++;
+}
+
+- (void)testOverrideIsScopedToBlock
+{
+  NSData *persisted = [[NSUserDefaults standardUserDefaults] objectForKey:_tweak.identifier];
+
+  [FBTweakStore withOverrides:^{
+    _tweak.currentValue = @(3);
+    XCTAssertEqualObjects(_tweak.currentValue, @(3), @"value %@", _tweak.currentValue);
+
+    _tweak.currentValue = nil;
+    XCTAssertNil(_tweak.currentValue, @"value %@", _tweak.currentValue);
+  }];
+
+  XCTAssertEqualObjects(_tweak.currentValue, @(2), @"value %@", _tweak.currentValue);
+  XCTAssertEqualObjects([[NSUserDefaults standardUserDefaults] objectForKey:_tweak.identifier], persisted, @"persisted");
+}
+
+- (void)testOverrideIsInvisibleToOtherThreads
+{
+  [FBTweakStore withOverrides:^{
+    _tweak.currentValue = @(3);
+
+    __block FBTweakValue otherValue = nil;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    [NSThread detachNewThreadWithBlock:^{
+      otherValue = _tweak.currentValue;
+      dispatch_semaphore_signal(done);
+    }];
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+
+    XCTAssertEqualObjects(otherValue, @(2), @"other thread %@", otherValue);
+  }];
+}
+
+- (void)testNestedOverridesInherit
+{
+  [FBTweakStore withOverrides:^{
+    _tweak.currentValue = @(3);
+
+    [FBTweakStore withOverrides:^{
+      XCTAssertEqualObjects(_tweak.currentValue, @(3), @"inherited %@", _tweak.currentValue);
+      _tweak.currentValue = @(4);
+      XCTAssertEqualObjects(_tweak.currentValue, @(4), @"inner %@", _tweak.currentValue);
+    }];
+
+    XCTAssertEqualObjects(_tweak.currentValue, @(3), @"outer %@", _tweak.currentValue);
+  }];
+
+  XCTAssertEqualObjects(_tweak.currentValue, @(2), @"global %@", _tweak.currentValue);
+}
+
+- (void)testObserversNotToldAboutOverrides
+{
+  [FBTweakStore withOverrides:^{
+    _tweak.currentValue = @(3);
+    XCTAssertEqual(_changeCount, (NSUInteger)0, @"changes %lu", (unsigned long)_changeCount);
+  }];
+
+  XCTAssertEqual(_changeCount, (NSUInteger)0, @"changes %lu", (unsigned long)_changeCount);
+}
+
+@end
@@ -0,0 +1,170 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+#import <UIKit/UIKit.h>
+
+#import "FBTweak.h"
+#import "_FBTweakPersistedValue.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static NSString *const FBTweakPersistedValueTestsIdentifier = @"FBTweak:FBTweakPersistedValueTests-Migration";
+
+@interface FBTweakPersistedValueTests : XCTestCase
+
+@end
+
+@implementation FBTweakPersistedValueTests
+
+- (void)tearDown
+{
+  [[NSUserDefaults standardUserDefaults] removeObjectForKey:FBTweakPersistedValueTestsIdentifier];
+
+  [super tearDown];
+}
+
+- (void)testSavesValuesByKind
+{
+  XCTAssertEqualObjects(_FBTweakPersistedObjectForValue(@42), @42);
+  XCTAssertEqualObjects(_FBTweakPersistedObjectForValue(@YES), @YES);
+  XCTAssertEqualObjects(_FBTweakPersistedObjectForValue(@"text"), @"text");
+  XCTAssertNil(_FBTweakPersistedObjectForValue(nil));
+
+  UIColor *color = [UIColor colorWithRed:0.25 green:0.5 blue:0.75 alpha:1.0];
+  NSData *colorData = _FBTweakPersistedObjectForValue(color);
+  XCTAssertEqual(colorData.length, (NSUInteger)17, @"color %@", colorData);
+
+  BOOL migrate = YES;
+  UIColor *readColor = _FBTweakValueForPersistedObject(colorData, &migrate);
+  XCTAssertFalse(migrate);
+  CGFloat red, green, blue, alpha;
+  XCTAssertTrue([readColor getRed:&red green:&green blue:&blue alpha:&alpha], @"color %@", readColor);
+  XCTAssertEqualWithAccuracy(red, 0.25, 0.0001);
+  XCTAssertEqualWithAccuracy(green, 0.5, 0.0001);
+  XCTAssertEqualWithAccuracy(blue, 0.75, 0.0001);
+  XCTAssertEqualWithAccuracy(alpha, 1.0, 0.0001);
+}
+
+- (void)testArchivesOtherValues
+{
+  NSDate *date = [NSDate dateWithTimeIntervalSince1970:1000];
+  id object = _FBTweakPersistedObjectForValue(date);
+  XCTAssertTrue([object isKindOfClass:[NSData class]], @"object %@", object);
+
+  BOOL migrate = YES;
+  XCTAssertEqualObjects(_FBTweakValueForPersistedObject(object, &migrate), date);
+  XCTAssertFalse(migrate);
+}
+
+- (void)testMigratesArchivedValues
+{
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  [defaults setObject:[NSKeyedArchiver archivedDataWithRootObject:@"archived"] forKey:FBTweakPersistedValueTestsIdentifier];
+
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:FBTweakPersistedValueTestsIdentifier];
+  XCTAssertEqualObjects(tweak.currentValue, @"archived");
+  XCTAssertEqualObjects([defaults objectForKey:FBTweakPersistedValueTestsIdentifier], @"archived");
+
+  tweak.currentValue = nil;
+  XCTAssertNil([defaults objectForKey:FBTweakPersistedValueTestsIdentifier]);
+}
+
+#pragma mark Benchmarks
+
+- (void)_measureWritingValue:(FBTweakValue)value
+{
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      @autoreleasepool {
+        _FBTweakPersistedObjectForValue(value);
+      }
+    }
+  }];
+}
+
+- (void)_measureReadingValue:(FBTweakValue)value
+{
+  id object = _FBTweakPersistedObjectForValue(value);
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      @autoreleasepool {
+        _FBTweakValueForPersistedObject(object, NULL);
+      }
+    }
+  }];
+}
+
+- (void)testWritingNumberPerformance
+{
+  [self _measureWritingValue:@3.5];
+}
+
+- (void)testReadingNumberPerformance
+{
+  [self _measureReadingValue:@3.5];
+}
+
+- (void)testWritingBoolPerformance
+{
+  [self _measureWritingValue:@YES];
+}
+
+- (void)testReadingBoolPerformance
+{
+  [self _measureReadingValue:@YES];
+}
+
+- (void)testWritingStringPerformance
+{
+  [self _measureWritingValue:@"Tweaks"];
+}
+
+- (void)testReadingStringPerformance
+{
+  [self _measureReadingValue:@"Tweaks"];
+}
+
+- (void)testWritingColorPerformance
+{
+  [self _measureWritingValue:[UIColor orangeColor]];
+}
+
+- (void)testReadingColorPerformance
+{
+  [self _measureReadingValue:[UIColor orangeColor]];
+}
+
+// What every value cost before, for comparison.
+- (void)testWritingArchivedNumberPerformance
+{
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      @autoreleasepool {
+        [NSKeyedArchiver archivedDataWithRootObject:@3.5];
+      }
+    }
+  }];
+}
+
+- (void)testReadingArchivedNumberPerformance
+{
+  NSData *data = [NSKeyedArchiver archivedDataWithRootObject:@3.5];
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 10000; i++) {
+      @autoreleasepool {
+        _FBTweakValueForPersistedObject(data, NULL);
+      }
+    }
+  }];
+}
+
+@end
@@ -0,0 +1,156 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "_FBTweakCollection.h"
+#import "_FBTweakPossibleValues.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakPossibleValuesTestsProvider : NSObject <FBTweakPossibleValuesProvider>
+@property (nonatomic, assign) NSUInteger count;
+@property (nonatomic, strong) NSMutableArray *requestedRanges;
+@end
+
+@implementation FBTweakPossibleValuesTestsProvider
+
+- (instancetype)initWithCount:(NSUInteger)count
+{
+  if ((self = [super init])) {
+    _count = count;
+    _requestedRanges = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (NSUInteger)numberOfValues
+{
+  return _count;
+}
+
+- (NSArray *)valuesInRange:(NSRange)range
+{
+  [_requestedRanges addObject:[NSValue valueWithRange:range]];
+
+  NSMutableArray *values = [[NSMutableArray alloc] initWithCapacity:range.length];
+  for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+    [values addObject:@(i * 2)];
+  }
+  return values;
+}
+
+- (BOOL)containsValue:(FBTweakValue)value
+{
+  return ([value unsignedIntegerValue] % 2 == 0 && [value unsignedIntegerValue] < _count * 2);
+}
+
+- (NSString *)titleForValue:(FBTweakValue)value
+{
+  return [NSString stringWithFormat:@"Even %@", value];
+}
+
+@end
+
+@interface FBTweakPossibleValuesTests : XCTestCase
+
+@end
+
+@implementation FBTweakPossibleValuesTests
+
+- (FBTweak *)_tweak
+{
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakPossibleValuesTests"];
+  tweak.defaultValue = @0;
+  tweak.currentValue = nil;
+  return tweak;
+}
+
+- (void)testBlockRunsWhenFirstRead
+{
+  FBTweak *tweak = [self _tweak];
+
+  __block NSUInteger runs = 0;
+  [tweak _setPossibleValuesBlock:^id{
+    runs++;
+    return @[@0, @1, @2];
+  }];
+  XCTAssertEqual(runs, (NSUInteger)0);
+
+  XCTAssertEqualObjects(tweak.possibleValues, (@[@0, @1, @2]));
+  XCTAssertEqualObjects(tweak.possibleValues, (@[@0, @1, @2]));
+  XCTAssertEqual(runs, (NSUInteger)1);
+}
+
+- (void)testSettingReplacesBlock
+{
+  FBTweak *tweak = [self _tweak];
+
+  __block BOOL ran = NO;
+  [tweak _setPossibleValuesBlock:^id{
+    ran = YES;
+    return @[@0];
+  }];
+  tweak.possibleValues = @[@1];
+
+  XCTAssertEqualObjects(tweak.possibleValues, (@[@1]));
+  XCTAssertFalse(ran);
+}
+
+- (void)testProviderLimitsValues
+{
+  FBTweak *tweak = [self _tweak];
+  tweak.possibleValues = [[FBTweakPossibleValuesTestsProvider alloc] initWithCount:1000];
+
+  tweak.currentValue = @1998;
+  XCTAssertEqualObjects(tweak.currentValue, @1998);
+
+  tweak.currentValue = @3;
+  XCTAssertEqualObjects(tweak.currentValue, @0);
+}
+
+- (void)testPagerReadsPages
+{
+  FBTweakPossibleValuesTestsProvider *provider = [[FBTweakPossibleValuesTestsProvider alloc] initWithCount:100];
+  _FBTweakPossibleValuesPager *pager = [[_FBTweakPossibleValuesPager alloc] initWithProvider:provider];
+
+  XCTAssertEqual(pager.count, (NSUInteger)100);
+  XCTAssertEqual(provider.requestedRanges.count, (NSUInteger)0);
+
+  XCTAssertEqualObjects([pager valueAtIndex:99], @198);
+  XCTAssertEqualObjects([pager titleAtIndex:98], @"Even 196");
+  XCTAssertEqualObjects([pager valueAtIndex:0], @0);
+  XCTAssertEqualObjects([pager valueAtIndex:1], @2);
+
+  NSArray *expectedRanges = @[[NSValue valueWithRange:NSMakeRange(64, 36)], [NSValue valueWithRange:NSMakeRange(0, 64)]];
+  XCTAssertEqualObjects(provider.requestedRanges, expectedRanges);
+}
+
+- (void)testDictionarySortedByTitle
+{
+  NSDictionary *titles = @{@"b": @"Apple", @"a": @"Cherry", @"c": @"Banana"};
+  _FBTweakPossibleValuesPager *pager = [[_FBTweakPossibleValuesPager alloc] initWithProvider:_FBTweakPossibleValuesProvider(titles)];
+
+  XCTAssertEqual(pager.count, (NSUInteger)3);
+  XCTAssertEqualObjects([pager valueAtIndex:0], @"b");
+  XCTAssertEqualObjects([pager valueAtIndex:1], @"c");
+  XCTAssertEqualObjects([pager valueAtIndex:2], @"a");
+  XCTAssertEqualObjects([pager titleAtIndex:2], @"Cherry");
+}
+
+- (void)testArrayTitles
+{
+  XCTAssertEqualObjects(_FBTweakPossibleValuesTitle(@[@1, @2], @2), @"2");
+  XCTAssertEqualObjects(_FBTweakPossibleValuesTitle(@{@1: @"One"}, @1), @"One");
+}
+
+@end
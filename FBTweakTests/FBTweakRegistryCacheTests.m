@@ -0,0 +1,95 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "_FBTweakRegistryCache.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static const uint8_t FBTweakRegistryCacheTestsUUID[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+@interface FBTweakRegistryCacheTests : XCTestCase
+
+@end
+
+@implementation FBTweakRegistryCacheTests {
+  NSData *_data;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _FBTweakRegistryCacheEntry entries[] = {
+    { 0x1111, 0, 0 },
+    { 0x2222, 1, _FBTweakRegistryCacheEntryC },
+    { 0x3333, 0, 0 },
+  };
+  _data = [_FBTweakRegistryCache dataWithUUID:FBTweakRegistryCacheTestsUUID
+                                categoryNames:@[@"Display", @"Physics"]
+                              collectionNames:@[@"Text", @"Spring é"]
+                                      entries:entries
+                                        count:3];
+}
+
+- (void)testRoundTrip
+{
+  _FBTweakRegistryCache *cache = [[_FBTweakRegistryCache alloc] initWithData:_data UUID:FBTweakRegistryCacheTestsUUID entryCount:3];
+  XCTAssertNotNil(cache);
+
+  XCTAssertEqual(cache.collectionCount, (NSUInteger)2);
+  XCTAssertEqualObjects([cache categoryNameAtIndex:0], @"Display");
+  XCTAssertEqualObjects([cache collectionNameAtIndex:0], @"Text");
+  XCTAssertEqualObjects([cache categoryNameAtIndex:1], @"Physics");
+  XCTAssertEqualObjects([cache collectionNameAtIndex:1], @"Spring é");
+
+  XCTAssertEqual(cache.entries[1].identifierHash, (uint64_t)0x2222);
+  XCTAssertEqual(cache.entries[1].collection, (uint32_t)1);
+  XCTAssertEqual(cache.entries[1].flags, (uint32_t)_FBTweakRegistryCacheEntryC);
+  XCTAssertEqual(cache.entries[2].identifierHash, (uint64_t)0x3333);
+}
+
+- (void)testMappedFile
+{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"FBTweakRegistryCacheTests.fbtweakregistry"];
+  XCTAssertTrue([_data writeToFile:path atomically:YES]);
+
+  NSData *mapped = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:NULL];
+  _FBTweakRegistryCache *cache = [[_FBTweakRegistryCache alloc] initWithData:mapped UUID:FBTweakRegistryCacheTestsUUID entryCount:3];
+  XCTAssertEqual(cache.entries[0].identifierHash, (uint64_t)0x1111);
+
+  [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+}
+
+- (void)testOtherBinaryIsRejected
+{
+  uint8_t otherUUID[16];
+  memcpy(otherUUID, FBTweakRegistryCacheTestsUUID, sizeof(otherUUID));
+  otherUUID[15] = 0;
+
+  XCTAssertNil([[_FBTweakRegistryCache alloc] initWithData:_data UUID:otherUUID entryCount:3]);
+  XCTAssertNil([[_FBTweakRegistryCache alloc] initWithData:_data UUID:FBTweakRegistryCacheTestsUUID entryCount:4]);
+}
+
+- (void)testMalformedIsRejected
+{
+  XCTAssertNil([[_FBTweakRegistryCache alloc] initWithData:nil UUID:FBTweakRegistryCacheTestsUUID entryCount:3]);
+
+  NSData *truncated = [_data subdataWithRange:NSMakeRange(0, _data.length - 1)];
+  XCTAssertNil([[_FBTweakRegistryCache alloc] initWithData:truncated UUID:FBTweakRegistryCacheTestsUUID entryCount:3]);
+
+  _FBTweakRegistryCacheEntry entry = { 0x1111, 5, 0 };
+  NSData *badCollection = [_FBTweakRegistryCache dataWithUUID:FBTweakRegistryCacheTestsUUID categoryNames:@[@"Display"] collectionNames:@[@"Text"] entries:&entry count:1];
+  XCTAssertNil([[_FBTweakRegistryCache alloc] initWithData:badCollection UUID:FBTweakRegistryCacheTestsUUID entryCount:1]);
+}
+
+@end
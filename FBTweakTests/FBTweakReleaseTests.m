@@ -0,0 +1,145 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+#import <dlfcn.h>
+#import <mach-o/getsect.h>
+
+// Compiled as a release build would be, where only release tweaks are live.
+#undef FB_TWEAK_ENABLED
+#define FB_TWEAK_ENABLED 0
+
+#import "FBTweakInline.h"
+#import "_FBTweakRelease.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+static double FBTweakReleaseTestsDuration(void)
+{
+  return FBTweakReleaseValue(@"Release", @"Animation", @"Duration", 0.25);
+}
+
+static double FBTweakReleaseTestsDurationAgain(void)
+{
+  return FBTweakReleaseValue(@"Release", @"Animation", @"Duration", 0.25);
+}
+
+static NSInteger FBTweakReleaseTestsCount(void)
+{
+  return FBTweakReleaseValue(@"Release", @"List", @"Count", (NSInteger)10, 1, 100);
+}
+
+static BOOL FBTweakReleaseTestsEnabled(void)
+{
+  return FBTweakReleaseValue(@"Release", @"List", @"Enabled", NO);
+}
+
+static NSString *FBTweakReleaseTestsTitle(void)
+{
+  return FBTweakReleaseValue(@"Release", @"List", @"Title", @"Title");
+}
+
+static const char *FBTweakReleaseTestsName(void)
+{
+  return FBTweakReleaseValue(@"Release", @"List", @"Name", "name");
+}
+
+// Resolves the release tweaks in this test bundle, as is done at launch.
+static void FBTweakReleaseTestsResolve(NSDictionary *overrides)
+{
+  Dl_info info;
+  dladdr((const void *)&FBTweakReleaseTestsResolve, &info);
+
+  unsigned long size = 0;
+#ifdef __LP64__
+  const struct mach_header_64 *header = info.dli_fbase;
+#else
+  const struct mach_header *header = info.dli_fbase;
+#endif
+  fb_tweak_release_entry *entries = (fb_tweak_release_entry *)getsectiondata(header, FBTweakSegmentName, FBTweakReleaseSectionName, &size);
+
+  _FBTweakReleaseResolveEntries(entries, size / sizeof(fb_tweak_release_entry), overrides);
+}
+
+@interface FBTweakReleaseTests : XCTestCase
+
+@end
+
+@implementation FBTweakReleaseTests
+
+- (void)tearDown
+{
+  FBTweakReleaseTestsResolve(@{});
+  [super tearDown];
+}
+
+- (void)testDefaults
+{
+  FBTweakReleaseTestsResolve(@{});
+
+  XCTAssertEqual(FBTweakReleaseTestsDuration(), 0.25);
+  XCTAssertEqual(FBTweakReleaseTestsCount(), 10);
+  XCTAssertFalse(FBTweakReleaseTestsEnabled());
+  XCTAssertEqualObjects(FBTweakReleaseTestsTitle(), @"Title");
+  XCTAssertEqual(strcmp(FBTweakReleaseTestsName(), "name"), 0);
+}
+
+- (void)testOverrides
+{
+  FBTweakReleaseTestsResolve(@{
+    @"FBTweak:Release-Animation-Duration": @0.5,
+    @"FBTweak:Release-List-Count": @42,
+    @"FBTweak:Release-List-Enabled": @YES,
+    @"FBTweak:Release-List-Title": @"Overridden",
+    @"FBTweak:Release-List-Name": @"overridden",
+  });
+
+  XCTAssertEqual(FBTweakReleaseTestsDuration(), 0.5);
+  XCTAssertEqual(FBTweakReleaseTestsDurationAgain(), 0.5);
+  XCTAssertEqual(FBTweakReleaseTestsCount(), 42);
+  XCTAssertTrue(FBTweakReleaseTestsEnabled());
+  XCTAssertEqualObjects(FBTweakReleaseTestsTitle(), @"Overridden");
+  XCTAssertEqual(strcmp(FBTweakReleaseTestsName(), "overridden"), 0);
+
+  // Resolving again without overrides goes back to the defaults.
+  FBTweakReleaseTestsResolve(@{});
+  XCTAssertEqual(FBTweakReleaseTestsDuration(), 0.25);
+  XCTAssertEqualObjects(FBTweakReleaseTestsTitle(), @"Title");
+}
+
+- (void)testMismatchedOverridesKeepDefaults
+{
+  FBTweakReleaseTestsResolve(@{
+    @"FBTweak:Release-Animation-Duration": @"fast",
+    @"FBTweak:Release-List-Title": [NSNull null],
+    @"FBTweak:Release-List-Name": @7,
+  });
+
+  XCTAssertEqual(FBTweakReleaseTestsDuration(), 0.25);
+  XCTAssertEqualObjects(FBTweakReleaseTestsTitle(), @"Title");
+  XCTAssertEqual(strcmp(FBTweakReleaseTestsName(), "name"), 0);
+}
+
+- (void)testPerformanceRelease
+{
+  FBTweakReleaseTestsResolve(@{@"FBTweak:Release-Animation-Duration": @0.5});
+
+  [self measureBlock:^{
+    // Volatile, so each read is kept.
+    volatile double sum = 0;
+    for (NSUInteger i = 0; i < 1000000; i++) {
+      sum += FBTweakReleaseTestsDuration();
+    }
+    XCTAssertEqual(sum, 500000.0);
+  }];
+}
+
+@end
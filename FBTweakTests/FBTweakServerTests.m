@@ -0,0 +1,263 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <arpa/inet.h>
+#import <unistd.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakServer.h"
+#import "_FBTweakBinaryCoding.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakServerTestObserver : NSObject <FBTweakObserver>
+
+@property (nonatomic, assign, readwrite) NSUInteger changeCount;
+
+@end
+
+@implementation FBTweakServerTestObserver
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  self.changeCount++;
+}
+
+@end
+
+static NSData *FBTweakServerTestFrame(FBTweakServerOpcode opcode, uint32_t tag, NSData *payload)
+{
+  NSMutableData *frame = [[NSMutableData alloc] init];
+  _FBTweakBinaryAppendUInt32(frame, (uint32_t)(sizeof(uint8_t) + sizeof(uint32_t) + payload.length));
+  _FBTweakBinaryAppendUInt8(frame, opcode);
+  _FBTweakBinaryAppendUInt32(frame, tag);
+  [frame appendData:payload];
+  return frame;
+}
+
+// Reads a single frame, blocking. Returns the payload.
+static NSData *FBTweakServerTestReadFrame(int fileDescriptor, FBTweakServerOpcode *opcode, uint32_t *tag)
+{
+  uint8_t header[9];
+  if (recv(fileDescriptor, header, sizeof(header), MSG_WAITALL) != sizeof(header)) {
+    return nil;
+  }
+
+  _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(header, sizeof(header));
+  uint32_t length = _FBTweakBinaryReadUInt32(&reader);
+  *opcode = _FBTweakBinaryReadUInt8(&reader);
+  *tag = _FBTweakBinaryReadUInt32(&reader);
+
+  NSMutableData *payload = [[NSMutableData alloc] initWithLength:length - 5];
+  if (payload.length > 0 && recv(fileDescriptor, payload.mutableBytes, payload.length, MSG_WAITALL) != (ssize_t)payload.length) {
+    return nil;
+  }
+  return payload;
+}
+
+@interface FBTweakServerTests : XCTestCase
+
+@end
+
+@implementation FBTweakServerTests {
+  FBTweakStore *_store;
+  FBTweak *_duration;
+  FBTweak *_title;
+  FBTweakServer *_server;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _duration = [[FBTweak alloc] initWithIdentifier:@"FBTweakServerTests-Duration"];
+  _duration.name = @"Duration";
+  _duration.defaultValue = @(0.5);
+  _duration.possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:@(0.0) maximumValue:@(2.0)];
+  _duration.currentValue = nil;
+
+  _title = [[FBTweak alloc] initWithIdentifier:@"FBTweakServerTests-Title"];
+  _title.name = @"Title";
+  _title.defaultValue = @"Tweaks";
+  _title.currentValue = nil;
+
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:@"Server"];
+  [collection addTweak:_duration];
+  [collection addTweak:_title];
+
+  FBTweakCategory *category = [[FBTweakCategory alloc] initWithName:@"Tests"];
+  [category addTweakCollection:collection];
+
+  _store = [[FBTweakStore alloc] init];
+  [_store addTweakCategory:category];
+
+  _server = [[FBTweakServer alloc] initWithStore:_store port:0];
+  NSError *error = nil;
+  XCTAssertTrue([_server startWithError:&error], @"start failed %@", error);
+  XCTAssertNotEqual(_server.port, (uint16_t)0, @"port %d", _server.port);
+}
+
+- (void)tearDown
+{
+  [_server stop];
+  _duration.currentValue = nil;
+  _title.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (int)_connect
+{
+  int fileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address = {0};
+  address.sin_len = sizeof(address);
+  address.sin_family = AF_INET;
+  address.sin_port = htons(_server.port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  XCTAssertEqual(connect(fileDescriptor, (struct sockaddr *)&address, sizeof(address)), 0, @"connect %d", errno);
+  return fileDescriptor;
+}
+
+// Requests are answered on the main queue, so the client runs on a
+// background queue while the test waits on the main run loop.
+- (void)_runClient:(void (^)(int fileDescriptor))client
+{
+  int fileDescriptor = [self _connect];
+  XCTestExpectation *expectation = [self expectationWithDescription:@"client"];
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    client(fileDescriptor);
+    close(fileDescriptor);
+    [expectation fulfill];
+  });
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testPipelinedListWriteRead
+{
+  FBTweakServerTestObserver *observer = [[FBTweakServerTestObserver alloc] init];
+  [_duration addObserver:observer];
+
+  __block uint32_t listCount = 0;
+  __block NSString *firstIdentifier = nil;
+  __block uint32_t writtenCount = 0;
+  __block FBTweakValue readDuration = nil;
+  __block FBTweakValue readTitle = nil;
+  __block NSArray *tags = nil;
+
+  [self _runClient:^(int fileDescriptor) {
+    NSMutableData *requests = [[NSMutableData alloc] init];
+    [requests appendData:FBTweakServerTestFrame(FBTweakServerOpcodeList, 1, nil)];
+
+    // Two writes to the same tweak in one batch.
+    NSMutableData *write = [[NSMutableData alloc] init];
+    _FBTweakBinaryAppendUInt32(write, 3);
+    _FBTweakBinaryAppendString(write, _duration.identifier);
+    _FBTweakBinaryAppendValue(write, @(1.0));
+    _FBTweakBinaryAppendString(write, _duration.identifier);
+    _FBTweakBinaryAppendValue(write, @(1.5));
+    _FBTweakBinaryAppendString(write, _title.identifier);
+    _FBTweakBinaryAppendValue(write, @"Remote");
+    [requests appendData:FBTweakServerTestFrame(FBTweakServerOpcodeWrite, 2, write)];
+
+    NSMutableData *read = [[NSMutableData alloc] init];
+    _FBTweakBinaryAppendUInt32(read, 2);
+    _FBTweakBinaryAppendString(read, _duration.identifier);
+    _FBTweakBinaryAppendString(read, _title.identifier);
+    [requests appendData:FBTweakServerTestFrame(FBTweakServerOpcodeRead, 3, read)];
+
+    // Send all three requests before reading any response.
+    send(fileDescriptor, requests.bytes, requests.length, 0);
+
+    NSMutableArray *receivedTags = [[NSMutableArray alloc] init];
+    for (NSUInteger i = 0; i < 3; i++) {
+      FBTweakServerOpcode opcode;
+      uint32_t tag;
+      NSData *payload = FBTweakServerTestReadFrame(fileDescriptor, &opcode, &tag);
+      [receivedTags addObject:@(tag)];
+
+      _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(payload.bytes, payload.length);
+      if (opcode == FBTweakServerOpcodeList) {
+        listCount = _FBTweakBinaryReadUInt32(&reader);
+        firstIdentifier = _FBTweakBinaryReadString(&reader);
+      } else if (opcode == FBTweakServerOpcodeWrite) {
+        writtenCount = _FBTweakBinaryReadUInt32(&reader);
+      } else if (opcode == FBTweakServerOpcodeRead) {
+        _FBTweakBinaryReadUInt32(&reader);
+        readDuration = _FBTweakBinaryReadValue(&reader);
+        readTitle = _FBTweakBinaryReadValue(&reader);
+      }
+    }
+    tags = receivedTags;
+  }];
+
+  XCTAssertEqualObjects(tags, (@[@1, @2, @3]), @"tags %@", tags);
+  XCTAssertEqual(listCount, (uint32_t)2, @"list count %u", listCount);
+  XCTAssertEqualObjects(firstIdentifier, _duration.identifier, @"identifier %@", firstIdentifier);
+  XCTAssertEqual(writtenCount, (uint32_t)3, @"written %u", writtenCount);
+  XCTAssertEqualObjects(readDuration, @(1.5), @"duration %@", readDuration);
+  XCTAssertEqualObjects(readTitle, @"Remote", @"title %@", readTitle);
+  XCTAssertEqual(observer.changeCount, (NSUInteger)1, @"batched writes notify once %lu", (unsigned long)observer.changeCount);
+}
+
+- (void)testSubscribeStreamsChanges
+{
+  __block NSString *eventIdentifier = nil;
+  __block FBTweakValue eventValue = nil;
+
+  [self _runClient:^(int fileDescriptor) {
+    NSData *subscribe = FBTweakServerTestFrame(FBTweakServerOpcodeSubscribe, 1, nil);
+    send(fileDescriptor, subscribe.bytes, subscribe.length, 0);
+
+    FBTweakServerOpcode opcode;
+    uint32_t tag;
+    FBTweakServerTestReadFrame(fileDescriptor, &opcode, &tag);
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+      _title.currentValue = @"Changed";
+    });
+
+    NSData *payload = FBTweakServerTestReadFrame(fileDescriptor, &opcode, &tag);
+    if (opcode == FBTweakServerOpcodeEvent) {
+      _FBTweakBinaryReader reader = _FBTweakBinaryReaderMake(payload.bytes, payload.length);
+      eventIdentifier = _FBTweakBinaryReadString(&reader);
+      eventValue = _FBTweakBinaryReadValue(&reader);
+    }
+  }];
+
+  XCTAssertEqualObjects(eventIdentifier, _title.identifier, @"event %@", eventIdentifier);
+  XCTAssertEqualObjects(eventValue, @"Changed", @"event value %@", eventValue);
+}
+
+- (void)testMalformedRequestReturnsError
+{
+  __block FBTweakServerOpcode responseOpcode = 0;
+
+  [self _runClient:^(int fileDescriptor) {
+    NSMutableData *truncated = [[NSMutableData alloc] init];
+    _FBTweakBinaryAppendUInt32(truncated, 10);
+    NSData *read = FBTweakServerTestFrame(FBTweakServerOpcodeRead, 7, truncated);
+    send(fileDescriptor, read.bytes, read.length, 0);
+
+    uint32_t tag;
+    FBTweakServerTestReadFrame(fileDescriptor, &responseOpcode, &tag);
+  }];
+
+  XCTAssertEqual(responseOpcode, FBTweakServerOpcodeError, @"opcode %d", responseOpcode);
+}
+
+@end
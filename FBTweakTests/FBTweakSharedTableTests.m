@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakSharedTable.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakSharedTableTestObserver : NSObject <FBTweakObserver>
+
+@property (nonatomic, assign, readwrite) NSUInteger changeCount;
+
+@end
+
+@implementation FBTweakSharedTableTestObserver
+
+- (void)tweakDidChange:(FBTweak *)tweak
+{
+  self.changeCount++;
+}
+
+@end
+
+@interface FBTweakSharedTableTests : XCTestCase
+
+@end
+
+// Two tables mapping the same file stand in for two processes.
+@implementation FBTweakSharedTableTests {
+  NSString *_path;
+  FBTweakSharedTable *_firstTable;
+  FBTweakSharedTable *_secondTable;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+  NSError *error = nil;
+  _firstTable = [[FBTweakSharedTable alloc] initWithPath:_path capacity:16 error:&error];
+  XCTAssertNotNil(_firstTable, @"error %@", error);
+  _secondTable = [[FBTweakSharedTable alloc] initWithPath:_path capacity:64 error:&error];
+  XCTAssertNotNil(_secondTable, @"error %@", error);
+}
+
+- (void)tearDown
+{
+  _firstTable = nil;
+  _secondTable = nil;
+  [[NSFileManager defaultManager] removeItemAtPath:_path error:NULL];
+
+  [super tearDown];
+}
+
+- (FBTweak *)_tweakWithDefaultValue:(FBTweakValue)defaultValue
+{
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:@"FBTweakSharedTableTests"];
+  tweak.defaultValue = defaultValue;
+  tweak.currentValue = nil;
+  return tweak;
+}
+
+- (void)testExistingFileKeepsCapacity
+{
+  XCTAssertEqual(_secondTable.capacity, (NSUInteger)16, @"capacity %lu", (unsigned long)_secondTable.capacity);
+}
+
+- (void)testValuesAreVisibleWithoutSynchronizing
+{
+  FBTweak *writer = [self _tweakWithDefaultValue:@(1.0)];
+  FBTweak *reader = [self _tweakWithDefaultValue:@(1.0)];
+  XCTAssertTrue([_firstTable attachTweak:writer], @"attach writer");
+  XCTAssertTrue([_secondTable attachTweak:reader], @"attach reader");
+
+  uint64_t sequence = _secondTable.changeSequence;
+  writer.currentValue = @(2.5);
+  XCTAssertEqualObjects(reader.currentValue, @(2.5), @"reader %@", reader.currentValue);
+  XCTAssertTrue(_secondTable.changeSequence > sequence, @"sequence %llu", _secondTable.changeSequence);
+
+  writer.currentValue = @"shared";
+  XCTAssertEqualObjects(reader.currentValue, @"shared", @"reader %@", reader.currentValue);
+
+  writer.currentValue = nil;
+  XCTAssertNil(reader.currentValue, @"reader %@", reader.currentValue);
+}
+
+- (void)testAttachingAdoptsSharedValue
+{
+  FBTweak *writer = [self _tweakWithDefaultValue:@NO];
+  [_firstTable attachTweak:writer];
+  writer.currentValue = @YES;
+
+  FBTweak *reader = [self _tweakWithDefaultValue:@NO];
+  [_secondTable attachTweak:reader];
+  XCTAssertEqualObjects(reader.currentValue, @YES, @"reader %@", reader.currentValue);
+}
+
+- (void)testSynchronizeNotifiesObservers
+{
+  FBTweak *writer = [self _tweakWithDefaultValue:@(1)];
+  FBTweak *reader = [self _tweakWithDefaultValue:@(1)];
+  [_firstTable attachTweak:writer];
+  [_secondTable attachTweak:reader];
+
+  FBTweakSharedTableTestObserver *observer = [[FBTweakSharedTableTestObserver alloc] init];
+  [reader addObserver:observer];
+
+  writer.currentValue = @(3);
+  // Reading first must not swallow the notification.
+  XCTAssertEqualObjects(reader.currentValue, @(3), @"reader %@", reader.currentValue);
+  [_secondTable synchronize];
+  XCTAssertEqual(observer.changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)observer.changeCount);
+
+  [_secondTable synchronize];
+  XCTAssertEqual(observer.changeCount, (NSUInteger)1, @"changes %lu", (unsigned long)observer.changeCount);
+}
+
+- (void)testLongStringsAreNotShared
+{
+  FBTweak *writer = [self _tweakWithDefaultValue:@""];
+  FBTweak *reader = [self _tweakWithDefaultValue:@""];
+  [_firstTable attachTweak:writer];
+  [_secondTable attachTweak:reader];
+
+  writer.currentValue = @"short";
+  writer.currentValue = [@"" stringByPaddingToLength:128 withString:@"x" startingAtIndex:0];
+  XCTAssertEqualObjects(reader.currentValue, @"short", @"reader %@", reader.currentValue);
+}
+
+@end
@@ -0,0 +1,135 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakSnapshot.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+typedef struct {
+  double tension;
+  float friction;
+  NSInteger bounces;
+  BOOL enabled;
+} FBTweakSnapshotTestsSpring;
+
+@interface FBTweakSnapshotTests : XCTestCase
+
+@end
+
+@implementation FBTweakSnapshotTests {
+  FBTweak *_tension;
+  FBTweak *_friction;
+  FBTweak *_bounces;
+  FBTweak *_enabled;
+  FBTweakSnapshot *_snapshot;
+}
+
+- (FBTweak *)_tweakWithName:(NSString *)name defaultValue:(FBTweakValue)defaultValue
+{
+  FBTweak *tweak = [[FBTweak alloc] initWithIdentifier:[@"FBTweakSnapshotTests." stringByAppendingString:name]];
+  tweak.defaultValue = defaultValue;
+  tweak.currentValue = nil;
+  return tweak;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _tension = [self _tweakWithName:@"tension" defaultValue:@(0.5)];
+  _friction = [self _tweakWithName:@"friction" defaultValue:@(2.0f)];
+  _bounces = [self _tweakWithName:@"bounces" defaultValue:@(3)];
+  _enabled = [self _tweakWithName:@"enabled" defaultValue:@YES];
+
+  _snapshot = [[FBTweakSnapshot alloc] initWithFields:@[
+    FBTweakSnapshotField(FBTweakSnapshotTestsSpring, tension, _tension),
+    FBTweakSnapshotField(FBTweakSnapshotTestsSpring, friction, _friction),
+    FBTweakSnapshotField(FBTweakSnapshotTestsSpring, bounces, _bounces),
+    FBTweakSnapshotField(FBTweakSnapshotTestsSpring, enabled, _enabled),
+  ]];
+}
+
+- (void)tearDown
+{
+  _tension.currentValue = nil;
+  _friction.currentValue = nil;
+  _bounces.currentValue = nil;
+  _enabled.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (void)testGenerationAdvancesOnChange
+{
+  uint64_t generation = FBTweakGeneration();
+  XCTAssertNotEqual(generation, (uint64_t)0, @"generation starts at zero");
+
+  _tension.currentValue = @(0.7);
+  XCTAssertGreaterThan(FBTweakGeneration(), generation, @"generation didn't advance");
+
+  generation = FBTweakGeneration();
+  _tension.currentValue = _tension.currentValue;
+  XCTAssertEqual(FBTweakGeneration(), generation, @"unchanged value advanced generation");
+}
+
+- (void)testCaptureReadsDefaultsAndCurrentValues
+{
+  FBTweakSnapshotTestsSpring spring = {0};
+  XCTAssertTrue([_snapshot captureValues:&spring size:sizeof(spring) generation:NULL], @"not captured");
+  XCTAssertEqual(spring.tension, 0.5, @"tension %f", spring.tension);
+  XCTAssertEqual(spring.friction, 2.0f, @"friction %f", spring.friction);
+  XCTAssertEqual(spring.bounces, (NSInteger)3, @"bounces %ld", (long)spring.bounces);
+  XCTAssertTrue(spring.enabled, @"not enabled");
+
+  _tension.currentValue = @(0.9);
+  _enabled.currentValue = @NO;
+  XCTAssertTrue([_snapshot captureValues:&spring size:sizeof(spring) generation:NULL], @"not captured");
+  XCTAssertEqual(spring.tension, 0.9, @"tension %f", spring.tension);
+  XCTAssertFalse(spring.enabled, @"enabled");
+}
+
+- (void)testCaptureSkipsWhenNothingChanged
+{
+  FBTweakSnapshotTestsSpring spring = {0};
+  uint64_t generation = 0;
+  XCTAssertTrue([_snapshot captureValues:&spring size:sizeof(spring) generation:&generation], @"not captured");
+  XCTAssertFalse([_snapshot captureValues:&spring size:sizeof(spring) generation:&generation], @"captured again");
+
+  _bounces.currentValue = @(5);
+  XCTAssertTrue([_snapshot captureValues:&spring size:sizeof(spring) generation:&generation], @"change not captured");
+  XCTAssertEqual(spring.bounces, (NSInteger)5, @"bounces %ld", (long)spring.bounces);
+}
+
+- (void)testCaptureWhileChanging
+{
+  dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    for (NSUInteger i = 0; i < 1000; i++) {
+      _tension.currentValue = @(i);
+    }
+    dispatch_semaphore_signal(finished);
+  });
+
+  // Each capture sees a whole value from some change.
+  FBTweakSnapshotTestsSpring spring = {0};
+  while (dispatch_semaphore_wait(finished, DISPATCH_TIME_NOW) != 0) {
+    [_snapshot captureValues:&spring size:sizeof(spring) generation:NULL];
+    XCTAssertTrue(spring.tension == 0.5 || (spring.tension >= 0.0 && spring.tension < 1000.0 && spring.tension == floor(spring.tension)), @"tension %f", spring.tension);
+  }
+
+  XCTAssertTrue([_snapshot captureValues:&spring size:sizeof(spring) generation:NULL], @"not captured");
+  XCTAssertEqual(spring.tension, 999.0, @"tension %f", spring.tension);
+}
+
+@end
@@ -0,0 +1,131 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBTweak.h"
+#import "FBTweakStore.h"
+#import "FBTweakCategory.h"
+#import "FBTweakCollection.h"
+#import "FBTweakTuner.h"
+
+#if !__has_feature(objc_arc)
+#error ARC is required.
+#endif
+
+@interface FBTweakTunerTests : XCTestCase
+
+@end
+
+@implementation FBTweakTunerTests {
+  FBTweakStore *_store;
+  FBTweak *_damping;
+  FBTweak *_count;
+}
+
+- (void)setUp
+{
+  [super setUp];
+
+  _damping = [[FBTweak alloc] initWithIdentifier:@"FBTweakTunerTests.damping"];
+  _damping.name = @"Damping";
+  _damping.defaultValue = @(0.5);
+  _damping.possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:@(0.0) maximumValue:@(1.0)];
+  _damping.currentValue = nil;
+
+  _count = [[FBTweak alloc] initWithIdentifier:@"FBTweakTunerTests.count"];
+  _count.name = @"Count";
+  _count.defaultValue = @(4);
+  _count.possibleValues = [[FBTweakNumericRange alloc] initWithMinimumValue:@(0) maximumValue:@(8)];
+  _count.currentValue = nil;
+
+  FBTweakCollection *collection = [[FBTweakCollection alloc] initWithName:@"Tuner"];
+  [collection addTweak:_damping];
+  [collection addTweak:_count];
+  FBTweakCategory *category = [[FBTweakCategory alloc] initWithName:@"Tests"];
+  [category addTweakCollection:collection];
+  _store = [[FBTweakStore alloc] init];
+  [_store addTweakCategory:category];
+}
+
+- (void)tearDown
+{
+  _damping.currentValue = nil;
+  _count.currentValue = nil;
+
+  [super tearDown];
+}
+
+- (double)_costWithDampingTarget:(double)dampingTarget countTarget:(double)countTarget
+{
+  double damping = [_damping.currentValue doubleValue] - dampingTarget;
+  double count = [_count.currentValue doubleValue] - countTarget;
+  return damping * damping + count * count;
+}
+
+- (void)testGridSweepMeasuresEveryCombination
+{
+  FBTweakTuner *tuner = [[FBTweakTuner alloc] initWithStore:_store tweaks:@[_damping, _count]];
+  tuner.samplesPerTweak = 3;
+
+  XCTestExpectation *expectation = [self expectationWithDescription:@"finished"];
+  [tuner startWithMeasurement:^(FBTweakTunerReportBlock report) {
+    report([self _costWithDampingTarget:1.0 countTarget:4.0]);
+  } completion:^(FBTweakTunerResult *best, NSArray *results) {
+    XCTAssertEqual(results.count, (NSUInteger)9, @"results %@", results);
+    XCTAssertEqualObjects(best.values[_damping.identifier], @(1.0), @"best %@", best);
+    XCTAssertEqualObjects(best.values[_count.identifier], @(4), @"best %@", best);
+    XCTAssertEqualObjects(_damping.currentValue, @(1.0), @"applied %@", _damping.currentValue);
+    [expectation fulfill];
+  }];
+
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+  XCTAssertFalse(tuner.isRunning, @"running");
+}
+
+- (void)testNelderMeadConvergesAndRestores
+{
+  FBTweakTuner *tuner = [[FBTweakTuner alloc] initWithStore:_store tweaks:@[_damping]];
+  tuner.strategy = FBTweakTunerStrategyNelderMead;
+  tuner.tolerance = 1e-8;
+  tuner.restoresOriginalValues = YES;
+
+  XCTestExpectation *expectation = [self expectationWithDescription:@"finished"];
+  [tuner startWithMeasurement:^(FBTweakTunerReportBlock report) {
+    // Report asynchronously, as a frame time measurement would.
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+      report([self _costWithDampingTarget:0.3 countTarget:4.0]);
+    });
+  } completion:^(FBTweakTunerResult *best, NSArray *results) {
+    XCTAssertEqualWithAccuracy([best.values[_damping.identifier] doubleValue], 0.3, 0.01, @"best %@", best);
+    XCTAssertTrue(results.count <= 100, @"results %lu", (unsigned long)results.count);
+    XCTAssertNil(_damping.currentValue, @"restored %@", _damping.currentValue);
+    [expectation fulfill];
+  }];
+
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testCancelStopsAfterCurrentMeasurement
+{
+  FBTweakTuner *tuner = [[FBTweakTuner alloc] initWithStore:_store tweaks:@[_damping, _count]];
+
+  XCTestExpectation *expectation = [self expectationWithDescription:@"finished"];
+  [tuner startWithMeasurement:^(FBTweakTunerReportBlock report) {
+    [tuner cancel];
+    report(0.0);
+  } completion:^(FBTweakTunerResult *best, NSArray *results) {
+    XCTAssertEqual(results.count, (NSUInteger)1, @"results %@", results);
+    [expectation fulfill];
+  }];
+
+  [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+@end
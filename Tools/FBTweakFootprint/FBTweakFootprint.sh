@@ -0,0 +1,79 @@
+#!/bin/sh
+#
+# Copyright (c) 2014-present, Facebook, Inc.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree. An additional grant
+# of patent rights can be found in the PATENTS file in the same directory.
+#
+# Measures what inline tweaks add to a binary. Generates a corpus of call
+# sites (default 5000, one in five repeating another site's tweak), builds
+# it for the simulator with and without tweaks, and prints the size of each
+# section and the relocations dyld has to apply. Needs Xcode.
+#
+# Usage: FBTweakFootprint.sh [SITES]
+#
+# Loader time for a corpus of the same size is measured by
+# -[FBTweakCollectionTests testRegisteringEntriesPerformance]. Set
+# DYLD_PRINT_STATISTICS=1 when launching an app linking the corpus to
+# see dyld's share of launch.
+
+set -eu
+
+SITES=${1:-5000}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+CORPUS="$WORK/Corpus.m"
+{
+  echo '#import "FBTweakInline.h"'
+  echo
+  echo 'double FBTweakFootprintCorpus(void)'
+  echo '{'
+  echo '  double sum = 0;'
+  i=0
+  while [ "$i" -lt "$SITES" ]; do
+    # Repeated sites read the same tweak with the same type and default.
+    tweak=$i
+    if [ $((i % 5)) -eq 4 ]; then
+      tweak=$((i - 1))
+    fi
+    case $((tweak % 4)) in
+      0) echo "  sum += FBTweakValue(@\"Corpus\", @\"Group $((tweak / 100))\", @\"Tweak $tweak\", 1.5);" ;;
+      1) echo "  sum += FBTweakValue(@\"Corpus\", @\"Group $((tweak / 100))\", @\"Tweak $tweak\", 2, 0, 10);" ;;
+      2) echo "  sum += FBTweakValue(@\"Corpus\", @\"Group $((tweak / 100))\", @\"Tweak $tweak\", YES);" ;;
+      3) echo "  sum += [FBTweakValue(@\"Corpus\", @\"Group $((tweak / 100))\", @\"Tweak $tweak\", @\"Text\") length];" ;;
+    esac
+    i=$((i + 1))
+  done
+  echo '  return sum;'
+  echo '}'
+} > "$CORPUS"
+
+build()
+{
+  xcrun --sdk iphonesimulator clang -fobjc-arc -O2 -dynamiclib -arch "$(uname -m)" \
+    -mios-simulator-version-min=12.0 -DFB_TWEAK_ENABLED="$1" -I "$ROOT/FBTweak" \
+    -framework Foundation -framework UIKit -undefined dynamic_lookup \
+    -o "$WORK/$2" "$CORPUS"
+}
+
+report()
+{
+  echo "== $1 ($SITES sites)"
+  size -m "$WORK/$1" | grep -E 'Section (__const|__data|FBTweak|__cfstring|__objc_const)|Segment __DATA'
+  if xcrun dyld_info -fixups "$WORK/$1" > "$WORK/$1.fixups" 2> /dev/null; then
+    echo "fixups: $(grep -cE 'rebase|bind' "$WORK/$1.fixups")"
+  else
+    xcrun dyldinfo -rebase -bind "$WORK/$1" > "$WORK/$1.fixups"
+    echo "fixups: $(grep -cE '^__DATA' "$WORK/$1.fixups")"
+  fi
+}
+
+build 1 enabled
+report enabled
+
+build 0 disabled
+report disabled
@@ -0,0 +1,1039 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+/*
+  Lists the inline tweaks compiled into a binary, without running it.
+
+  Reads the FBTweak section of linked Mach-O (thin or universal) and ELF
+  images, follows each entry's pointers to its names, @encode type and
+  default, and prints a JSON manifest. Build with:
+
+    cc -O2 -o fbtweak-manifest Tools/FBTweakManifest/FBTweakManifest.c
+
+  Usage: fbtweak-manifest BINARY...
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../FBTweak/FBTweakC.h"
+
+#define _FBTweakManifestActionEncoding "__ACTION__"
+
+// Mach-O
+#define _FBTweakMachMagic32 0xfeedfaceu
+#define _FBTweakMachMagic64 0xfeedfacfu
+#define _FBTweakFatMagic32 0xcafebabeu
+#define _FBTweakFatMagic64 0xcafebabfu
+#define _FBTweakMachSegment32 0x1u
+#define _FBTweakMachSegment64 0x19u
+#define _FBTweakMachChainedFixups 0x80000034u
+#define _FBTweakMachCPUX86 7
+#define _FBTweakMachCPUARM 12
+#define _FBTweakMachCPUArch64 0x01000000
+#define _FBTweakMachCPUSubtypeARM64E 2
+
+// Chained fixup pointer formats, from <mach-o/fixup-chains.h>.
+#define _FBTweakChainedARM64E 1
+#define _FBTweakChained64 2
+#define _FBTweakChained32 3
+#define _FBTweakChained64Offset 6
+#define _FBTweakChainedARM64EKernel 7
+#define _FBTweakChainedARM64EUserland 9
+#define _FBTweakChainedARM64EFirmware 10
+#define _FBTweakChainedARM64EUserland24 12
+
+// ELF
+#define _FBTweakELFClass32 1
+#define _FBTweakELFClass64 2
+#define _FBTweakELFDataLittle 1
+#define _FBTweakELFLoad 1
+#define _FBTweakELFRela 4
+#define _FBTweakELFMachine386 3
+#define _FBTweakELFMachineARM 40
+#define _FBTweakELFMachineX86_64 62
+#define _FBTweakELFMachineAArch64 183
+#define _FBTweakELFRelativeX86_64 8
+#define _FBTweakELFRelativeAArch64 1027
+
+// Constant NSString literals are laid out as { isa, flags, bytes, length };
+// this flag marks UTF-16 bytes rather than ASCII.
+#define _FBTweakCFStringUnicodeFlag 0x10
+
+typedef enum {
+  _FBTweakImageFormatMachO,
+  _FBTweakImageFormatELF,
+} _FBTweakImageFormat;
+
+typedef struct {
+  uint64_t address;
+  uint64_t size;
+  uint64_t offset;
+} _FBTweakRegion;
+
+typedef struct {
+  uint64_t offset;
+  uint64_t addend;
+} _FBTweakRelocation;
+
+typedef struct {
+  _FBTweakImageFormat format;
+  const char *architecture;
+  const uint8_t *data;
+  uint64_t size;
+  bool is64;
+
+  _FBTweakRegion *regions;
+  size_t regionCount;
+
+  // Mach-O images with chained fixups store pointers encoded.
+  uint16_t chainedFormat;
+  uint64_t baseAddress;
+
+  // Position independent ELF images store pointers as relocations.
+  _FBTweakRelocation *relocations;
+  size_t relocationCount;
+
+  uint64_t sectionAddress;
+  uint64_t sectionSize;
+  bool hasSection;
+} _FBTweakImage;
+
+typedef struct {
+  char *identifier;
+  char *category;
+  char *collection;
+  char *name;
+  char *encoding;
+  const char *type;
+  bool hasDefault;
+  bool hasRange;
+  double defaultValue;
+  double minimumValue;
+  double maximumValue;
+  size_t index;
+} _FBTweakManifestTweak;
+
+// Reading
+
+static uint16_t _FBTweakRead16(const uint8_t *bytes)
+{
+  return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t _FBTweakRead32(const uint8_t *bytes)
+{
+  return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static uint64_t _FBTweakRead64(const uint8_t *bytes)
+{
+  return (uint64_t)_FBTweakRead32(bytes) | ((uint64_t)_FBTweakRead32(bytes + 4) << 32);
+}
+
+static uint32_t _FBTweakReadBig32(const uint8_t *bytes)
+{
+  return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+static uint64_t _FBTweakReadBig64(const uint8_t *bytes)
+{
+  return ((uint64_t)_FBTweakReadBig32(bytes) << 32) | (uint64_t)_FBTweakReadBig32(bytes + 4);
+}
+
+static const uint8_t *_FBTweakImageBytes(const _FBTweakImage *image, uint64_t offset, uint64_t size)
+{
+  if (offset > image->size || size > image->size - offset) {
+    return NULL;
+  }
+  return image->data + offset;
+}
+
+// Returns the file contents at a virtual address, if they're in the file.
+static const uint8_t *_FBTweakImageBytesAtAddress(const _FBTweakImage *image, uint64_t address, uint64_t size)
+{
+  for (size_t i = 0; i < image->regionCount; i++) {
+    const _FBTweakRegion *region = &image->regions[i];
+    if (address >= region->address && address - region->address < region->size && size <= region->size - (address - region->address)) {
+      return _FBTweakImageBytes(image, region->offset + (address - region->address), size);
+    }
+  }
+  return NULL;
+}
+
+static int _FBTweakRelocationCompare(const void *a, const void *b)
+{
+  uint64_t left = ((const _FBTweakRelocation *)a)->offset;
+  uint64_t right = ((const _FBTweakRelocation *)b)->offset;
+  return (left > right) - (left < right);
+}
+
+// Reads the pointer stored at an address, as it would be before sliding.
+static bool _FBTweakImageReadPointer(const _FBTweakImage *image, uint64_t address, uint64_t *pointer)
+{
+  const uint8_t *bytes = _FBTweakImageBytesAtAddress(image, address, image->is64 ? 8 : 4);
+  if (bytes == NULL) {
+    return false;
+  }
+
+  uint64_t value = (image->is64 ? _FBTweakRead64(bytes) : _FBTweakRead32(bytes));
+
+  if (image->relocationCount > 0) {
+    _FBTweakRelocation key = { address, 0 };
+    const _FBTweakRelocation *relocation = bsearch(&key, image->relocations, image->relocationCount, sizeof(key), _FBTweakRelocationCompare);
+    if (relocation != NULL) {
+      value = relocation->addend;
+    }
+  }
+
+  switch (image->chainedFormat) {
+    case 0:
+      break;
+    case _FBTweakChained64:
+    case _FBTweakChained64Offset: {
+      if ((value >> 63) != 0) {
+        // Bound to another image, so it's not a tweak's own data.
+        return false;
+      }
+      uint64_t target = (value & 0xFFFFFFFFFull) | (((value >> 36) & 0xFF) << 56);
+      value = (image->chainedFormat == _FBTweakChained64Offset ? image->baseAddress + target : target);
+      break;
+    }
+    case _FBTweakChained32:
+      if ((value >> 31) != 0) {
+        return false;
+      }
+      value &= 0x3FFFFFF;
+      break;
+    case _FBTweakChainedARM64E:
+    case _FBTweakChainedARM64EKernel:
+    case _FBTweakChainedARM64EUserland:
+    case _FBTweakChainedARM64EFirmware:
+    case _FBTweakChainedARM64EUserland24: {
+      bool authenticated = ((value >> 63) & 1) != 0;
+      bool bind = ((value >> 62) & 1) != 0;
+      if (bind) {
+        return false;
+      }
+      if (authenticated) {
+        value = image->baseAddress + (value & 0xFFFFFFFFull);
+      } else {
+        uint64_t target = value & 0x7FFFFFFFFFFull;
+        uint64_t high8 = (value >> 43) & 0xFF;
+        value = (image->chainedFormat == _FBTweakChainedARM64E ? target : image->baseAddress + target) | (high8 << 56);
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+
+  *pointer = value;
+  return true;
+}
+
+static char *_FBTweakImageCopyCString(const _FBTweakImage *image, uint64_t address)
+{
+  for (size_t i = 0; i < image->regionCount; i++) {
+    const _FBTweakRegion *region = &image->regions[i];
+    if (address >= region->address && address - region->address < region->size) {
+      uint64_t available = region->size - (address - region->address);
+      const uint8_t *bytes = _FBTweakImageBytes(image, region->offset + (address - region->address), available);
+      const uint8_t *end = (bytes != NULL ? memchr(bytes, 0, available) : NULL);
+      return (end != NULL ? strndup((const char *)bytes, end - bytes) : NULL);
+    }
+  }
+  return NULL;
+}
+
+static char *_FBTweakCopyUTF16String(const uint8_t *bytes, uint64_t length)
+{
+  char *string = malloc(length * 3 + 1);
+  size_t used = 0;
+
+  for (uint64_t i = 0; i < length; i++) {
+    uint32_t character = _FBTweakRead16(bytes + i * 2);
+    if (character >= 0xD800 && character < 0xDC00 && i + 1 < length) {
+      uint32_t low = _FBTweakRead16(bytes + (i + 1) * 2);
+      if (low >= 0xDC00 && low < 0xE000) {
+        character = 0x10000 + ((character - 0xD800) << 10) + (low - 0xDC00);
+        i++;
+      }
+    }
+
+    if (character < 0x80) {
+      string[used++] = (char)character;
+    } else if (character < 0x800) {
+      string[used++] = (char)(0xC0 | (character >> 6));
+      string[used++] = (char)(0x80 | (character & 0x3F));
+    } else if (character < 0x10000) {
+      string[used++] = (char)(0xE0 | (character >> 12));
+      string[used++] = (char)(0x80 | ((character >> 6) & 0x3F));
+      string[used++] = (char)(0x80 | (character & 0x3F));
+    } else {
+      string[used++] = (char)(0xF0 | (character >> 18));
+      string[used++] = (char)(0x80 | ((character >> 12) & 0x3F));
+      string[used++] = (char)(0x80 | ((character >> 6) & 0x3F));
+      string[used++] = (char)(0x80 | (character & 0x3F));
+    }
+  }
+
+  string[used] = '\0';
+  return string;
+}
+
+// Reads a constant NSString literal.
+static char *_FBTweakImageCopyObjectString(const _FBTweakImage *image, uint64_t address)
+{
+  uint64_t pointerSize = (image->is64 ? 8 : 4);
+  const uint8_t *header = _FBTweakImageBytesAtAddress(image, address, pointerSize * 4);
+  uint64_t bytesAddress;
+  if (header == NULL || !_FBTweakImageReadPointer(image, address + pointerSize * 2, &bytesAddress)) {
+    return NULL;
+  }
+
+  uint32_t flags = _FBTweakRead32(header + pointerSize);
+  uint64_t length = (image->is64 ? _FBTweakRead64(header + pointerSize * 3) : _FBTweakRead32(header + pointerSize * 3));
+
+  if ((flags & _FBTweakCFStringUnicodeFlag) != 0) {
+    const uint8_t *bytes = (length < UINT32_MAX ? _FBTweakImageBytesAtAddress(image, bytesAddress, length * 2) : NULL);
+    return (bytes != NULL ? _FBTweakCopyUTF16String(bytes, length) : NULL);
+  } else {
+    const uint8_t *bytes = _FBTweakImageBytesAtAddress(image, bytesAddress, length);
+    return (bytes != NULL ? strndup((const char *)bytes, length) : NULL);
+  }
+}
+
+// Images
+
+static bool _FBTweakImageAddRegion(_FBTweakImage *image, uint64_t address, uint64_t size, uint64_t offset)
+{
+  _FBTweakRegion *regions = realloc(image->regions, (image->regionCount + 1) * sizeof(_FBTweakRegion));
+  if (regions == NULL) {
+    return false;
+  }
+
+  image->regions = regions;
+  image->regions[image->regionCount++] = (_FBTweakRegion){ address, size, offset };
+  return true;
+}
+
+static const char *_FBTweakMachArchitecture(uint32_t cpuType, uint32_t cpuSubtype)
+{
+  switch (cpuType) {
+    case _FBTweakMachCPUX86:
+      return "i386";
+    case _FBTweakMachCPUX86 | _FBTweakMachCPUArch64:
+      return "x86_64";
+    case _FBTweakMachCPUARM:
+      return "arm";
+    case _FBTweakMachCPUARM | _FBTweakMachCPUArch64:
+      return ((cpuSubtype & 0xFF) == _FBTweakMachCPUSubtypeARM64E ? "arm64e" : "arm64");
+    default:
+      return "unknown";
+  }
+}
+
+static uint16_t _FBTweakMachChainedFormat(const _FBTweakImage *image, uint32_t offset, uint32_t size)
+{
+  // dyld_chained_fixups_header, then dyld_chained_starts_in_image.
+  const uint8_t *header = _FBTweakImageBytes(image, offset, size);
+  if (header == NULL || size < 28) {
+    return 0;
+  }
+
+  uint32_t startsOffset = _FBTweakRead32(header + 4);
+  if (startsOffset > size - 4) {
+    return 0;
+  }
+
+  uint32_t segmentCount = _FBTweakRead32(header + startsOffset);
+  for (uint32_t i = 0; i < segmentCount && startsOffset + 4 + (i + 1) * 4 <= size; i++) {
+    uint32_t segmentOffset = _FBTweakRead32(header + startsOffset + 4 + i * 4);
+    if (segmentOffset != 0 && startsOffset + segmentOffset + 8 <= size) {
+      // dyld_chained_starts_in_segment: size, page_size, pointer_format.
+      return _FBTweakRead16(header + startsOffset + segmentOffset + 6);
+    }
+  }
+
+  return 0;
+}
+
+static bool _FBTweakImageLoadMachO(_FBTweakImage *image)
+{
+  const uint8_t *header = _FBTweakImageBytes(image, 0, 28);
+  if (header == NULL) {
+    return false;
+  }
+
+  uint32_t magic = _FBTweakRead32(header);
+  image->format = _FBTweakImageFormatMachO;
+  image->is64 = (magic == _FBTweakMachMagic64);
+  image->architecture = _FBTweakMachArchitecture(_FBTweakRead32(header + 4), _FBTweakRead32(header + 8));
+
+  uint32_t commandCount = _FBTweakRead32(header + 16);
+  uint64_t offset = (image->is64 ? 32 : 28);
+  bool hasBaseAddress = false;
+
+  for (uint32_t i = 0; i < commandCount; i++) {
+    const uint8_t *command = _FBTweakImageBytes(image, offset, 8);
+    if (command == NULL) {
+      return false;
+    }
+
+    uint32_t type = _FBTweakRead32(command);
+    uint32_t size = _FBTweakRead32(command + 4);
+    if (size < 8 || _FBTweakImageBytes(image, offset, size) == NULL) {
+      return false;
+    }
+
+    if (type == _FBTweakMachSegment64 || type == _FBTweakMachSegment32) {
+      bool is64 = (type == _FBTweakMachSegment64);
+      uint64_t segmentHeaderSize = (is64 ? 72 : 56);
+      uint64_t sectionHeaderSize = (is64 ? 80 : 68);
+      if (size < segmentHeaderSize) {
+        return false;
+      }
+
+      uint64_t address = (is64 ? _FBTweakRead64(command + 24) : _FBTweakRead32(command + 24));
+      uint64_t fileOffset = (is64 ? _FBTweakRead64(command + 40) : _FBTweakRead32(command + 32));
+      uint64_t fileSize = (is64 ? _FBTweakRead64(command + 48) : _FBTweakRead32(command + 36));
+      uint32_t sectionCount = _FBTweakRead32(command + (is64 ? 64 : 48));
+
+      if (fileOffset == 0 && fileSize != 0 && !hasBaseAddress) {
+        image->baseAddress = address;
+        hasBaseAddress = true;
+      }
+      if (fileSize != 0 && !_FBTweakImageAddRegion(image, address, fileSize, fileOffset)) {
+        return false;
+      }
+
+      for (uint32_t j = 0; j < sectionCount && segmentHeaderSize + (j + 1) * sectionHeaderSize <= size; j++) {
+        const uint8_t *section = command + segmentHeaderSize + j * sectionHeaderSize;
+        if (strncmp((const char *)section, FBTweakSectionName, 16) == 0 && strncmp((const char *)section + 16, FBTweakSegmentName, 16) == 0) {
+          image->hasSection = true;
+          image->sectionAddress = (is64 ? _FBTweakRead64(section + 32) : _FBTweakRead32(section + 32));
+          image->sectionSize = (is64 ? _FBTweakRead64(section + 40) : _FBTweakRead32(section + 36));
+        }
+      }
+    } else if (type == _FBTweakMachChainedFixups && size >= 16) {
+      image->chainedFormat = _FBTweakMachChainedFormat(image, _FBTweakRead32(command + 8), _FBTweakRead32(command + 12));
+    }
+
+    offset += size;
+  }
+
+  return true;
+}
+
+static const char *_FBTweakELFArchitecture(uint16_t machine)
+{
+  switch (machine) {
+    case _FBTweakELFMachine386:
+      return "i386";
+    case _FBTweakELFMachineX86_64:
+      return "x86_64";
+    case _FBTweakELFMachineARM:
+      return "arm";
+    case _FBTweakELFMachineAArch64:
+      return "arm64";
+    default:
+      return "unknown";
+  }
+}
+
+static bool _FBTweakImageLoadELF(_FBTweakImage *image)
+{
+  const uint8_t *identification = _FBTweakImageBytes(image, 0, 16);
+  if (identification == NULL || identification[5] != _FBTweakELFDataLittle) {
+    return false;
+  }
+
+  image->format = _FBTweakImageFormatELF;
+  image->is64 = (identification[4] == _FBTweakELFClass64);
+
+  const uint8_t *header = _FBTweakImageBytes(image, 0, image->is64 ? 64 : 52);
+  if (header == NULL) {
+    return false;
+  }
+
+  uint16_t machine = _FBTweakRead16(header + 18);
+  image->architecture = _FBTweakELFArchitecture(machine);
+
+  uint64_t programOffset = (image->is64 ? _FBTweakRead64(header + 32) : _FBTweakRead32(header + 28));
+  uint64_t sectionOffset = (image->is64 ? _FBTweakRead64(header + 40) : _FBTweakRead32(header + 32));
+  uint16_t programSize = _FBTweakRead16(header + (image->is64 ? 54 : 42));
+  uint16_t programCount = _FBTweakRead16(header + (image->is64 ? 56 : 44));
+  uint16_t sectionSize = _FBTweakRead16(header + (image->is64 ? 58 : 46));
+  uint16_t sectionCount = _FBTweakRead16(header + (image->is64 ? 60 : 48));
+  uint16_t namesIndex = _FBTweakRead16(header + (image->is64 ? 62 : 50));
+
+  for (uint16_t i = 0; i < programCount; i++) {
+    const uint8_t *program = _FBTweakImageBytes(image, programOffset + (uint64_t)i * programSize, programSize);
+    if (program == NULL) {
+      return false;
+    }
+    if (_FBTweakRead32(program) != _FBTweakELFLoad) {
+      continue;
+    }
+
+    uint64_t offset = (image->is64 ? _FBTweakRead64(program + 8) : _FBTweakRead32(program + 4));
+    uint64_t address = (image->is64 ? _FBTweakRead64(program + 16) : _FBTweakRead32(program + 8));
+    uint64_t fileSize = (image->is64 ? _FBTweakRead64(program + 32) : _FBTweakRead32(program + 16));
+    if (fileSize != 0 && !_FBTweakImageAddRegion(image, address, fileSize, offset)) {
+      return false;
+    }
+  }
+
+  const uint8_t *namesSection = _FBTweakImageBytes(image, sectionOffset + (uint64_t)namesIndex * sectionSize, sectionSize);
+  if (sectionCount == 0 || namesSection == NULL) {
+    // Stripped of section headers, so there's no FBTweak section to find.
+    return true;
+  }
+
+  uint64_t namesOffset = (image->is64 ? _FBTweakRead64(namesSection + 24) : _FBTweakRead32(namesSection + 16));
+  uint64_t namesSize = (image->is64 ? _FBTweakRead64(namesSection + 32) : _FBTweakRead32(namesSection + 20));
+  const uint8_t *names = _FBTweakImageBytes(image, namesOffset, namesSize);
+  uint32_t relativeType = (machine == _FBTweakELFMachineAArch64 ? _FBTweakELFRelativeAArch64 : _FBTweakELFRelativeX86_64);
+
+  for (uint16_t i = 0; i < sectionCount; i++) {
+    const uint8_t *section = _FBTweakImageBytes(image, sectionOffset + (uint64_t)i * sectionSize, sectionSize);
+    if (section == NULL) {
+      return false;
+    }
+
+    uint32_t nameOffset = _FBTweakRead32(section);
+    uint32_t type = _FBTweakRead32(section + 4);
+    uint64_t address = (image->is64 ? _FBTweakRead64(section + 16) : _FBTweakRead32(section + 12));
+    uint64_t offset = (image->is64 ? _FBTweakRead64(section + 24) : _FBTweakRead32(section + 16));
+    uint64_t size = (image->is64 ? _FBTweakRead64(section + 32) : _FBTweakRead32(section + 20));
+
+    if (names != NULL && nameOffset < namesSize && memchr(names + nameOffset, 0, namesSize - nameOffset) != NULL && strcmp((const char *)names + nameOffset, FBTweakSectionName) == 0) {
+      image->hasSection = true;
+      image->sectionAddress = address;
+      image->sectionSize = size;
+    }
+
+    // Only 64-bit images keep addends out of line; 32-bit ones use REL.
+    if (type == _FBTweakELFRela && image->is64) {
+      const uint8_t *relocations = _FBTweakImageBytes(image, offset, size);
+      if (relocations == NULL) {
+        return false;
+      }
+
+      size_t count = size / 24;
+      _FBTweakRelocation *all = realloc(image->relocations, (image->relocationCount + count) * sizeof(_FBTweakRelocation));
+      if (all == NULL) {
+        return false;
+      }
+      image->relocations = all;
+
+      for (size_t j = 0; j < count; j++) {
+        const uint8_t *relocation = relocations + j * 24;
+        if ((_FBTweakRead64(relocation + 8) & 0xFFFFFFFF) == relativeType) {
+          image->relocations[image->relocationCount++] = (_FBTweakRelocation){ _FBTweakRead64(relocation), _FBTweakRead64(relocation + 16) };
+        }
+      }
+    }
+  }
+
+  qsort(image->relocations, image->relocationCount, sizeof(_FBTweakRelocation), _FBTweakRelocationCompare);
+  return true;
+}
+
+// Entries
+
+static const char *_FBTweakTypeForEncoding(const char *encoding)
+{
+  if (strcmp(encoding, _FBTweakManifestActionEncoding) == 0) {
+    return "action";
+  }
+
+  // Qualifiers like const don't change the type.
+  while (*encoding == 'r' || *encoding == 'n' || *encoding == 'N' || *encoding == 'o' || *encoding == 'O' || *encoding == 'R' || *encoding == 'V') {
+    encoding++;
+  }
+
+  switch (encoding[0]) {
+    case 'B':
+    case 'c':
+      return "bool";
+    case 'C':
+    case 's':
+    case 'S':
+    case 'i':
+    case 'I':
+    case 'l':
+    case 'L':
+    case 'q':
+    case 'Q':
+      return "integer";
+    case 'f':
+      return "float";
+    case 'd':
+      return "double";
+    case '@':
+      return "object";
+    case '*':
+      return "string";
+    case '[': {
+      // String literals are char arrays.
+      size_t length = strlen(encoding);
+      return (length >= 2 && encoding[length - 2] == 'c' && encoding[length - 1] == ']' ? "string" : "unknown");
+    }
+    default:
+      return "unknown";
+  }
+}
+
+static bool _FBTweakImageReadCHandle(const _FBTweakImage *image, uint64_t address, _FBTweakManifestTweak *tweak)
+{
+  const uint8_t *header = _FBTweakImageBytesAtAddress(image, address, sizeof(fb_tweak_c_handle_header));
+  if (header == NULL) {
+    return false;
+  }
+
+  uint32_t type = _FBTweakRead32(header);
+  tweak->hasRange = (_FBTweakRead32(header + 4) != 0);
+  tweak->hasDefault = true;
+
+  if (type == fb_tweak_c_type_bool) {
+    const uint8_t *values = _FBTweakImageBytesAtAddress(image, address + offsetof(fb_tweak_bool_handle, default_value), 3);
+    if (values == NULL) {
+      return false;
+    }
+    tweak->type = "bool";
+    tweak->defaultValue = values[0];
+    tweak->minimumValue = values[1];
+    tweak->maximumValue = values[2];
+  } else if (type == fb_tweak_c_type_integer || type == fb_tweak_c_type_double) {
+    const uint8_t *values = _FBTweakImageBytesAtAddress(image, address + offsetof(fb_tweak_integer_handle, default_value), 24);
+    if (values == NULL) {
+      return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+      uint64_t bits = _FBTweakRead64(values + i * 8);
+      double value;
+      if (type == fb_tweak_c_type_integer) {
+        value = (double)(int64_t)bits;
+      } else {
+        memcpy(&value, &bits, sizeof(value));
+      }
+      *(i == 0 ? &tweak->defaultValue : i == 1 ? &tweak->minimumValue : &tweak->maximumValue) = value;
+    }
+    tweak->type = (type == fb_tweak_c_type_integer ? "integer" : "double");
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+static char *_FBTweakImageCopyName(const _FBTweakImage *image, uint64_t entry, int field, bool isC)
+{
+  uint64_t pointerSize = (image->is64 ? 8 : 4);
+  uint64_t string;
+  if (!_FBTweakImageReadPointer(image, entry + field * pointerSize, &string)) {
+    return NULL;
+  }
+  return (isC ? _FBTweakImageCopyCString(image, string) : _FBTweakImageCopyObjectString(image, string));
+}
+
+// Reads the typed constants behind a numeric entry's default and range.
+// Objects and strings are left without a default.
+static bool _FBTweakImageReadConstants(const _FBTweakImage *image, uint64_t entry, _FBTweakManifestTweak *tweak)
+{
+  uint64_t pointerSize = (image->is64 ? 8 : 4);
+  const char *encoding = tweak->encoding;
+  while (*encoding == 'r') {
+    encoding++;
+  }
+
+  uint64_t size;
+  bool isSigned = true;
+  bool isFloat = false;
+  switch (encoding[0]) {
+    case 'B': size = 1; isSigned = false; break;
+    case 'c': size = 1; break;
+    case 'C': size = 1; isSigned = false; break;
+    case 's': size = 2; break;
+    case 'S': size = 2; isSigned = false; break;
+    case 'i': size = 4; break;
+    case 'I': size = 4; isSigned = false; break;
+    case 'l': size = pointerSize; break;
+    case 'L': size = pointerSize; isSigned = false; break;
+    case 'q': size = 8; break;
+    case 'Q': size = 8; isSigned = false; break;
+    case 'f': size = 4; isFloat = true; break;
+    case 'd': size = 8; isFloat = true; break;
+    default: return true;
+  }
+  if (encoding[1] != '\0') {
+    return true;
+  }
+
+  uint64_t value, possible;
+  if (!_FBTweakImageReadPointer(image, entry + 3 * pointerSize, &value) || !_FBTweakImageReadPointer(image, entry + 4 * pointerSize, &possible)) {
+    return false;
+  }
+
+  // Ranges point their possible values at the default, followed by the
+  // minimum and maximum.
+  int count = (possible == value ? 3 : 1);
+  const uint8_t *bytes = _FBTweakImageBytesAtAddress(image, value, size * count);
+  if (bytes == NULL) {
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    const uint8_t *field = bytes + i * size;
+    uint64_t bits = (size == 1 ? field[0] : size == 2 ? _FBTweakRead16(field) : size == 4 ? _FBTweakRead32(field) : _FBTweakRead64(field));
+    double number;
+    if (isFloat && size == 4) {
+      uint32_t floatBits = (uint32_t)bits;
+      float floatValue;
+      memcpy(&floatValue, &floatBits, sizeof(floatValue));
+      number = floatValue;
+    } else if (isFloat) {
+      memcpy(&number, &bits, sizeof(number));
+    } else if (isSigned) {
+      // Sign extend from the field's width.
+      int shift = (int)(64 - size * 8);
+      number = (double)((int64_t)(bits << shift) >> shift);
+    } else {
+      number = (double)bits;
+    }
+    *(i == 0 ? &tweak->defaultValue : i == 1 ? &tweak->minimumValue : &tweak->maximumValue) = number;
+  }
+
+  tweak->hasDefault = true;
+  tweak->hasRange = (count == 3);
+  return true;
+}
+
+static void _FBTweakManifestTweakFree(_FBTweakManifestTweak *tweak)
+{
+  free(tweak->identifier);
+  free(tweak->category);
+  free(tweak->collection);
+  free(tweak->name);
+  free(tweak->encoding);
+}
+
+// Fills in a tweak from an entry. Mirrors fb_tweak_entry's fields.
+static bool _FBTweakImageReadEntry(const _FBTweakImage *image, uint64_t entry, _FBTweakManifestTweak *tweak)
+{
+  uint64_t pointerSize = (image->is64 ? 8 : 4);
+  uint64_t encoding;
+  if (!_FBTweakImageReadPointer(image, entry + 5 * pointerSize, &encoding)) {
+    return false;
+  }
+
+  tweak->encoding = _FBTweakImageCopyCString(image, encoding);
+  if (tweak->encoding == NULL) {
+    return false;
+  }
+
+  bool isC = (strcmp(tweak->encoding, FBTweakEncodingC) == 0);
+  tweak->category = _FBTweakImageCopyName(image, entry, 0, isC);
+  tweak->collection = _FBTweakImageCopyName(image, entry, 1, isC);
+  tweak->name = _FBTweakImageCopyName(image, entry, 2, isC);
+  if (tweak->category == NULL || tweak->collection == NULL || tweak->name == NULL) {
+    return false;
+  }
+
+  if (isC) {
+    uint64_t handle;
+    if (!_FBTweakImageReadPointer(image, entry + 3 * pointerSize, &handle) || !_FBTweakImageReadCHandle(image, handle, tweak)) {
+      return false;
+    }
+  } else {
+    tweak->type = _FBTweakTypeForEncoding(tweak->encoding);
+    if (!_FBTweakImageReadConstants(image, entry, tweak)) {
+      return false;
+    }
+  }
+
+  // Matches _FBTweakIdentifier().
+  size_t length = strlen("FBTweak:") + strlen(tweak->category) + strlen(tweak->collection) + strlen(tweak->name) + 3;
+  tweak->identifier = malloc(length);
+  snprintf(tweak->identifier, length, "FBTweak:%s-%s-%s", tweak->category, tweak->collection, tweak->name);
+  return true;
+}
+
+static int _FBTweakManifestTweakCompare(const void *a, const void *b)
+{
+  const _FBTweakManifestTweak *left = a;
+  const _FBTweakManifestTweak *right = b;
+  int result = strcmp(left->identifier, right->identifier);
+  return (result != 0 ? result : (left->index > right->index) - (left->index < right->index));
+}
+
+// Output
+
+static void _FBTweakPrintString(FILE *output, const char *string)
+{
+  fputc('"', output);
+  for (const unsigned char *character = (const unsigned char *)string; *character != '\0'; character++) {
+    if (*character == '"' || *character == '\\') {
+      fprintf(output, "\\%c", *character);
+    } else if (*character < 0x20) {
+      fprintf(output, "\\u%04x", *character);
+    } else {
+      fputc(*character, output);
+    }
+  }
+  fputc('"', output);
+}
+
+static void _FBTweakPrintNumber(FILE *output, double number)
+{
+  if (isfinite(number)) {
+    fprintf(output, "%.17g", number);
+  } else {
+    fputs("null", output);
+  }
+}
+
+static void _FBTweakPrintTweak(FILE *output, const _FBTweakManifestTweak *tweak)
+{
+  fputs("{\"identifier\": ", output);
+  _FBTweakPrintString(output, tweak->identifier);
+  fputs(", \"category\": ", output);
+  _FBTweakPrintString(output, tweak->category);
+  fputs(", \"collection\": ", output);
+  _FBTweakPrintString(output, tweak->collection);
+  fputs(", \"name\": ", output);
+  _FBTweakPrintString(output, tweak->name);
+  fputs(", \"type\": ", output);
+  _FBTweakPrintString(output, tweak->type);
+  fputs(", \"encoding\": ", output);
+  _FBTweakPrintString(output, tweak->encoding);
+
+  if (tweak->hasDefault && strcmp(tweak->type, "bool") == 0) {
+    fprintf(output, ", \"default\": %s", tweak->defaultValue != 0 ? "true" : "false");
+  } else if (tweak->hasDefault) {
+    fputs(", \"default\": ", output);
+    _FBTweakPrintNumber(output, tweak->defaultValue);
+  }
+  if (tweak->hasRange) {
+    fputs(", \"minimum\": ", output);
+    _FBTweakPrintNumber(output, tweak->minimumValue);
+    fputs(", \"maximum\": ", output);
+    _FBTweakPrintNumber(output, tweak->maximumValue);
+  }
+
+  fputc('}', output);
+}
+
+// Prints an image's tweaks, sorted by identifier, and any identifiers
+// declared more than once. Returns the number of unreadable entries.
+static size_t _FBTweakPrintImage(FILE *output, const _FBTweakImage *image)
+{
+  uint64_t entrySize = (image->is64 ? 8 : 4) * 6;
+  size_t entryCount = (image->hasSection ? image->sectionSize / entrySize : 0);
+  _FBTweakManifestTweak *tweaks = calloc(entryCount > 0 ? entryCount : 1, sizeof(_FBTweakManifestTweak));
+  size_t tweakCount = 0;
+  size_t failures = 0;
+
+  for (size_t i = 0; i < entryCount; i++) {
+    _FBTweakManifestTweak *tweak = &tweaks[tweakCount];
+    tweak->index = i;
+    if (_FBTweakImageReadEntry(image, image->sectionAddress + i * entrySize, tweak)) {
+      tweakCount++;
+    } else {
+      _FBTweakManifestTweakFree(tweak);
+      memset(tweak, 0, sizeof(*tweak));
+      failures++;
+    }
+  }
+
+  qsort(tweaks, tweakCount, sizeof(_FBTweakManifestTweak), _FBTweakManifestTweakCompare);
+
+  fputs("        {\n          \"architecture\": ", output);
+  _FBTweakPrintString(output, image->architecture);
+  fprintf(output, ",\n          \"format\": \"%s\",\n", image->format == _FBTweakImageFormatMachO ? "mach-o" : "elf");
+  fprintf(output, "          \"unreadable\": %zu,\n", failures);
+  fputs("          \"tweaks\": [", output);
+  for (size_t i = 0; i < tweakCount; i++) {
+    fputs(i == 0 ? "\n            " : ",\n            ", output);
+    _FBTweakPrintTweak(output, &tweaks[i]);
+  }
+  fputs(tweakCount > 0 ? "\n          ],\n" : "],\n", output);
+
+  // Sorted, so entries with the same identifier are next to each other.
+  fputs("          \"duplicates\": [", output);
+  bool first = true;
+  for (size_t i = 0; i < tweakCount; ) {
+    size_t j = i + 1;
+    bool conflicting = false;
+    while (j < tweakCount && strcmp(tweaks[j].identifier, tweaks[i].identifier) == 0) {
+      conflicting = conflicting || strcmp(tweaks[j].type, tweaks[i].type) != 0;
+      j++;
+    }
+
+    if (j - i > 1) {
+      fputs(first ? "\n            {\"identifier\": " : ",\n            {\"identifier\": ", output);
+      _FBTweakPrintString(output, tweaks[i].identifier);
+      fprintf(output, ", \"count\": %zu, \"conflicting\": %s}", j - i, conflicting ? "true" : "false");
+      first = false;
+    }
+    i = j;
+  }
+  fputs(first ? "]\n" : "\n          ]\n", output);
+  fputs("        }", output);
+
+  for (size_t i = 0; i < tweakCount; i++) {
+    _FBTweakManifestTweakFree(&tweaks[i]);
+  }
+  free(tweaks);
+
+  return failures;
+}
+
+static bool _FBTweakImageLoad(_FBTweakImage *image)
+{
+  const uint8_t *magic = _FBTweakImageBytes(image, 0, 4);
+  if (magic == NULL) {
+    return false;
+  }
+
+  uint32_t value = _FBTweakRead32(magic);
+  if (value == _FBTweakMachMagic32 || value == _FBTweakMachMagic64) {
+    return _FBTweakImageLoadMachO(image);
+  } else if (memcmp(magic, "\177ELF", 4) == 0) {
+    return _FBTweakImageLoadELF(image);
+  } else {
+    return false;
+  }
+}
+
+static void _FBTweakImageFree(_FBTweakImage *image)
+{
+  free(image->regions);
+  free(image->relocations);
+}
+
+// Prints one binary. Returns false if it isn't one that can be read.
+static bool _FBTweakPrintBinary(FILE *output, const char *path, bool first, size_t *failures)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "fbtweak-manifest: %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < 4) {
+    fprintf(stderr, "fbtweak-manifest: %s: not a binary\n", path);
+    close(fd);
+    return false;
+  }
+
+  uint64_t size = (uint64_t)info.st_size;
+  const uint8_t *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "fbtweak-manifest: %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  // Universal binaries hold one image per architecture.
+  uint64_t sliceOffsets[64];
+  uint64_t sliceSizes[64];
+  uint32_t sliceCount = 0;
+  uint32_t magic = _FBTweakReadBig32(data);
+
+  if ((magic == _FBTweakFatMagic32 || magic == _FBTweakFatMagic64) && size >= 8) {
+    bool is64 = (magic == _FBTweakFatMagic64);
+    uint64_t archSize = (is64 ? 32 : 20);
+    uint32_t count = _FBTweakReadBig32(data + 4);
+    for (uint32_t i = 0; i < count && i < 64 && 8 + (i + 1) * archSize <= size; i++) {
+      const uint8_t *arch = data + 8 + i * archSize;
+      sliceOffsets[sliceCount] = (is64 ? _FBTweakReadBig64(arch + 8) : _FBTweakReadBig32(arch + 8));
+      sliceSizes[sliceCount] = (is64 ? _FBTweakReadBig64(arch + 16) : _FBTweakReadBig32(arch + 12));
+      if (sliceOffsets[sliceCount] <= size && sliceSizes[sliceCount] <= size - sliceOffsets[sliceCount]) {
+        sliceCount++;
+      }
+    }
+  } else {
+    sliceOffsets[0] = 0;
+    sliceSizes[0] = size;
+    sliceCount = 1;
+  }
+
+  _FBTweakImage images[64];
+  bool success = true;
+  for (uint32_t i = 0; i < sliceCount; i++) {
+    images[i] = (_FBTweakImage){ .data = data + sliceOffsets[i], .size = sliceSizes[i] };
+    success = success && _FBTweakImageLoad(&images[i]);
+  }
+
+  if (success) {
+    fputs(first ? "\n" : ",\n", output);
+    fputs("    {\n      \"path\": ", output);
+    _FBTweakPrintString(output, path);
+    fputs(",\n      \"images\": [\n", output);
+
+    for (uint32_t i = 0; i < sliceCount; i++) {
+      *failures += _FBTweakPrintImage(output, &images[i]);
+      fputs(i + 1 < sliceCount ? ",\n" : "\n", output);
+    }
+
+    fputs("      ]\n    }", output);
+  } else {
+    fprintf(stderr, "fbtweak-manifest: %s: not a linked Mach-O or little endian ELF image\n", path);
+  }
+
+  for (uint32_t i = 0; i < sliceCount; i++) {
+    _FBTweakImageFree(&images[i]);
+  }
+  munmap((void *)data, size);
+  return success;
+}
+
+int main(int argc, const char *argv[])
+{
+  if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+    fprintf(stderr, "usage: fbtweak-manifest BINARY...\n\nPrints the inline tweaks compiled into each binary as JSON.\n");
+    return (argc < 2 ? 64 : 0);
+  }
+
+  int status = 0;
+  size_t failures = 0;
+  bool first = true;
+
+  fputs("{\n  \"binaries\": [", stdout);
+  for (int i = 1; i < argc; i++) {
+    if (_FBTweakPrintBinary(stdout, argv[i], first, &failures)) {
+      first = false;
+    } else {
+      status = 1;
+    }
+  }
+  fputs(first ? "]\n}\n" : "\n  ]\n}\n", stdout);
+
+  if (failures > 0) {
+    fprintf(stderr, "fbtweak-manifest: %zu entries could not be read\n", failures);
+    status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,74 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <stdint.h>
+
+#include "../../../FBTweak/FBTweakC.h"
+
+/*
+  A binary with known tweaks, for FBTweakManifestTests.sh. Objective-C
+  entries are written out by hand, so the fixture builds with any C
+  compiler: their names are laid out like constant NSString literals.
+ */
+
+typedef struct {
+  const void *isa;
+  int32_t flags;
+  const void *bytes;
+  long length;
+} fixture_string;
+
+#define FIXTURE_ASCII 0x7c8
+#define FIXTURE_UTF16 0x7d0
+
+#define FIXTURE_STRING(symbol_, flags_, bytes_, length_) \
+  static fixture_string symbol_ = { 0, flags_, bytes_, length_ };
+
+#define FIXTURE_ENTRY(symbol_, category_, collection_, name_, value_, possible_, encoding_) \
+  _FBTweakEntryAttributes static fb_tweak_c_entry symbol_ = { \
+    (const char *)&category_, \
+    (const char *)&collection_, \
+    (const char *)&name_, \
+    value_, \
+    possible_, \
+    encoding_, \
+  };
+
+#if FB_TWEAK_ENABLED
+
+static const uint16_t cafe[] = { 'C', 'a', 'f', 0xe9 };
+
+FIXTURE_STRING(display, FIXTURE_ASCII, "Display", 7)
+FIXTURE_STRING(text, FIXTURE_ASCII, "Text", 4)
+FIXTURE_STRING(size, FIXTURE_ASCII, "Size", 4)
+FIXTURE_STRING(reset, FIXTURE_ASCII, "Reset \"All\"", 11)
+FIXTURE_STRING(menu, FIXTURE_UTF16, cafe, 4)
+
+FIXTURE_STRING(lines, FIXTURE_ASCII, "Lines", 5)
+
+static const float size_values[] = { 17.5f };
+static const short lines_values[] = { -2, -5, 5 };
+
+FIXTURE_ENTRY(size_entry, display, text, size, size_values, 0, "f")
+FIXTURE_ENTRY(size_again_entry, display, text, size, size_values, 0, "f")
+FIXTURE_ENTRY(lines_entry, display, text, lines, lines_values, lines_values, "s")
+FIXTURE_ENTRY(reset_entry, display, text, reset, 0, 0, "__ACTION__")
+FIXTURE_ENTRY(menu_entry, display, text, menu, 0, 0, "@")
+
+#endif
+
+FBTweakCDoubleRange(kTension, "Physics", "Spring", "Tension", 0.5, 0.0, 1.0);
+FBTweakCIntegerRange(kBounces, "Physics", "Spring", "Bounces", 3, 1, 10);
+FBTweakCBool(kEnabled, "Physics", "Spring", "Enabled", 1);
+FBTweakCInteger(kTensionSteps, "Physics", "Spring", "Tension", 4);
+
+int main(void)
+{
+  return (fb_tweak_get_double(kTension) + fb_tweak_get_integer(kBounces) + fb_tweak_get_bool(kEnabled) + fb_tweak_get_integer(kTensionSteps) > 100);
+}
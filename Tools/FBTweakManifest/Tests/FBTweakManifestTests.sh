@@ -0,0 +1,106 @@
+#!/bin/sh
+#
+# Copyright (c) 2014-present, Facebook, Inc.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree. An additional grant
+# of patent rights can be found in the PATENTS file in the same directory.
+#
+# Builds fbtweak-manifest and fixture binaries with $CC (default cc), then
+# checks the manifests it prints for them.
+
+set -eu
+
+CC=${CC:-cc}
+TESTS=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILURES=0
+
+fail()
+{
+  echo "FAIL: $*" >&2
+  FAILURES=$((FAILURES + 1))
+}
+
+expect()
+{
+  if ! grep -qF -- "$2" "$1"; then
+    fail "$1 is missing: $2"
+  fi
+}
+
+$CC -O2 -Wall -o "$WORK/fbtweak-manifest" "$TESTS/../FBTweakManifest.c"
+
+check_fixture()
+{
+  manifest="$WORK/$1.json"
+  if ! "$WORK/fbtweak-manifest" "$WORK/$1" > "$manifest"; then
+    fail "$1 exited with an error"
+    return
+  fi
+
+  expect "$manifest" '{"identifier": "FBTweak:Physics-Spring-Tension", "category": "Physics", "collection": "Spring", "name": "Tension", "type": "double", "encoding": "__C__", "default": 0.5, "minimum": 0, "maximum": 1}'
+  expect "$manifest" '{"identifier": "FBTweak:Physics-Spring-Bounces", "category": "Physics", "collection": "Spring", "name": "Bounces", "type": "integer", "encoding": "__C__", "default": 3, "minimum": 1, "maximum": 10}'
+  expect "$manifest" '{"identifier": "FBTweak:Physics-Spring-Enabled", "category": "Physics", "collection": "Spring", "name": "Enabled", "type": "bool", "encoding": "__C__", "default": true}'
+  expect "$manifest" '{"identifier": "FBTweak:Display-Text-Size", "category": "Display", "collection": "Text", "name": "Size", "type": "float", "encoding": "f", "default": 17.5}'
+  expect "$manifest" '{"identifier": "FBTweak:Display-Text-Lines", "category": "Display", "collection": "Text", "name": "Lines", "type": "integer", "encoding": "s", "default": -2, "minimum": -5, "maximum": 5}'
+  expect "$manifest" '{"identifier": "FBTweak:Display-Text-Reset \"All\"", "category": "Display", "collection": "Text", "name": "Reset \"All\"", "type": "action", "encoding": "__ACTION__"}'
+  expect "$manifest" '{"identifier": "FBTweak:Display-Text-Café", "category": "Display", "collection": "Text", "name": "Café", "type": "object", "encoding": "@"}'
+  expect "$manifest" '{"identifier": "FBTweak:Display-Text-Size", "count": 2, "conflicting": false}'
+  expect "$manifest" '{"identifier": "FBTweak:Physics-Spring-Tension", "count": 2, "conflicting": true}'
+  expect "$manifest" '"unreadable": 0,'
+}
+
+# Position independent executable, the default on most platforms.
+$CC -DFB_TWEAK_ENABLED=1 -O2 -o "$WORK/executable" "$TESTS/FBTweakManifestFixture.c"
+check_fixture executable
+
+# Executables at a fixed address store plain pointers, where the
+# toolchain can still build them.
+if $CC -DFB_TWEAK_ENABLED=1 -O2 -fno-pie -no-pie -o "$WORK/fixed" "$TESTS/FBTweakManifestFixture.c" 2> /dev/null; then
+  check_fixture fixed
+else
+  echo "SKIP: $CC can't link executables without PIE"
+fi
+
+# Packed relative relocations keep each pointer in place, where the
+# linker supports them.
+if $CC -DFB_TWEAK_ENABLED=1 -O2 -Wl,-z,pack-relative-relocs -o "$WORK/packed" "$TESTS/FBTweakManifestFixture.c" 2> /dev/null; then
+  check_fixture packed
+else
+  echo "SKIP: the linker doesn't support packed relative relocations"
+fi
+
+# Shared libraries are position independent on every platform.
+$CC -DFB_TWEAK_ENABLED=1 -O2 -fPIC -shared -o "$WORK/library" "$TESTS/FBTweakManifestFixture.c"
+check_fixture library
+
+# Universal binaries, where the toolchain can build them.
+if $CC -DFB_TWEAK_ENABLED=1 -O2 -arch arm64 -arch x86_64 -o "$WORK/universal" "$TESTS/FBTweakManifestFixture.c" 2> /dev/null; then
+  check_fixture universal
+  expect "$WORK/universal.json" '"architecture": "arm64"'
+  expect "$WORK/universal.json" '"architecture": "x86_64"'
+fi
+
+# Release builds have no tweaks.
+$CC -DFB_TWEAK_ENABLED=0 -O2 -o "$WORK/release" "$TESTS/FBTweakManifestFixture.c"
+if "$WORK/fbtweak-manifest" "$WORK/release" > "$WORK/release.json"; then
+  expect "$WORK/release.json" '"tweaks": [],'
+else
+  fail "release exited with an error"
+fi
+
+# Anything else is an error.
+if "$WORK/fbtweak-manifest" "$TESTS/FBTweakManifestFixture.c" > /dev/null 2>&1; then
+  fail "source file was read as a binary"
+fi
+
+if [ "$FAILURES" -ne 0 ]; then
+  echo "$FAILURES failures" >&2
+  exit 1
+fi
+
+echo "All tests passed"